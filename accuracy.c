@@ -0,0 +1,484 @@
+#include "accuracy.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <complex.h>
+#include <unistd.h>
+
+#include "recept.h"
+#include "bank.h"
+#include "multirate.h"
+
+static const char *recept_accuracy_field_names[RECEPT_ACCURACY_FIELD_COUNT] = {
+	"cents",
+	"r",
+	"F",
+	"phi",
+	"cycles",
+};
+
+const char *recept_accuracy_field_name(unsigned int field) {
+	return field < RECEPT_ACCURACY_FIELD_COUNT ? recept_accuracy_field_names[field] : NULL;
+}
+
+int recept_accuracy_field_parse(const char *name) {
+	int f;
+
+	for (f = 0; f < RECEPT_ACCURACY_FIELD_COUNT; f++) {
+		if (strcmp(name, recept_accuracy_field_names[f]) == 0) {
+			return f;
+		}
+	}
+
+	return -1;
+}
+
+void recept_accuracy_tolerance_init(struct recept_accuracy_tolerance *tolerance_ptr, int single) {
+	unsigned int f;
+
+	for (f = 0; f < RECEPT_ACCURACY_FIELD_COUNT; f++) {
+		tolerance_ptr->rms[f] = INFINITY;
+	}
+	tolerance_ptr->max[RECEPT_ACCURACY_CENTS]  = 1.0;  /* well under the 5 cents or so that can be heard */
+	tolerance_ptr->max[RECEPT_ACCURACY_R]      = 1e-3; /* under a bar graph's resolution */
+	tolerance_ptr->max[RECEPT_ACCURACY_F]      = 1e-3;
+	tolerance_ptr->max[RECEPT_ACCURACY_PHI]    = 1e-3;
+	tolerance_ptr->max[RECEPT_ACCURACY_CYCLES] = 1e-3;
+	if (single) {
+		tolerance_ptr->max[RECEPT_ACCURACY_CENTS]  = RECEPT_ACCURACY_CENTS_F;
+		tolerance_ptr->rms[RECEPT_ACCURACY_CENTS]  = 1.0;
+		tolerance_ptr->max[RECEPT_ACCURACY_PHI]    = RECEPT_ACCURACY_PHI_F;
+		tolerance_ptr->max[RECEPT_ACCURACY_CYCLES] = RECEPT_ACCURACY_PHI_F;
+	}
+}
+
+int recept_accuracy_path_single(const char *path) {
+	unsigned int p;
+
+	for (p = 0; period_bank_kernel_name(p) != NULL; p++) {
+		if (strcmp(path, period_bank_kernel_name(p)) == 0) {
+			return period_bank_kernel_single(p);
+		}
+	}
+
+	return 0;
+}
+
+double recept_accuracy_stats_rms(const struct recept_accuracy_stats *stats_ptr) {
+	return stats_ptr->count > 0 ? sqrt(stats_ptr->sum_squares / stats_ptr->count) : 0.0;
+}
+
+int recept_accuracy_stats_within(const struct recept_accuracy_stats *stats_ptr, unsigned int field, const struct recept_accuracy_tolerance *tolerance_ptr) {
+	return stats_ptr->max <= tolerance_ptr->max[field] && recept_accuracy_stats_rms(stats_ptr) <= tolerance_ptr->rms[field];
+}
+
+static void recept_accuracy_stats_add(struct recept_accuracy_stats *stats_ptr, double error) {
+	error = fabs(error);
+	if (error > stats_ptr->max || isnan(error)) {
+		stats_ptr->max = error;
+	}
+	stats_ptr->sum_squares += error * error;
+	stats_ptr->count++;
+}
+
+/* the path's sensors, in the reference's order, with the decimation of their octave */
+struct recept_accuracy_path {
+	struct period_array *array_ptr;
+	struct period_bank bank;
+	struct period_octave_array octave_array;
+	int engine;
+	const char *kernel;
+	unsigned int response_stride; /* in input samples */
+	unsigned int sensor_stride;   /* the stride its sensors respond on, 1 with monochords (see `period_array_set_response_stride()`) */
+	unsigned int latency;         /* input samples the path's sensors lag the input by */
+	unsigned int sensor_count;
+	struct period_scale_space_sensor **sensors;
+	double *decimations;
+};
+
+static void recept_accuracy_path_deinit(struct recept_accuracy_path *path_ptr) {
+	free(path_ptr->sensors);
+	free(path_ptr->decimations);
+	if (path_ptr->engine == RECEPT_BENCH_MULTIRATE) {
+		period_octave_array_deinit(&path_ptr->octave_array);
+		return;
+	}
+	period_bank_deinit(&path_ptr->bank);
+	period_array_destroy(path_ptr->array_ptr);
+}
+
+static int recept_accuracy_path_init(struct recept_accuracy_path *path_ptr, const char *path, double sample_rate, const struct recept_bench_config *config_ptr) {
+	struct recept_bench_config config = *config_ptr;
+	struct scale_space_entry *entries;
+	struct period_array *octave_ptr;
+	unsigned int decimation;
+	unsigned int o;
+	unsigned int s;
+	unsigned int i;
+
+	path_ptr->array_ptr = NULL;
+	path_ptr->engine    = strcmp(path, "multirate") == 0 ? RECEPT_BENCH_MULTIRATE : RECEPT_BENCH_BANK;
+	config.bank_kernel  = path_ptr->engine == RECEPT_BENCH_MULTIRATE ? NULL : path;
+
+	if (path_ptr->engine == RECEPT_BENCH_MULTIRATE) {
+		if (config.monochord_count > 0) {
+			/* monochords do not reach across octaves */
+			errno = ENOTSUP;
+			return -1;
+		}
+		if (recept_bench_octave_array_init(&path_ptr->octave_array, sample_rate, &config) == -1) {
+			return -1;
+		}
+		path_ptr->response_stride = period_octave_array_response_stride(&path_ptr->octave_array);
+		path_ptr->sensor_stride   = path_ptr->response_stride;
+		path_ptr->latency         = period_octave_array_latency(&path_ptr->octave_array);
+		path_ptr->sensor_count    = 0;
+		for (o = 0; o < period_octave_array_octave_count(&path_ptr->octave_array); o++) {
+			octave_ptr = period_octave_array_get_octave(&path_ptr->octave_array, o, &decimation);
+			path_ptr->sensor_count += octave_ptr != NULL ? period_array_period_sensor_count(octave_ptr) : 0;
+		}
+	} else {
+		path_ptr->array_ptr = recept_bench_array_create(sample_rate, &config);
+		if (path_ptr->array_ptr == NULL) {
+			return -1;
+		}
+		if (period_bank_init(&path_ptr->bank, path_ptr->array_ptr) == -1) {
+			period_array_destroy(path_ptr->array_ptr);
+			return -1;
+		}
+		if (period_bank_set_kernel(&path_ptr->bank, config.bank_kernel) == -1) {
+			period_bank_deinit(&path_ptr->bank);
+			period_array_destroy(path_ptr->array_ptr);
+			return -1;
+		}
+		path_ptr->response_stride = (unsigned int) (sample_rate / RECEPT_BENCH_RESPONSE_HZ);
+		path_ptr->sensor_stride   = config.monochord_count > 0 ? 1 : path_ptr->response_stride;
+		path_ptr->latency         = 0;
+		path_ptr->sensor_count    = period_array_period_sensor_count(path_ptr->array_ptr);
+	}
+
+	path_ptr->sensors     = calloc(path_ptr->sensor_count, sizeof (*path_ptr->sensors));
+	path_ptr->decimations = calloc(path_ptr->sensor_count, sizeof (*path_ptr->decimations));
+	if (path_ptr->sensors == NULL || path_ptr->decimations == NULL) {
+		recept_accuracy_path_deinit(path_ptr);
+		return -1;
+	}
+	path_ptr->kernel = NULL;
+	if (path_ptr->engine == RECEPT_BENCH_MULTIRATE) {
+		/* the octaves go up in period, as the sensors are populated */
+		s = 0;
+		for (o = 0; o < period_octave_array_octave_count(&path_ptr->octave_array); o++) {
+			octave_ptr = period_octave_array_get_octave(&path_ptr->octave_array, o, &decimation);
+			if (octave_ptr == NULL) {
+				continue;
+			}
+			if (path_ptr->kernel == NULL) {
+				path_ptr->kernel = period_bank_get_kernel(path_ptr->octave_array.octaves[o].bank_ptr);
+			}
+			entries = period_array_get_entries(octave_ptr);
+			for (i = 0; i < period_array_period_sensor_count(octave_ptr); i++, s++) {
+				path_ptr->sensors[s]     = &entries[i].sensor;
+				path_ptr->decimations[s] = decimation;
+			}
+		}
+	} else {
+		path_ptr->kernel = period_bank_get_kernel(&path_ptr->bank);
+		entries = period_array_get_entries(path_ptr->array_ptr);
+		for (s = 0; s < path_ptr->sensor_count; s++) {
+			path_ptr->sensors[s]     = &entries[s].sensor;
+			path_ptr->decimations[s] = 1.0;
+		}
+	}
+
+	return 0;
+}
+
+/* sample a block, and store it back into the path's period arrays */
+static void recept_accuracy_path_sample_block(struct recept_accuracy_path *path_ptr, double time, const double *samples, size_t n) {
+	if (path_ptr->engine == RECEPT_BENCH_MULTIRATE) {
+		period_octave_array_sample_block(&path_ptr->octave_array, time, samples, n);
+		period_octave_array_store(&path_ptr->octave_array);
+	} else {
+		period_bank_sample_block(&path_ptr->bank, time, samples, n);
+		period_bank_store(&path_ptr->bank);
+	}
+}
+
+/*
+ * `cycles_ptr` holds each reference sensor's period lifecycle as counted on the candidate's responses, as the candidate
+ * counts its own, for a lifecycle that turns over half a cycle within a stride is seen to turn back;
+ * or NULL, when the candidate's sensors respond on every one of the reference's samples, whose own count is then taken
+ */
+static void recept_accuracy_compare(struct recept_accuracy_result *result_ptr, struct period_array *reference_ptr, struct lifecycle *cycles_ptr, struct recept_accuracy_path *path_ptr) {
+	struct scale_space_entry *entries = period_array_get_entries(reference_ptr);
+	struct period_scale_space_sensor *ref_ptr;
+	struct period_scale_space_sensor *cand_ptr;
+	double scale_r = 0.0;
+	double scale_F = 0.0;
+	double ref_r;
+	double ref_period;
+	double cand_period;
+	double phi;
+	unsigned int s;
+
+	for (s = 0; s < path_ptr->sensor_count; s++) {
+		ref_ptr = &entries[s].sensor;
+		if (cycles_ptr != NULL) {
+			lifecycle_sample(&cycles_ptr[s], ref_ptr->period_lifecycle.lc.cval);
+		}
+		if (cabs(ref_ptr->period_sensors[0].percept.value.cval) > scale_r) {
+			scale_r = cabs(ref_ptr->period_sensors[0].percept.value.cval);
+		}
+		if (fabs(ref_ptr->period_lifecycle.lc.F) > scale_F) {
+			scale_F = fabs(ref_ptr->period_lifecycle.lc.F);
+		}
+	}
+	if (scale_r == 0.0 || scale_F == 0.0) {
+		/* nothing to measure against yet */
+		return;
+	}
+
+	for (s = 0; s < path_ptr->sensor_count; s++) {
+		ref_ptr  = &entries[s].sensor;
+		cand_ptr = path_ptr->sensors[s];
+		ref_r    = cabs(ref_ptr->period_sensors[0].percept.value.cval);
+
+		recept_accuracy_stats_add(&result_ptr->fields[RECEPT_ACCURACY_R], (cabs(cand_ptr->period_sensors[0].percept.value.cval) - ref_r) / scale_r);
+		recept_accuracy_stats_add(&result_ptr->fields[RECEPT_ACCURACY_F], (cand_ptr->period_lifecycle.lc.F - ref_ptr->period_lifecycle.lc.F) / scale_F);
+		recept_accuracy_stats_add(&result_ptr->fields[RECEPT_ACCURACY_CYCLES], cand_ptr->period_lifecycle.lc.lifecycle - (cycles_ptr != NULL ? cycles_ptr[s] : ref_ptr->period_lifecycle.lc).lifecycle);
+
+		if (ref_r < RECEPT_ACCURACY_FLOOR * scale_r) {
+			continue;
+		}
+		ref_period  = ref_ptr->period_sensors[0].concept.avg_instant_period;
+		cand_period = cand_ptr->period_sensors[0].concept.avg_instant_period * path_ptr->decimations[s];
+		if (ref_period > 0.0 && cand_period > 0.0 && fabs(log2(ref_period / ref_ptr->field.period)) <= RECEPT_ACCURACY_BAND) {
+			recept_accuracy_stats_add(&result_ptr->fields[RECEPT_ACCURACY_CENTS], 1200 * log2(cand_period / ref_period));
+		}
+		phi = cand_ptr->period_lifecycle.lc.phi - ref_ptr->period_lifecycle.lc.phi;
+		recept_accuracy_stats_add(&result_ptr->fields[RECEPT_ACCURACY_PHI], phi - round(phi));
+	}
+	result_ptr->comparisons++;
+}
+
+int recept_accuracy_run(const char *path, double sample_rate, size_t frames, const struct recept_bench_config *config_ptr, unsigned int reference_stride, struct recept_accuracy_result *result_ptr) {
+	struct recept_accuracy_path candidate;
+	struct recept_bench_signal signal;
+	struct period_array *reference_ptr;
+	struct lifecycle *cycles;
+	double *block;
+	double *delayed;
+	size_t block_size;
+	size_t i;
+	size_t m;
+	double time;
+	unsigned int s;
+	unsigned int f;
+
+	reference_ptr = recept_bench_array_create(sample_rate, config_ptr);
+	if (reference_ptr == NULL) {
+		return -1;
+	}
+	if (recept_accuracy_path_init(&candidate, path, sample_rate, config_ptr) == -1) {
+		period_array_destroy(reference_ptr);
+		return -1;
+	}
+	/* either stride has a response on each of the candidate's: 1, or the candidate's own */
+	period_array_set_response_stride(reference_ptr, reference_stride == 1 ? 1 : candidate.response_stride);
+	if (candidate.sensor_count != period_array_period_sensor_count(reference_ptr)) {
+		recept_accuracy_path_deinit(&candidate);
+		period_array_destroy(reference_ptr);
+		errno = EINVAL;
+		return -1;
+	}
+
+	/*
+	 * The candidate responds at the end of every stride, so the blocks end on its responses.
+	 * The reference takes the signal as late as the candidate's sensors do, after its latency of silence.
+	 */
+	block_size = (size_t) candidate.response_stride * RECEPT_ACCURACY_RESPONSES;
+	block   = calloc(block_size, sizeof (*block));
+	delayed = calloc(block_size + candidate.latency, sizeof (*delayed));
+	cycles  = calloc(candidate.sensor_count, sizeof (*cycles));
+	if (block == NULL || delayed == NULL || cycles == NULL) {
+		free(block);
+		free(delayed);
+		free(cycles);
+		recept_accuracy_path_deinit(&candidate);
+		period_array_destroy(reference_ptr);
+		return -1;
+	}
+	for (s = 0; s < candidate.sensor_count; s++) {
+		lifecycle_init(&cycles[s], 0.0);
+	}
+
+	result_ptr->kernel       = candidate.kernel;
+	result_ptr->sensor_count = candidate.sensor_count;
+	result_ptr->comparisons  = 0;
+	for (f = 0; f < RECEPT_ACCURACY_FIELD_COUNT; f++) {
+		result_ptr->fields[f].max         = 0.0;
+		result_ptr->fields[f].sum_squares = 0.0;
+		result_ptr->fields[f].count       = 0;
+	}
+
+	recept_bench_signal_init(&signal, sample_rate, RECEPT_BENCH_AMPLITUDE);
+	time = 1;
+	for (i = 0; i < frames; i += m) {
+		m = frames - i < block_size ? frames - i : block_size;
+		recept_bench_signal_generate(&signal, block, m);
+		memcpy(&delayed[candidate.latency], block, m * sizeof (*block));
+		period_array_sample_block(reference_ptr, time - candidate.latency, delayed, m);
+		memmove(delayed, &delayed[m], candidate.latency * sizeof (*delayed));
+		recept_accuracy_path_sample_block(&candidate, time, block, m);
+		time += m;
+
+		if (m < block_size) {
+			/* the candidate responds only at the end of a whole stride */
+			break;
+		}
+		recept_accuracy_compare(result_ptr, reference_ptr, candidate.sensor_stride == 1 ? NULL : cycles, &candidate);
+	}
+
+	free(block);
+	free(delayed);
+	free(cycles);
+	recept_accuracy_path_deinit(&candidate);
+	period_array_destroy(reference_ptr);
+
+	return 0;
+}
+
+#ifdef RECEPT_ACCURACY
+#define RECEPT_ACCURACY_PATH_MAX 32
+
+int main(int argc, char *argv[]) {
+	struct recept_bench_config config;
+	struct recept_accuracy_tolerance tolerance;
+	struct recept_accuracy_tolerance defaults;
+	struct recept_accuracy_tolerance overrides; /* of `-t`, or negative */
+	struct recept_accuracy_result result;
+	const char *paths[RECEPT_ACCURACY_PATH_MAX];
+	char *path_list = NULL;
+	char *field_name;
+	char *value;
+	double sample_rate = 44100;
+	double seconds = 10.0;
+	double limit;
+	unsigned int reference_stride = 1;
+	unsigned int path_count = 0;
+	unsigned int p;
+	unsigned int f;
+	int failed = 0;
+	int field;
+	int rc;
+	int c;
+
+	for (f = 0; f < RECEPT_ACCURACY_FIELD_COUNT; f++) {
+		overrides.max[f] = -1.0;
+	}
+	config.engine           = RECEPT_BENCH_BANK;
+	config.bank_kernel      = NULL;
+	config.field_count      = 24;
+	config.octave_bandwidth = 12;
+	config.monochord_count  = 0;
+	config.block_size       = 0;
+
+	while ((c = getopt(argc, argv, "r:s:f:o:m:p:t:S")) != -1) {
+		switch (c) {
+			case 'r':
+				rc = sscanf(optarg, "%lf", &sample_rate);
+				break;
+			case 's':
+				rc = sscanf(optarg, "%lf", &seconds);
+				break;
+			case 'f':
+				rc = sscanf(optarg, "%d", &config.field_count);
+				break;
+			case 'o':
+				rc = sscanf(optarg, "%d", &config.octave_bandwidth);
+				break;
+			case 'm':
+				rc = sscanf(optarg, "%u", &config.monochord_count);
+				break;
+			case 'p':
+				path_list = optarg;
+				rc = 1;
+				break;
+			case 'S':
+				reference_stride = 0;
+				rc = 1;
+				break;
+			case 't':
+				/* field=tolerance */
+				field_name = optarg;
+				value = strchr(optarg, '=');
+				rc = 0;
+				if (value != NULL) {
+					*value++ = '\0';
+					field = recept_accuracy_field_parse(field_name);
+					if (field != -1 && sscanf(value, "%lf", &limit) == 1) {
+						overrides.max[field] = limit;
+						rc = 1;
+					}
+				}
+				break;
+			default:
+				rc = 0;
+				break;
+		}
+		if (rc != 1) {
+			optind = argc; /* usage */
+			break;
+		}
+	}
+	if (optind != argc) {
+		fprintf(stderr, "usage: %s [-r rate] [-s seconds] [-f fields] [-o octave bandwidth] [-m monochords] [-p kernel,...|multirate] [-S] [-t cents|r|F|phi|cycles=tolerance]...\n", argv[0]);
+		return -1;
+	}
+
+	if (path_list != NULL) {
+		for (value = strtok(path_list, ","); value != NULL && path_count < RECEPT_ACCURACY_PATH_MAX; value = strtok(NULL, ",")) {
+			paths[path_count++] = value;
+		}
+	} else {
+		/* every kernel, then multirate */
+		for (p = 0; period_bank_kernel_name(p) != NULL && path_count < RECEPT_ACCURACY_PATH_MAX - 1; p++) {
+			paths[path_count++] = period_bank_kernel_name(p);
+		}
+		paths[path_count++] = "multirate";
+	}
+
+	printf("path\tkernel\tsensors\tcomparisons\tfield\tmax\trms\ttolerance\trms_tolerance\tresult\n");
+	for (p = 0; p < path_count; p++) {
+		rc = recept_accuracy_run(paths[p], sample_rate, (size_t) (seconds * sample_rate), &config, reference_stride, &result);
+		if (rc == -1 && errno == ENOTSUP) {
+			fprintf(stderr, "%s: not supported here, skipped\n", paths[p]);
+			continue;
+		} else if (rc == -1) {
+			perror(paths[p]);
+			return -1;
+		}
+		recept_accuracy_tolerance_init(&defaults, 0);
+		recept_accuracy_tolerance_init(&tolerance, recept_accuracy_path_single(paths[p]));
+		for (f = 0; f < RECEPT_ACCURACY_FIELD_COUNT; f++) {
+			if (overrides.max[f] >= 0.0) {
+				defaults.max[f]  = overrides.max[f];
+				tolerance.max[f] = overrides.max[f];
+			}
+		}
+		for (f = 0; f < RECEPT_ACCURACY_FIELD_COUNT; f++) {
+			rc = recept_accuracy_stats_within(&result.fields[f], f, &tolerance);
+			printf("%s\t%s\t%u\t%zu\t%s\t%.3e\t%.3e\t%.3e\t%.3e\t%s\n", paths[p], result.kernel, result.sensor_count, result.comparisons,
+				recept_accuracy_field_name(f), result.fields[f].max, recept_accuracy_stats_rms(&result.fields[f]), tolerance.max[f], tolerance.rms[f],
+				! rc ? "FAIL" : recept_accuracy_stats_within(&result.fields[f], f, &defaults) ? "ok" : "approx");
+			failed |= ! rc;
+		}
+		fflush(stdout);
+	}
+
+	return failed;
+}
+#endif
@@ -0,0 +1,110 @@
+#ifndef ACCURACY_H
+#define ACCURACY_H
+
+#include <stddef.h>
+
+#include "bench.h"
+
+/*
+ * Numerical Accuracy Harness
+ *
+ * Runs the synthetic signal of bench.h through the scalar double-precision `period_array_sample_block()`, the reference,
+ * and through a faster path on sensors of the same configuration, side by side, and measures how far the path's outputs
+ * stray from the reference's on the path's own responses, every RECEPT_ACCURACY_RESPONSES of them:
+ *
+ *   cents:  the sensor's pitch, its first scale's average instant period, in cents
+ *   r:      the first scale's percept magnitude, relative to the strongest sensor's at that time
+ *   F:      the period lifecycle's Free Energy, relative to the largest in magnitude at that time
+ *   phi:    the period lifecycle's phase, in cycles, wrapped
+ *   cycles: the period lifecycle's cycle count and phase, unwrapped, in cycles; the reference's is counted again on
+ *           the path's responses, as the path counts its own
+ *
+ * The reference responds on every sample, at full rate, so that a path is measured for all it changes, its response
+ * stride included: the sensors average every sample of a stride into the concepts and lifecycles
+ * (see `period_array_set_response_stride()`), so the double kernels agree with it to rounding. Or, on request, the reference
+ * responds on the path's own stride, so that the path is measured only for what it changes in the kernels.
+ *
+ * The pitch and phase of a sensor whose percept is under RECEPT_ACCURACY_FLOOR of the strongest are not taken,
+ * as they are only noise, in either path; nor is the pitch of a sensor whose reference pitch is more than
+ * RECEPT_ACCURACY_BAND octaves from its own period, which its resonator hardly passes: the sensor's concept there is
+ * what is left of tones elsewhere as they interfere, and does not stand for a pitch of its own.
+ *
+ * A path is any kernel of `period_bank_set_kernel()`, or "multirate", the octave banks of multirate.h. Each field's
+ * largest and RMS error are held to the tolerances of the path's precision class, set here beforehand, so that a fast path
+ * comes with a measured bound on what it changes:
+ *
+ *   double: differences under what can be heard or seen on the display, a cent of pitch and 1e-3 of the rest
+ *   float:  the resonators hold 24 bits, and where the sweep leaves a sensor's resonator near cancelling, between its old
+ *           and new tone, the instant periods averaged over a stride turn on what little of the resonator is left, so that
+ *           float rounding there is amplified far past the resonator's own error: RECEPT_ACCURACY_CENTS_F of pitch,
+ *           telling notes apart, and a cent RMS, under what can be heard, and RECEPT_ACCURACY_PHI_F of the lifecycle's
+ *           phase, integrated from those periods
+ *
+ * Monochords and longer runs, with more sweeps, stray further in float, and are flagged past the tolerance.
+ *
+ * Multirate is a double path, compared against the reference delayed by its ladder's latency: each sensor's
+ * octave passes its response band in the filters' flat band (see multirate.h), so the octaves differ from the full rate
+ * only by what the filters leave of it, on the order of their flatness, and by the sensors responding on decimated samples.
+ * Sensors an octave's filters reach, the slowest of a wide span, differ in pitch and cycles after tones above them, and
+ * are flagged past the tolerance.
+ *
+ * A float path within its class's tolerances, but past the double's, is reported "approx" rather than "ok".
+ */
+
+#define RECEPT_ACCURACY_RESPONSES 1
+#define RECEPT_ACCURACY_FLOOR 0.1
+#define RECEPT_ACCURACY_BAND 1.0
+/* the float kernels' pitch tolerance, in cents: a quarter tone */
+#define RECEPT_ACCURACY_CENTS_F 50.0
+/* the float kernels' phase tolerance, in cycles */
+#define RECEPT_ACCURACY_PHI_F 1e-2
+
+enum recept_accuracy_field {
+	RECEPT_ACCURACY_CENTS,
+	RECEPT_ACCURACY_R,
+	RECEPT_ACCURACY_F,
+	RECEPT_ACCURACY_PHI,
+	RECEPT_ACCURACY_CYCLES,
+	RECEPT_ACCURACY_FIELD_COUNT
+};
+
+/* the tolerated largest and RMS error of each field */
+struct recept_accuracy_tolerance {
+	double max[RECEPT_ACCURACY_FIELD_COUNT];
+	double rms[RECEPT_ACCURACY_FIELD_COUNT];
+};
+
+struct recept_accuracy_stats {
+	double max;
+	double sum_squares;
+	size_t count;
+};
+
+struct recept_accuracy_result {
+	const char *kernel; /* of the path's bank, or its lowest octave's */
+	unsigned int sensor_count;
+	size_t comparisons;
+	struct recept_accuracy_stats fields[RECEPT_ACCURACY_FIELD_COUNT];
+};
+
+const char *recept_accuracy_field_name(unsigned int field);
+/* the field named `name`, as by `recept_accuracy_field_name()`, or -1 */
+int recept_accuracy_field_parse(const char *name);
+
+/* the tolerances of the double precision class, or of the float one when `single` */
+void   recept_accuracy_tolerance_init(struct recept_accuracy_tolerance *tolerance_ptr, int single);
+/* whether `path` runs in float: a float kernel */
+int    recept_accuracy_path_single(const char *path);
+double recept_accuracy_stats_rms(const struct recept_accuracy_stats *stats_ptr);
+/* whether `stats_ptr` of `field` is within `tolerance_ptr` */
+int    recept_accuracy_stats_within(const struct recept_accuracy_stats *stats_ptr, unsigned int field, const struct recept_accuracy_tolerance *tolerance_ptr);
+
+/*
+ * run `frames` samples of the signal through the reference and through `path` (a kernel name or "multirate"),
+ * on sensors of `config_ptr`, whose `bank_kernel` and `engine` are not used, with the reference responding every
+ * `reference_stride` samples, 1, or 0 for the path's own stride; -1 with ENOTSUP for a kernel the CPU lacks,
+ * or for monochords in multirate
+ */
+int recept_accuracy_run(const char *path, double sample_rate, size_t frames, const struct recept_bench_config *config_ptr, unsigned int reference_stride, struct recept_accuracy_result *result_ptr);
+
+#endif
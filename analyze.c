@@ -0,0 +1,577 @@
+#include "analyze.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "recept.h"
+#include "bank.h"
+#include "sampler.h"
+#include "trace.h"
+
+/* samples are scaled as `recept_test` scales them */
+#define RECEPT_ANALYZE_SAMPLE_SCALE 10000
+
+void recept_analyze_config_init(struct recept_analyze_config *config_ptr) {
+	config_ptr->period_response_Hz = 60.0;
+	config_ptr->field_count        = 24;
+	config_ptr->octave_bandwidth   = 12;
+	config_ptr->starting_note      = -9 -12;
+	config_ptr->bank_kernel        = NULL;
+	config_ptr->warmup_windows     = RECEPT_ANALYZE_WARMUP_WINDOWS;
+}
+
+/* struct recept_analyze_input */
+
+int recept_analyze_input_open(struct recept_analyze_input *input_ptr, const char *path, size_t sample_rate, size_t bit_depth, int encoding, size_t channel_count) {
+	struct filesampler_wav wav;
+	struct stat st;
+	size_t data_size = 0;
+	int fd;
+	int rc;
+
+	input_ptr->path          = path;
+	input_ptr->sample_rate   = sample_rate;
+	input_ptr->bit_depth     = bit_depth;
+	input_ptr->encoding      = encoding;
+	input_ptr->channel_count = channel_count;
+	input_ptr->data_offset   = 0;
+
+	fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		return -1;
+	}
+	rc = fstat(fd, &st);
+	if (rc == 0 && S_ISREG(st.st_mode)) {
+		/* the chunks are read at their offsets, which only a regular file has */
+		data_size = st.st_size;
+		rc = filesampler_read_wav(fd, &wav);
+	}
+	close(fd);
+	if (rc == -1) {
+		return -1;
+	}
+	if (rc == 1) {
+		input_ptr->sample_rate   = wav.sample_rate;
+		input_ptr->bit_depth     = wav.bit_depth;
+		input_ptr->encoding      = wav.encoding;
+		input_ptr->channel_count = wav.channel_count;
+		input_ptr->data_offset   = wav.data_offset;
+		data_size = wav.data_size;
+	}
+
+	if ( ! filesampler_encoding_valid(input_ptr->encoding, input_ptr->bit_depth) || input_ptr->sample_rate == 0 ||
+		input_ptr->channel_count == 0 || input_ptr->channel_count > PERIOD_BANK_CHANNEL_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+	input_ptr->frame_count = data_size / (input_ptr->bit_depth / 8 * input_ptr->channel_count);
+
+	return 0;
+}
+
+/* struct recept_analyze */
+
+/* the period array of `recept_test`, at the input's rate, responding once per response period */
+static struct period_array *recept_analyze_array_create(struct recept_analyze *analyze_ptr) {
+	struct recept_analyze_config *config_ptr = &analyze_ptr->config;
+	struct period_array *array_ptr;
+	struct receptive_field *field_ptr;
+	double cycle_area;
+	double sample_rate;
+
+	cycle_area  = 1.0 / (1.0 - exp(-1.0));
+	sample_rate = analyze_ptr->input.sample_rate;
+
+	array_ptr = period_array_create(config_ptr->field_count + 1, 0, 0);
+	if (array_ptr == NULL) {
+		return NULL;
+	}
+	field_ptr = period_array_get_receptive_field(array_ptr);
+	field_ptr->period = sample_rate / (440 * pow(2, ((double) config_ptr->starting_note) / 12));
+	field_ptr->phase = 0.0;
+	field_ptr->phase_factor = cycle_area;
+	period_array_init(array_ptr, sample_rate / config_ptr->period_response_Hz, config_ptr->octave_bandwidth, cycle_area);
+	if (period_array_populate(array_ptr, ((double) config_ptr->field_count) / config_ptr->octave_bandwidth, 1.0) == -1) {
+		period_array_destroy(array_ptr);
+		errno = ENOSPC;
+		return NULL;
+	}
+	period_array_set_response_stride(array_ptr, (unsigned int) array_ptr->response_period);
+
+	return array_ptr;
+}
+
+int recept_analyze_init(struct recept_analyze *analyze_ptr, const struct recept_analyze_input *input_ptr, const struct recept_analyze_config *config_ptr, unsigned int thread_count, size_t chunk_frames) {
+	struct period_array *array_ptr;
+	struct scale_space_entry *entries;
+	struct receptive_field *field_ptr;
+	double window;
+	long cpus;
+	unsigned int s;
+	unsigned int i;
+	size_t k;
+
+	analyze_ptr->input  = *input_ptr;
+	analyze_ptr->config = *config_ptr;
+	analyze_ptr->chunks = NULL;
+
+	/* the slowest smoother: a resonator's window, or the response period of the lifecycles */
+	array_ptr = recept_analyze_array_create(analyze_ptr);
+	if (array_ptr == NULL) {
+		return -1;
+	}
+	analyze_ptr->response_stride = (size_t) array_ptr->response_period;
+	if (analyze_ptr->response_stride < 1) {
+		analyze_ptr->response_stride = 1;
+	}
+	window = array_ptr->response_period;
+	entries = period_array_get_entries(array_ptr);
+	for (s = 0; s < period_array_period_sensor_count(array_ptr); s++) {
+		for (i = 0; i < PERIOD_BANK_SCALES; i++) {
+			field_ptr = &entries[s].sensor.period_sensors[i].field;
+			if (field_ptr->period * field_ptr->period_factor > window) {
+				window = field_ptr->period * field_ptr->period_factor;
+			}
+		}
+	}
+
+	/* the bank's sensors, channel-minor */
+	analyze_ptr->sensor_count = period_array_period_sensor_count(array_ptr) * input_ptr->channel_count;
+	analyze_ptr->value_count  = RECEPT_TRACE_COLUMN_COUNT * analyze_ptr->sensor_count;
+	analyze_ptr->periods = calloc(analyze_ptr->sensor_count, sizeof (*analyze_ptr->periods));
+	if (analyze_ptr->periods == NULL) {
+		period_array_destroy(array_ptr);
+		return -1;
+	}
+	for (s = 0; s < analyze_ptr->sensor_count; s++) {
+		analyze_ptr->periods[s] = entries[s / input_ptr->channel_count].sensor.period_sensors[0].field.period;
+	}
+	period_array_destroy(array_ptr);
+	analyze_ptr->warmup = ceil(config_ptr->warmup_windows * window / analyze_ptr->response_stride) * analyze_ptr->response_stride;
+
+	if (thread_count == 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		thread_count = cpus > 0 ? cpus : 1;
+	}
+	if (thread_count > RECEPT_ANALYZE_THREAD_MAX) {
+		thread_count = RECEPT_ANALYZE_THREAD_MAX;
+	}
+	analyze_ptr->thread_count = thread_count;
+
+	/* chunks of whole responses, long enough for the warm-up not to dominate */
+	if (chunk_frames == 0) {
+		chunk_frames = (input_ptr->frame_count + thread_count * RECEPT_ANALYZE_CHUNKS_PER_THREAD - 1) / (thread_count * RECEPT_ANALYZE_CHUNKS_PER_THREAD);
+		if (chunk_frames < RECEPT_ANALYZE_CHUNK_WARMUPS * analyze_ptr->warmup) {
+			chunk_frames = RECEPT_ANALYZE_CHUNK_WARMUPS * analyze_ptr->warmup;
+		}
+	}
+	chunk_frames = (chunk_frames + analyze_ptr->response_stride - 1) / analyze_ptr->response_stride * analyze_ptr->response_stride;
+
+	analyze_ptr->chunk_next  = 0;
+	analyze_ptr->stopping    = 0;
+	analyze_ptr->chunk_count = (input_ptr->frame_count + chunk_frames - 1) / chunk_frames;
+	analyze_ptr->chunks = calloc(analyze_ptr->chunk_count > 0 ? analyze_ptr->chunk_count : 1, sizeof (*analyze_ptr->chunks));
+	if (analyze_ptr->chunks == NULL) {
+		free(analyze_ptr->periods);
+		return -1;
+	}
+	for (k = 0; k < analyze_ptr->chunk_count; k++) {
+		analyze_ptr->chunks[k].begin = k * chunk_frames;
+		analyze_ptr->chunks[k].end   = k + 1 < analyze_ptr->chunk_count ? (k + 1) * chunk_frames : input_ptr->frame_count;
+		analyze_ptr->chunks[k].warmup_begin = analyze_ptr->chunks[k].begin > analyze_ptr->warmup ? analyze_ptr->chunks[k].begin - analyze_ptr->warmup : 0;
+	}
+
+	pthread_mutex_init(&analyze_ptr->mutex, NULL);
+	pthread_cond_init(&analyze_ptr->done_cond, NULL);
+
+	return 0;
+}
+
+void recept_analyze_deinit(struct recept_analyze *analyze_ptr) {
+	size_t k;
+
+	if (analyze_ptr->chunks == NULL) {
+		return;
+	}
+	for (k = 0; k < analyze_ptr->chunk_count; k++) {
+		if (analyze_ptr->chunks[k].rows != NULL) {
+			fclose(analyze_ptr->chunks[k].rows);
+		}
+	}
+	free(analyze_ptr->chunks);
+	free(analyze_ptr->periods);
+	analyze_ptr->chunks = NULL;
+	pthread_cond_destroy(&analyze_ptr->done_cond);
+	pthread_mutex_destroy(&analyze_ptr->mutex);
+}
+
+/* the bank's latest response, as its time and a `struct recept_trace` frame */
+static void recept_analyze_write_frame(struct recept_analyze *analyze_ptr, struct period_bank *bank_ptr, double *frame, FILE *rows) {
+	frame[0] = bank_ptr->percept_time;
+	recept_trace_bank_frame(bank_ptr, frame + 1);
+	fwrite(frame, sizeof (*frame), 1 + analyze_ptr->value_count, rows);
+}
+
+/* a row per sensor of a frame */
+static int recept_analyze_print_frame(struct recept_analyze *analyze_ptr, const double *frame, FILE *out) {
+	unsigned int sensor_count = analyze_ptr->sensor_count;
+	unsigned int channel_count = analyze_ptr->input.channel_count;
+	unsigned int s;
+	unsigned int c;
+
+	for (s = 0; s < sensor_count; s++) {
+		fprintf(out, "%.6f\t%u\t%u\t%.9g", frame[0] / analyze_ptr->input.sample_rate, s % channel_count, s / channel_count, analyze_ptr->periods[s]);
+		for (c = 0; c < RECEPT_TRACE_COLUMN_COUNT; c++) {
+			fprintf(out, "\t%.9g", frame[1 + c * sensor_count + s]);
+		}
+		if (fputc('\n', out) == EOF) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* sample the chunk's warm-up and frames on a bank of its own, into a temporary file of its response frames */
+static int recept_analyze_chunk_sample(struct recept_analyze *analyze_ptr, struct recept_analyze_chunk *chunk_ptr) {
+	struct recept_analyze_input *input_ptr = &analyze_ptr->input;
+	struct period_array *array_ptr;
+	struct period_bank bank;
+	struct filesampler sampler;
+	size_t channel_count = input_ptr->channel_count;
+	size_t stride = analyze_ptr->response_stride;
+	double *block = NULL;
+	double *response = NULL;
+	double last_time = -1.0;
+	FILE *rows = NULL;
+	size_t frame_size;
+	size_t t;
+	size_t j;
+	size_t m;
+	size_t c;
+	ssize_t got;
+	int fd = -1;
+	int rc = -1;
+
+	array_ptr = recept_analyze_array_create(analyze_ptr);
+	if (array_ptr == NULL) {
+		return -1;
+	}
+	if (period_bank_init_channels(&bank, array_ptr, channel_count) == -1) {
+		period_array_destroy(array_ptr);
+		return -1;
+	}
+	if (period_bank_set_kernel(&bank, analyze_ptr->config.bank_kernel) == -1) {
+		period_bank_deinit(&bank);
+		period_array_destroy(array_ptr);
+		return -1;
+	}
+
+	frame_size = input_ptr->bit_depth / 8 * channel_count;
+	block = calloc(stride * channel_count, sizeof (*block));
+	response = calloc(1 + analyze_ptr->value_count, sizeof (*response));
+	rows = tmpfile();
+	fd = open(input_ptr->path, O_RDONLY);
+	if (block == NULL || response == NULL || rows == NULL || fd == -1) {
+		goto done;
+	}
+	if (lseek(fd, input_ptr->data_offset + (off_t) (chunk_ptr->warmup_begin * frame_size), SEEK_SET) == -1) {
+		goto done;
+	}
+	if (filesampler_init_encoding(&sampler, fd, input_ptr->sample_rate, input_ptr->bit_depth, input_ptr->encoding, channel_count, stride) == -1) {
+		goto done;
+	}
+
+	/* whole responses, with times counted from 1 at the first frame, as in `recept_test` */
+	for (t = chunk_ptr->warmup_begin; t < chunk_ptr->end; t += m) {
+		m = chunk_ptr->end - t < stride ? chunk_ptr->end - t : stride;
+		for (j = 0; j < m; j += got) {
+			do {
+				got = filesampler_demand_block(&sampler, &block[j * channel_count], m - j);
+			} while (got == 0 && ! sampler.hit_eof);
+			if (got <= 0) {
+				if (got == 0) {
+					errno = EIO; /* the file shrank */
+				}
+				rc = -1;
+				filesampler_deinit(&sampler);
+				goto done;
+			}
+		}
+		for (c = 0; c < m * channel_count; c++) {
+			block[c] *= RECEPT_ANALYZE_SAMPLE_SCALE;
+		}
+		period_bank_sample_block(&bank, t + 1, block, m);
+
+		if (bank.has_prior_percept && bank.percept_time != last_time && bank.percept_time > chunk_ptr->begin) {
+			recept_analyze_write_frame(analyze_ptr, &bank, response, rows);
+			last_time = bank.percept_time;
+		}
+	}
+	filesampler_deinit(&sampler);
+
+	if (fflush(rows) == EOF || ferror(rows)) {
+		rc = -1;
+		goto done;
+	}
+	rewind(rows);
+	chunk_ptr->rows = rows;
+	rows = NULL;
+	rc = 0;
+
+done:
+	if (rc == -1) {
+		chunk_ptr->error = errno;
+	}
+	if (fd != -1) {
+		close(fd);
+	}
+	if (rows != NULL) {
+		fclose(rows);
+	}
+	free(response);
+	free(block);
+	period_bank_deinit(&bank);
+	period_array_destroy(array_ptr);
+
+	return rc;
+}
+
+static void *recept_analyze_thread(void *arg) {
+	struct recept_analyze *analyze_ptr = arg;
+	struct recept_analyze_chunk *chunk_ptr;
+	int rc;
+
+	pthread_mutex_lock(&analyze_ptr->mutex);
+	while ( ! analyze_ptr->stopping && analyze_ptr->chunk_next < analyze_ptr->chunk_count) {
+		chunk_ptr = &analyze_ptr->chunks[analyze_ptr->chunk_next++];
+		pthread_mutex_unlock(&analyze_ptr->mutex);
+
+		rc = recept_analyze_chunk_sample(analyze_ptr, chunk_ptr);
+
+		pthread_mutex_lock(&analyze_ptr->mutex);
+		if (rc == -1) {
+			if (chunk_ptr->error == 0) {
+				chunk_ptr->error = EIO;
+			}
+			analyze_ptr->stopping = 1; /* no use going on */
+		}
+		chunk_ptr->done = 1;
+		pthread_cond_broadcast(&analyze_ptr->done_cond);
+	}
+	pthread_mutex_unlock(&analyze_ptr->mutex);
+
+	return NULL;
+}
+
+int recept_analyze_run(struct recept_analyze *analyze_ptr, FILE *out, struct recept_trace *trace_ptr) {
+	struct recept_analyze_chunk *chunk_ptr;
+	double *frame;
+	unsigned int started;
+	unsigned int w;
+	unsigned int c;
+	size_t k;
+	int error = 0;
+
+	frame = calloc(1 + analyze_ptr->value_count, sizeof (*frame));
+	if (frame == NULL) {
+		return -1;
+	}
+	for (started = 0; started < analyze_ptr->thread_count; started++) {
+		if (pthread_create(&analyze_ptr->threads[started], NULL, recept_analyze_thread, analyze_ptr) != 0) {
+			break;
+		}
+	}
+	if (started == 0) {
+		free(frame);
+		errno = EAGAIN;
+		return -1;
+	}
+
+	/* stitch the chunks in order, each once it is done */
+	if (out != NULL) {
+		fprintf(out, "time\tchannel\tsensor\tperiod");
+		for (c = 0; c < RECEPT_TRACE_COLUMN_COUNT; c++) {
+			fprintf(out, "\t%s", recept_trace_column_name(c));
+		}
+		fputc('\n', out);
+	}
+	for (k = 0; k < analyze_ptr->chunk_count && error == 0; k++) {
+		chunk_ptr = &analyze_ptr->chunks[k];
+
+		pthread_mutex_lock(&analyze_ptr->mutex);
+		while ( ! chunk_ptr->done && (k < analyze_ptr->chunk_next || ! analyze_ptr->stopping)) {
+			pthread_cond_wait(&analyze_ptr->done_cond, &analyze_ptr->mutex);
+		}
+		if ( ! chunk_ptr->done) {
+			/* given up on after an earlier failure */
+			error = ECANCELED;
+		} else {
+			error = chunk_ptr->error;
+		}
+		pthread_mutex_unlock(&analyze_ptr->mutex);
+		if (error != 0) {
+			break;
+		}
+
+		while (fread(frame, sizeof (*frame), 1 + analyze_ptr->value_count, chunk_ptr->rows) == 1 + analyze_ptr->value_count) {
+			if (out != NULL && recept_analyze_print_frame(analyze_ptr, frame, out) == -1) {
+				error = errno;
+				break;
+			}
+			if (trace_ptr != NULL && recept_trace_append(trace_ptr, frame[0], frame + 1) == -1) {
+				error = errno;
+				break;
+			}
+		}
+		if (error == 0 && ferror(chunk_ptr->rows)) {
+			error = EIO;
+		}
+		fclose(chunk_ptr->rows);
+		chunk_ptr->rows = NULL;
+	}
+
+	if (error != 0) {
+		pthread_mutex_lock(&analyze_ptr->mutex);
+		analyze_ptr->stopping = 1;
+		pthread_mutex_unlock(&analyze_ptr->mutex);
+	}
+	for (w = 0; w < started; w++) {
+		pthread_join(analyze_ptr->threads[w], NULL);
+	}
+	free(frame);
+	if (error == 0 && out != NULL && fflush(out) == EOF) {
+		error = errno;
+	}
+	if (error != 0) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+#ifdef RECEPT_ANALYZE
+int main(int argc, char *argv[]) {
+	struct recept_analyze_input input;
+	struct recept_analyze_config config;
+	struct recept_analyze analyze;
+	unsigned int thread_count = 0;
+	double chunk_seconds = 0.0;
+	size_t sample_rate = 44100;
+	size_t bit_depth = 16;
+	int encoding = FILESAMPLER_PCM;
+	size_t channel_count = 1;
+	const char *out_path = NULL;
+	const char *trace_path = NULL;
+	int trace_encoding = RECEPT_TRACE_F32;
+	struct recept_trace trace;
+	FILE *out = stdout;
+	int rc;
+	int c;
+
+	recept_analyze_config_init(&config);
+
+	while ((c = getopt(argc, argv, "r:b:n:j:s:w:k:o:t:e:")) != -1) {
+		switch (c) {
+			case 'r':
+				rc = sscanf(optarg, "%zu", &sample_rate);
+				break;
+			case 'b':
+				rc = filesampler_parse_format(optarg, &bit_depth, &encoding) == 0;
+				break;
+			case 'n':
+				rc = sscanf(optarg, "%zu", &channel_count);
+				break;
+			case 'j':
+				rc = sscanf(optarg, "%u", &thread_count);
+				break;
+			case 's':
+				rc = sscanf(optarg, "%lf", &chunk_seconds);
+				break;
+			case 'w':
+				rc = sscanf(optarg, "%lf", &config.warmup_windows);
+				break;
+			case 'k':
+				config.bank_kernel = optarg;
+				rc = 1;
+				break;
+			case 'o':
+				out_path = optarg;
+				rc = 1;
+				break;
+			case 't':
+				trace_path = optarg;
+				rc = 1;
+				break;
+			case 'e':
+				trace_encoding = recept_trace_encoding_parse(optarg);
+				rc = trace_encoding != -1;
+				break;
+			default:
+				rc = 0;
+				break;
+		}
+		if (rc != 1) {
+			optind = argc; /* usage */
+			break;
+		}
+	}
+	if (optind + 1 != argc) {
+		fprintf(stderr, "usage: %s [-r rate] [-b 8|16|24|32|u8|f32|f64|mulaw|alaw] [-n channels] [-j threads] [-s chunk seconds] [-w warm-up windows] [-k kernel] [-o out.tsv] [-t trace.bin [-e f64|f32|f16|delta16]] input.{raw,wav}\n", argv[0]);
+		return -1;
+	}
+
+	rc = recept_analyze_input_open(&input, argv[optind], sample_rate, bit_depth, encoding, channel_count);
+	if (rc == -1) {
+		perror("recept_analyze_input_open");
+		return -1;
+	}
+	rc = recept_analyze_init(&analyze, &input, &config, thread_count, (size_t) (chunk_seconds * input.sample_rate));
+	if (rc == -1) {
+		perror("recept_analyze_init");
+		return -1;
+	}
+	if (out_path != NULL) {
+		out = fopen(out_path, "w");
+		if (out == NULL) {
+			perror("fopen");
+			return -1;
+		}
+	} else if (trace_path != NULL) {
+		out = NULL; /* the trace only */
+	}
+	if (trace_path != NULL) {
+		rc = recept_trace_open(&trace, trace_path, input.sample_rate, analyze.response_stride, input.channel_count, analyze.sensor_count, analyze.periods, trace_encoding);
+		if (rc == -1) {
+			perror("recept_trace_open");
+			return -1;
+		}
+	}
+
+	rc = recept_analyze_run(&analyze, out, trace_path != NULL ? &trace : NULL);
+	if (rc == -1) {
+		perror("recept_analyze_run");
+		return -1;
+	}
+	if (trace_path != NULL && recept_trace_close(&trace) == -1) {
+		perror("recept_trace_close");
+		return -1;
+	}
+	fprintf(stderr, "%zu frames, %zu chunks on %u threads, warm-up %zu frames\n", input.frame_count, analyze.chunk_count, analyze.thread_count, analyze.warmup);
+
+	if (out != stdout && out != NULL && fclose(out) == EOF) {
+		perror("fclose");
+		return -1;
+	}
+	recept_analyze_deinit(&analyze);
+
+	return 0;
+}
+#endif
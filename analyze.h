@@ -0,0 +1,94 @@
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+/*
+ * Offline File Analyzer
+ *
+ * Runs a recorded file through the sensors of `recept_test`, headless and faster than realtime:
+ * the file is split into time chunks, each sampled by its own bank on its own thread, and the chunks' rows are
+ * written out in order, as if the file had been sampled in one pass.
+ *
+ * A chunk starts cold, so its bank first samples a warm-up from before the chunk, long enough for its slowest
+ * smoother (the longest period * period_factor window, or the response period) to forget its start:
+ * RECEPT_ANALYZE_WARMUP_WINDOWS of them. Chunks and warm-ups start on response boundaries, and samples keep their
+ * times in the file, so that the oscillators and responses line up with a single pass.
+ * Past the warm-up, rows differ from a single pass by about exp(-RECEPT_ANALYZE_WARMUP_WINDOWS) of the signal;
+ * the first chunk, with no warm-up, is identical.
+ *
+ * Each row is one sensor at one response, tab-separated: its time, channel, sensor and period, then the columns of
+ * `enum recept_trace_column`, see trace.h; or each response is a frame of a `struct recept_trace`.
+ */
+
+#define RECEPT_ANALYZE_WARMUP_WINDOWS 8.0
+/* chunks per thread, for balance, and the least chunk length in warm-ups, for efficiency */
+#define RECEPT_ANALYZE_CHUNKS_PER_THREAD 4
+#define RECEPT_ANALYZE_CHUNK_WARMUPS 8
+#define RECEPT_ANALYZE_THREAD_MAX 256
+
+/* the sample data of a raw file, or of a WAV file, whose header takes precedence */
+struct recept_analyze_input {
+	const char *path;
+	size_t sample_rate;
+	size_t bit_depth;
+	int    encoding; /* enum filesampler_encoding */
+	size_t channel_count;
+	off_t  data_offset; /* bytes */
+	size_t frame_count;
+};
+
+/* the sensors, as in `recept_test`'s config */
+struct recept_analyze_config {
+	double period_response_Hz;
+	int    field_count;
+	int    octave_bandwidth;
+	int    starting_note;
+	const char *bank_kernel;
+	double warmup_windows;
+};
+
+struct recept_analyze_chunk {
+	size_t warmup_begin; /* frames */
+	size_t begin;
+	size_t end;
+	FILE  *rows;         /* response frames, written by the chunk's thread, NULL until done */
+	int    done;
+	int    error;        /* errno, or 0 */
+};
+
+struct recept_analyze {
+	struct recept_analyze_input  input;
+	struct recept_analyze_config config;
+	size_t response_stride; /* frames */
+	size_t warmup;          /* frames */
+	unsigned int sensor_count; /* of a chunk's bank */
+	unsigned int value_count;  /* of a frame, see `recept_trace_append()` */
+	double *periods;           /* of each sensor */
+
+	unsigned int thread_count;
+	pthread_t threads[RECEPT_ANALYZE_THREAD_MAX];
+	pthread_mutex_t mutex;
+	pthread_cond_t  done_cond;
+	size_t chunk_next;      /* the next chunk to claim */
+	int    stopping;        /* after a failure, no more chunks are claimed */
+	size_t chunk_count;
+	struct recept_analyze_chunk *chunks;
+};
+
+struct recept_trace;
+
+void recept_analyze_config_init(struct recept_analyze_config *config_ptr);
+/* open `path`, reading its format from a WAV header, or else taking it as raw samples of the given format */
+int  recept_analyze_input_open(struct recept_analyze_input *input_ptr, const char *path, size_t sample_rate, size_t bit_depth, int encoding, size_t channel_count);
+
+/* split the input into chunks for `thread_count` threads, 0 for one per online CPU, of at least `chunk_frames` frames each when nonzero */
+int  recept_analyze_init(struct recept_analyze *analyze_ptr, const struct recept_analyze_input *input_ptr, const struct recept_analyze_config *config_ptr, unsigned int thread_count, size_t chunk_frames);
+void recept_analyze_deinit(struct recept_analyze *analyze_ptr);
+/* analyze every chunk, writing their rows to `out` and their frames to `trace_ptr`, either NULL, in order as they complete */
+int  recept_analyze_run(struct recept_analyze *analyze_ptr, FILE *out, struct recept_trace *trace_ptr);
+
+#endif
@@ -0,0 +1,1176 @@
+#include "bank.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "recept.h"
+#include "tau.h"
+#include "profile.h"
+
+/* Arena layout: every array starts on a PERIOD_BANK_ALIGN boundary. */
+
+static void *period_bank_carve(struct period_bank *bank_ptr, size_t *offset_ptr, size_t count, size_t size) {
+	void *ptr;
+	size_t bytes;
+
+	bytes = (count * size + PERIOD_BANK_ALIGN - 1) / PERIOD_BANK_ALIGN * PERIOD_BANK_ALIGN;
+	ptr = bank_ptr->arena == NULL ? NULL : (char *) bank_ptr->arena + *offset_ptr;
+	*offset_ptr += bytes;
+
+	return ptr;
+}
+
+static void period_bank_layout_lifecycle(struct period_bank *bank_ptr, size_t *offset_ptr, struct period_bank_lifecycle *lc_ptr) {
+	size_t n = bank_ptr->sensor_stride;
+
+	lc_ptr->max_r     = period_bank_carve(bank_ptr, offset_ptr, n, sizeof (double));
+	lc_ptr->F         = period_bank_carve(bank_ptr, offset_ptr, n, sizeof (double));
+	lc_ptr->r         = period_bank_carve(bank_ptr, offset_ptr, n, sizeof (double));
+	lc_ptr->phi       = period_bank_carve(bank_ptr, offset_ptr, n, sizeof (double));
+	lc_ptr->cycle     = period_bank_carve(bank_ptr, offset_ptr, n, sizeof (int));
+	lc_ptr->lifecycle = period_bank_carve(bank_ptr, offset_ptr, n, sizeof (double));
+	lc_ptr->cval_re   = period_bank_carve(bank_ptr, offset_ptr, n, sizeof (double));
+	lc_ptr->cval_im   = period_bank_carve(bank_ptr, offset_ptr, n, sizeof (double));
+}
+
+static size_t period_bank_layout(struct period_bank *bank_ptr) {
+	size_t offset = 0;
+	size_t lanes = bank_ptr->lane_stride;
+	size_t sensors = bank_ptr->sensor_stride;
+
+	/* hot lanes first, so that they share as few pages as possible with the cold state */
+	bank_ptr->cval_re                        = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->cval_im                        = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->period                         = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->phase                          = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->window                         = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->alpha                          = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->osc_re                         = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->osc_im                         = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->step_re                        = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->step_im                        = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->cval_re_f                      = period_bank_carve(bank_ptr, &offset, lanes, sizeof (float));
+	bank_ptr->cval_im_f                      = period_bank_carve(bank_ptr, &offset, lanes, sizeof (float));
+	bank_ptr->alpha_f                        = period_bank_carve(bank_ptr, &offset, lanes, sizeof (float));
+	bank_ptr->osc_re_f                       = period_bank_carve(bank_ptr, &offset, lanes, sizeof (float));
+	bank_ptr->osc_im_f                       = period_bank_carve(bank_ptr, &offset, lanes, sizeof (float));
+	bank_ptr->step_re_f                      = period_bank_carve(bank_ptr, &offset, lanes, sizeof (float));
+	bank_ptr->step_im_f                      = period_bank_carve(bank_ptr, &offset, lanes, sizeof (float));
+	bank_ptr->stride_period                  = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->stride_r                       = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->stride_r_factor                = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+
+	bank_ptr->percept_re                     = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->percept_im                     = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->percept_r                      = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->prior_percept_re               = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->prior_percept_im               = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->capture_percept_re             = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->capture_percept_im             = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->phase_factor                   = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->instant_period                 = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->avg_instant_period             = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->instant_period_delta_has_prior = period_bank_carve(bank_ptr, &offset, lanes, sizeof (int));
+	bank_ptr->instant_period_delta_prior     = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->instant_period_delta           = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+	bank_ptr->instant_period_stddev          = period_bank_carve(bank_ptr, &offset, lanes, sizeof (double));
+
+	bank_ptr->monochord_row_begin            = period_bank_carve(bank_ptr, &offset, sensors + 1, sizeof (unsigned int));
+	bank_ptr->monochord_source               = period_bank_carve(bank_ptr, &offset, bank_ptr->monochord_count, sizeof (unsigned int));
+	bank_ptr->monochord_re                   = period_bank_carve(bank_ptr, &offset, bank_ptr->monochord_count, sizeof (double));
+	bank_ptr->monochord_im                   = period_bank_carve(bank_ptr, &offset, bank_ptr->monochord_count, sizeof (double));
+	bank_ptr->monochord_sources              = period_bank_carve(bank_ptr, &offset, bank_ptr->monochord_count > 0 ? 2 * sensors * PERIOD_BANK_MONOCHORD_STRIDE : 0, sizeof (double));
+	bank_ptr->superposition_re               = period_bank_carve(bank_ptr, &offset, bank_ptr->monochord_count > 0 ? lanes : 0, sizeof (double));
+	bank_ptr->superposition_im               = period_bank_carve(bank_ptr, &offset, bank_ptr->monochord_count > 0 ? lanes : 0, sizeof (double));
+
+	bank_ptr->response_factor                = period_bank_carve(bank_ptr, &offset, sensors, sizeof (double));
+	bank_ptr->d_avg                          = period_bank_carve(bank_ptr, &offset, sensors, sizeof (double));
+	bank_ptr->dd_avg                         = period_bank_carve(bank_ptr, &offset, sensors, sizeof (double));
+	bank_ptr->d                              = period_bank_carve(bank_ptr, &offset, sensors, sizeof (double));
+	bank_ptr->dd                             = period_bank_carve(bank_ptr, &offset, sensors, sizeof (double));
+	period_bank_layout_lifecycle(bank_ptr, &offset, &bank_ptr->period_lifecycle);
+	bank_ptr->beat_d_has_prior               = period_bank_carve(bank_ptr, &offset, sensors, sizeof (int));
+	bank_ptr->beat_d_prior                   = period_bank_carve(bank_ptr, &offset, sensors, sizeof (double));
+	bank_ptr->beat_d                         = period_bank_carve(bank_ptr, &offset, sensors, sizeof (double));
+	bank_ptr->beat_dd_has_prior              = period_bank_carve(bank_ptr, &offset, sensors, sizeof (int));
+	bank_ptr->beat_dd_prior                  = period_bank_carve(bank_ptr, &offset, sensors, sizeof (double));
+	bank_ptr->beat_dd                        = period_bank_carve(bank_ptr, &offset, sensors, sizeof (double));
+	period_bank_layout_lifecycle(bank_ptr, &offset, &bank_ptr->beat_lifecycle);
+
+	return offset;
+}
+
+int period_bank_init(struct period_bank *bank_ptr, struct period_array *pa_ptr) {
+	return period_bank_init_channels(bank_ptr, pa_ptr, 1);
+}
+
+int period_bank_init_channels(struct period_bank *bank_ptr, struct period_array *pa_ptr, unsigned int channel_count) {
+	struct period_monochord_matrix *mm_ptr;
+	unsigned int s;
+	unsigned int l;
+	unsigned int k;
+	unsigned int c;
+	unsigned int v;
+	int rc;
+
+	if (channel_count == 0 || channel_count > PERIOD_BANK_CHANNEL_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	bank_ptr->monochord_count = period_array_compile_monochords(pa_ptr) * channel_count;
+	bank_ptr->monochords_shed = 0;
+	bank_ptr->sensor_shed = 0;
+	bank_ptr->pa_ptr = pa_ptr;
+	bank_ptr->kernel = NULL;
+	bank_ptr->channel_count = channel_count;
+	bank_ptr->sensor_count = period_array_period_sensor_count(pa_ptr) * channel_count;
+	bank_ptr->sensor_stride = (bank_ptr->sensor_count + PERIOD_BANK_LANE_ALIGN - 1) / PERIOD_BANK_LANE_ALIGN * PERIOD_BANK_LANE_ALIGN;
+	bank_ptr->lane_count = bank_ptr->sensor_count * PERIOD_BANK_SCALES;
+	bank_ptr->lane_stride = (bank_ptr->sensor_stride * PERIOD_BANK_SCALES + PERIOD_BANK_LANE_ALIGN_F - 1) / PERIOD_BANK_LANE_ALIGN_F * PERIOD_BANK_LANE_ALIGN_F;
+
+	bank_ptr->arena = NULL;
+	bank_ptr->arena_size = period_bank_layout(bank_ptr);
+	if (bank_ptr->arena_size == 0) {
+		bank_ptr->arena_size = PERIOD_BANK_ALIGN;
+	}
+	rc = posix_memalign(&bank_ptr->arena, PERIOD_BANK_ALIGN, bank_ptr->arena_size);
+	if (rc != 0) {
+		bank_ptr->arena = NULL;
+		errno = rc;
+		return -1;
+	}
+	memset(bank_ptr->arena, 0, bank_ptr->arena_size);
+	(void) period_bank_layout(bank_ptr);
+
+	/* padding lanes and sensors stay finite, so that whole aligned runs may be processed */
+	for (l = bank_ptr->lane_count; l < bank_ptr->lane_stride; l++) {
+		bank_ptr->period[l]       = 1.0;
+		bank_ptr->window[l]       = 1.0;
+		bank_ptr->alpha[l]        = 1.0;
+		bank_ptr->phase_factor[l] = 1.0;
+		bank_ptr->step_re[l]      = 1.0;
+		bank_ptr->stride_r_factor[l] = 1.0;
+		bank_ptr->alpha_f[l]      = 1.0f;
+		bank_ptr->step_re_f[l]    = 1.0f;
+	}
+	for (s = bank_ptr->sensor_count; s < bank_ptr->sensor_stride; s++) {
+		bank_ptr->response_factor[s] = 1.0;
+	}
+
+	/* each channel's sensors take monochords from the same channel */
+	mm_ptr = &pa_ptr->monochord_matrix;
+	v = 0;
+	for (s = 0; s < bank_ptr->sensor_count; s++) {
+		bank_ptr->monochord_row_begin[s] = v;
+		c = s % channel_count;
+		for (k = mm_ptr->row_begin[s / channel_count]; k < mm_ptr->row_begin[s / channel_count + 1]; k++, v++) {
+			bank_ptr->monochord_source[v] = mm_ptr->source[k] * channel_count + c;
+			bank_ptr->monochord_re[v]     = creal(mm_ptr->value[k]);
+			bank_ptr->monochord_im[v]     = cimag(mm_ptr->value[k]);
+		}
+	}
+	bank_ptr->monochord_row_begin[bank_ptr->sensor_count] = v;
+
+	period_bank_load(bank_ptr);
+
+	return period_bank_set_kernel(bank_ptr, NULL);
+}
+
+void period_bank_deinit(struct period_bank *bank_ptr) {
+	if (bank_ptr->arena != NULL) {
+		free(bank_ptr->arena);
+		bank_ptr->arena = NULL;
+	}
+}
+
+unsigned int period_bank_channel_count(struct period_bank *bank_ptr) {
+	return bank_ptr->channel_count;
+}
+unsigned int period_bank_sensor_count(struct period_bank *bank_ptr) {
+	return bank_ptr->sensor_count;
+}
+unsigned int period_bank_lane_count(struct period_bank *bank_ptr) {
+	return bank_ptr->lane_count;
+}
+
+static void period_bank_load_lifecycle(struct period_bank_lifecycle *blc_ptr, unsigned int s, struct lifecycle *lc_ptr) {
+	blc_ptr->max_r[s]     = lc_ptr->max_r;
+	blc_ptr->F[s]         = lc_ptr->F;
+	blc_ptr->r[s]         = lc_ptr->r;
+	blc_ptr->phi[s]       = lc_ptr->phi;
+	blc_ptr->cycle[s]     = lc_ptr->cycle;
+	blc_ptr->lifecycle[s] = lc_ptr->lifecycle;
+	blc_ptr->cval_re[s]   = creal(lc_ptr->cval);
+	blc_ptr->cval_im[s]   = cimag(lc_ptr->cval);
+}
+static void period_bank_store_lifecycle(struct period_bank_lifecycle *blc_ptr, unsigned int s, struct lifecycle *lc_ptr) {
+	lc_ptr->max_r     = blc_ptr->max_r[s];
+	lc_ptr->F         = blc_ptr->F[s];
+	lc_ptr->r         = blc_ptr->r[s];
+	lc_ptr->phi       = blc_ptr->phi[s];
+	lc_ptr->cycle     = blc_ptr->cycle[s];
+	lc_ptr->lifecycle = blc_ptr->lifecycle[s];
+	lc_ptr->cval      = CMPLX(blc_ptr->cval_re[s], blc_ptr->cval_im[s]);
+}
+
+void period_bank_load(struct period_bank *bank_ptr) {
+	struct scale_space_entry *entries;
+	struct period_scale_space_sensor *sss_ptr;
+	struct period_sensor *ps_ptr;
+	unsigned int s;
+	unsigned int i;
+	unsigned int l;
+
+	entries = period_array_get_entries(bank_ptr->pa_ptr);
+
+	bank_ptr->osc_time = 0.0;
+	bank_ptr->osc_age = PERIOD_BANK_RESYNC; /* resynchronize on the next sample */
+	bank_ptr->has_prior_percept = 0;
+	bank_ptr->has_capture_percept = 0;
+	bank_ptr->pending_stage = PERIOD_BANK_STAGE_NONE;
+	bank_ptr->monochord_parity = 0;
+	bank_ptr->response_stride = bank_ptr->sensor_count > 0 ? entries[0].sensor.response_stride : 1;
+	bank_ptr->next_response_stride = bank_ptr->sensor_count > 0 ? entries[0].sensor.next_response_stride : 0;
+	bank_ptr->response_phase  = bank_ptr->sensor_count > 0 ? entries[0].sensor.response_phase  : 0;
+	for (s = 0; s < bank_ptr->sensor_count; s++) {
+		sss_ptr = &entries[s / bank_ptr->channel_count].sensor;
+
+		for (i = 0; i < PERIOD_BANK_SCALES; i++) {
+			l = s * PERIOD_BANK_SCALES + i;
+			ps_ptr = &sss_ptr->period_sensors[i];
+
+			bank_ptr->cval_re[l] = creal(ps_ptr->sensor_state.ts.v.v);
+			bank_ptr->cval_im[l] = cimag(ps_ptr->sensor_state.ts.v.v);
+			bank_ptr->period[l]  = ps_ptr->field.period;
+			bank_ptr->phase[l]   = ps_ptr->field.phase;
+			bank_ptr->window[l]  = ps_ptr->field.period * ps_ptr->field.period_factor;
+			bank_ptr->alpha[l]   = 1.0 / bank_ptr->window[l];
+			bank_ptr->step_re[l] = cos(tau2rad(1.0 / bank_ptr->period[l]));
+			bank_ptr->step_im[l] = sin(tau2rad(1.0 / bank_ptr->period[l]));
+			bank_ptr->cval_re_f[l] = bank_ptr->cval_re[l];
+			bank_ptr->cval_im_f[l] = bank_ptr->cval_im[l];
+			bank_ptr->alpha_f[l]   = bank_ptr->alpha[l];
+			bank_ptr->step_re_f[l] = bank_ptr->step_re[l];
+			bank_ptr->step_im_f[l] = bank_ptr->step_im[l];
+			bank_ptr->stride_period[l]   = ps_ptr->stride_period;
+			bank_ptr->stride_r[l]        = ps_ptr->stride_r;
+			bank_ptr->stride_r_factor[l] = ps_ptr->stride_r_factor;
+
+			bank_ptr->has_prior_percept = ps_ptr->has_prior_percept;
+			if (ps_ptr->has_prior_percept) {
+				bank_ptr->percept_time       = ps_ptr->percept.timestamp;
+				bank_ptr->prior_percept_time = ps_ptr->prior_percept.timestamp;
+				bank_ptr->percept_re[l]       = creal(ps_ptr->percept.value.cval);
+				bank_ptr->percept_im[l]       = cimag(ps_ptr->percept.value.cval);
+				bank_ptr->percept_r[l]        = receptive_value_get_r(&ps_ptr->percept.value);
+				bank_ptr->prior_percept_re[l] = creal(ps_ptr->prior_percept.value.cval);
+				bank_ptr->prior_percept_im[l] = cimag(ps_ptr->prior_percept.value.cval);
+				bank_ptr->instant_period[l]   = ps_ptr->recept.instant_period;
+				bank_ptr->instant_period_delta[l] = ps_ptr->concept.instant_period_delta;
+			}
+			bank_ptr->has_capture_percept = ps_ptr->has_capture_percept;
+			if (ps_ptr->has_capture_percept) {
+				bank_ptr->capture_percept_time  = ps_ptr->capture_percept.timestamp;
+				bank_ptr->capture_percept_re[l] = creal(ps_ptr->capture_percept.value.cval);
+				bank_ptr->capture_percept_im[l] = cimag(ps_ptr->capture_percept.value.cval);
+			}
+			bank_ptr->phase_factor[l] = ps_ptr->field.phase_factor;
+
+			bank_ptr->avg_instant_period[l]             = ps_ptr->concept_state.avg_instant_period_state.v;
+			bank_ptr->instant_period_delta_has_prior[l] = ps_ptr->concept_state.instant_period_delta_state.has_prior;
+			bank_ptr->instant_period_delta_prior[l]     = ps_ptr->concept_state.instant_period_delta_state.prior_sequence;
+			bank_ptr->instant_period_stddev[l]          = ps_ptr->concept_state.instant_period_stddev_state.v;
+		}
+
+		bank_ptr->response_factor[s] = sss_ptr->period_lifecycle.response_factor;
+		bank_ptr->d_avg[s]           = sss_ptr->period_lifecycle.d_avg_state.v;
+		bank_ptr->dd_avg[s]          = sss_ptr->period_lifecycle.dd_avg_state.v;
+		bank_ptr->d[s]               = sss_ptr->period_lifecycle.d;
+		bank_ptr->dd[s]              = sss_ptr->period_lifecycle.dd;
+		period_bank_load_lifecycle(&bank_ptr->period_lifecycle, s, &sss_ptr->period_lifecycle.lc);
+
+		bank_ptr->beat_d_has_prior[s]  = sss_ptr->beat_lifecycle.d_state.has_prior;
+		bank_ptr->beat_d_prior[s]      = sss_ptr->beat_lifecycle.d_state.prior_sequence;
+		bank_ptr->beat_d[s]            = sss_ptr->beat_lifecycle.d;
+		bank_ptr->beat_dd_has_prior[s] = sss_ptr->beat_lifecycle.dd_state.has_prior;
+		bank_ptr->beat_dd_prior[s]     = sss_ptr->beat_lifecycle.dd_state.prior_sequence;
+		bank_ptr->beat_dd[s]           = sss_ptr->beat_lifecycle.dd;
+		period_bank_load_lifecycle(&bank_ptr->beat_lifecycle, s, &sss_ptr->beat_lifecycle.lc);
+	}
+}
+
+/* widen the float resonator lanes into the double ones */
+static void period_bank_widen(struct period_bank *bank_ptr) {
+	unsigned int l;
+
+	for (l = 0; l < bank_ptr->lane_stride; l++) {
+		bank_ptr->cval_re[l] = bank_ptr->cval_re_f[l];
+		bank_ptr->cval_im[l] = bank_ptr->cval_im_f[l];
+	}
+}
+
+void period_bank_store(struct period_bank *bank_ptr) {
+	period_bank_store_channel(bank_ptr, 0);
+}
+
+void period_bank_store_channel(struct period_bank *bank_ptr, unsigned int channel) {
+	struct scale_space_entry *entries;
+	struct period_scale_space_sensor *sss_ptr;
+	struct period_sensor *ps_ptr;
+	unsigned int a;
+	unsigned int s;
+	unsigned int i;
+	unsigned int l;
+
+	if ( ! bank_ptr->has_prior_percept) {
+		/* nothing sampled yet */
+		return;
+	}
+
+	if (bank_ptr->kernel->single) {
+		period_bank_widen(bank_ptr);
+	}
+
+	entries = period_array_get_entries(bank_ptr->pa_ptr);
+
+	for (a = 0; a < bank_ptr->sensor_count / bank_ptr->channel_count; a++) {
+		s = a * bank_ptr->channel_count + channel;
+		sss_ptr = &entries[a].sensor;
+
+		for (i = 0; i < PERIOD_BANK_SCALES; i++) {
+			l = s * PERIOD_BANK_SCALES + i;
+			ps_ptr = &sss_ptr->period_sensors[i];
+
+			ps_ptr->sensor_state.ts.v.v = CMPLX(bank_ptr->cval_re[l], bank_ptr->cval_im[l]);
+			receptive_value_set_cval(&ps_ptr->value, ps_ptr->sensor_state.ts.v.v);
+			ps_ptr->value.timestamp = bank_ptr->percept_time;
+
+			dynamic_time_smoothing_d_effective_field(&ps_ptr->sensor_state, &ps_ptr->percept.field);
+			receptive_value_set_cval(&ps_ptr->percept.value, CMPLX(bank_ptr->percept_re[l], bank_ptr->percept_im[l]));
+			ps_ptr->percept.value.timestamp = bank_ptr->percept_time;
+			ps_ptr->percept.timestamp       = bank_ptr->percept_time;
+
+			ps_ptr->prior_percept.field = ps_ptr->percept.field;
+			receptive_value_set_cval(&ps_ptr->prior_percept.value, CMPLX(bank_ptr->prior_percept_re[l], bank_ptr->prior_percept_im[l]));
+			ps_ptr->prior_percept.value.timestamp = bank_ptr->prior_percept_time;
+			ps_ptr->prior_percept.timestamp       = bank_ptr->prior_percept_time;
+			ps_ptr->has_prior_percept = 1;
+
+			ps_ptr->capture_percept.field = ps_ptr->percept.field;
+			receptive_value_set_cval(&ps_ptr->capture_percept.value, CMPLX(bank_ptr->capture_percept_re[l], bank_ptr->capture_percept_im[l]));
+			ps_ptr->capture_percept.value.timestamp = bank_ptr->capture_percept_time;
+			ps_ptr->capture_percept.timestamp       = bank_ptr->capture_percept_time;
+			ps_ptr->has_capture_percept = bank_ptr->has_capture_percept;
+
+			/* the recept is a pure function of the percepts, but for the instant period a stride averages, the concept is not */
+			period_recept_init(&ps_ptr->recept, &ps_ptr->percept, &ps_ptr->prior_percept);
+			period_recept_set_instant_period(&ps_ptr->recept, bank_ptr->instant_period[l]);
+			/* the kernels start the averages over on the first sample of a stride, where the sensor has them started already */
+			ps_ptr->stride_period = bank_ptr->response_phase > 0 ? bank_ptr->stride_period[l] : 0.0;
+			ps_ptr->stride_r      = bank_ptr->response_phase > 0 ? bank_ptr->stride_r[l]      : 0.0;
+
+			ps_ptr->concept.recept_ptr                = &ps_ptr->recept;
+			ps_ptr->concept.avg_instant_period        = bank_ptr->avg_instant_period[l];
+			ps_ptr->concept.avg_instant_period_offset = bank_ptr->avg_instant_period[l] - ps_ptr->recept.field.period;
+			ps_ptr->concept.has_instant_period_delta  = 1;
+			ps_ptr->concept.instant_period_delta      = bank_ptr->instant_period_delta[l];
+			ps_ptr->concept.instant_period_stddev     = bank_ptr->instant_period_stddev[l];
+
+			ps_ptr->concept_state.avg_instant_period_state.v                = bank_ptr->avg_instant_period[l];
+			ps_ptr->concept_state.instant_period_delta_state.has_prior      = bank_ptr->instant_period_delta_has_prior[l];
+			ps_ptr->concept_state.instant_period_delta_state.prior_sequence = bank_ptr->instant_period_delta_prior[l];
+			ps_ptr->concept_state.instant_period_stddev_state.v             = bank_ptr->instant_period_stddev[l];
+		}
+
+		sss_ptr->period_lifecycle.d           = bank_ptr->d[s];
+		sss_ptr->period_lifecycle.dd          = bank_ptr->dd[s];
+		sss_ptr->period_lifecycle.d_avg_state.v  = bank_ptr->d_avg[s];
+		sss_ptr->period_lifecycle.dd_avg_state.v = bank_ptr->dd_avg[s];
+		sss_ptr->period_lifecycle.d_avg       = bank_ptr->d_avg[s];
+		sss_ptr->period_lifecycle.dd_avg      = bank_ptr->dd_avg[s];
+		sss_ptr->period_lifecycle.cval_avg    = CMPLX(bank_ptr->d_avg[s], bank_ptr->dd_avg[s]);
+		period_bank_store_lifecycle(&bank_ptr->period_lifecycle, s, &sss_ptr->period_lifecycle.lc);
+
+		sss_ptr->beat_lifecycle.d    = bank_ptr->beat_d[s];
+		sss_ptr->beat_lifecycle.dd   = bank_ptr->beat_dd[s];
+		sss_ptr->beat_lifecycle.d_state.has_prior       = bank_ptr->beat_d_has_prior[s];
+		sss_ptr->beat_lifecycle.d_state.prior_sequence  = bank_ptr->beat_d_prior[s];
+		sss_ptr->beat_lifecycle.dd_state.has_prior      = bank_ptr->beat_dd_has_prior[s];
+		sss_ptr->beat_lifecycle.dd_state.prior_sequence = bank_ptr->beat_dd_prior[s];
+		sss_ptr->beat_lifecycle.cval = CMPLX(bank_ptr->beat_d[s], bank_ptr->beat_dd[s]);
+		period_bank_store_lifecycle(&bank_ptr->beat_lifecycle, s, &sss_ptr->beat_lifecycle.lc);
+
+		sss_ptr->response_phase = bank_ptr->response_phase;
+		/* the stride may have been taken at a response since the bank loaded */
+		sss_ptr->response_stride      = bank_ptr->response_stride;
+		sss_ptr->next_response_stride = bank_ptr->next_response_stride;
+		for (i = 0; i < PERIOD_BANK_SCALES; i++) {
+			period_concept_state_set_response_stride(&sss_ptr->period_sensors[i].concept_state, bank_ptr->response_stride);
+		}
+		sss_ptr->period_lifecycle.response_factor = bank_ptr->response_factor[s];
+
+		period_scale_space_sensor_values(sss_ptr, &entries[a].value);
+	}
+}
+
+/* start the averages of lanes [lane_begin, lane_end) over `response_phase` samples into a stride, as `period_sensor_restart_stride()` */
+static void period_bank_restart_strides(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, unsigned int response_phase) {
+	unsigned int l;
+	double r;
+
+	for (l = lane_begin; l < lane_end; l++) {
+		if (response_phase == 0) {
+			bank_ptr->stride_period[l] = 0.0;
+			bank_ptr->stride_r[l]      = 0.0;
+			continue;
+		}
+		if (bank_ptr->kernel != NULL && bank_ptr->kernel->single) {
+			r = cabs(CMPLX(bank_ptr->cval_re_f[l], bank_ptr->cval_im_f[l]));
+		} else {
+			r = cabs(CMPLX(bank_ptr->cval_re[l], bank_ptr->cval_im[l]));
+		}
+		bank_ptr->stride_period[l] = bank_ptr->avg_instant_period[l] / exponential_smoother_d_stride_factor(bank_ptr->period[l] * bank_ptr->phase_factor[l], response_phase);
+		bank_ptr->stride_r[l]      = r                               / exponential_smoother_d_stride_factor(bank_ptr->stride_r_factor[l], response_phase);
+	}
+}
+
+/* take the response strides and lifecycle factors of the array, as set there */
+static void period_bank_take_response_stride(struct period_bank *bank_ptr) {
+	struct scale_space_entry *entries;
+	unsigned int s;
+	unsigned int i;
+
+	entries = period_array_get_entries(bank_ptr->pa_ptr);
+	bank_ptr->response_stride      = entries[0].sensor.response_stride;
+	bank_ptr->next_response_stride = entries[0].sensor.next_response_stride;
+	for (s = 0; s < bank_ptr->sensor_count; s++) {
+		bank_ptr->response_factor[s] = entries[s / bank_ptr->channel_count].sensor.period_lifecycle.response_factor;
+		for (i = 0; i < PERIOD_BANK_SCALES; i++) {
+			bank_ptr->stride_r_factor[s * PERIOD_BANK_SCALES + i] = entries[s / bank_ptr->channel_count].sensor.period_sensors[i].stride_r_factor;
+		}
+	}
+}
+
+/* the lifecycle factors of sensors [sensor_begin, sensor_end) over the bank's response stride, as `period_scale_space_sensor_set_response_stride()` */
+static void period_bank_response_factors(struct period_bank *bank_ptr, unsigned int sensor_begin, unsigned int sensor_end) {
+	unsigned int s;
+
+	for (s = sensor_begin; s < sensor_end && s < bank_ptr->sensor_count; s++) {
+		bank_ptr->response_factor[s] = exponential_smoother_d_stride_factor(bank_ptr->stride_r_factor[s * PERIOD_BANK_SCALES], bank_ptr->response_stride);
+	}
+}
+
+void period_bank_set_response_stride(struct period_bank *bank_ptr, unsigned int response_stride) {
+	struct scale_space_entry *entries;
+	unsigned int e;
+
+	/* the array's sensors decide whether the stride starts now or at the next response by the bank's phase */
+	entries = period_array_get_entries(bank_ptr->pa_ptr);
+	for (e = 0; e < period_array_period_sensor_count(bank_ptr->pa_ptr); e++) {
+		entries[e].sensor.response_phase = bank_ptr->response_phase;
+	}
+	period_array_set_response_stride(bank_ptr->pa_ptr, response_stride);
+	if (bank_ptr->sensor_count == 0) {
+		return;
+	}
+	period_bank_take_response_stride(bank_ptr);
+}
+
+/* start the percepts of sensors [sensor_begin, sensor_end) over from their held resonators, so that none is from before they were held */
+static void period_bank_restart_percepts(struct period_bank *bank_ptr, unsigned int sensor_begin, unsigned int sensor_end) {
+	unsigned int l;
+	double re;
+	double im;
+
+	for (l = sensor_begin * PERIOD_BANK_SCALES; l < sensor_end * PERIOD_BANK_SCALES; l++) {
+		if (bank_ptr->kernel->single) {
+			re = bank_ptr->cval_re_f[l];
+			im = bank_ptr->cval_im_f[l];
+		} else {
+			re = bank_ptr->cval_re[l];
+			im = bank_ptr->cval_im[l];
+		}
+		bank_ptr->percept_re[l] = bank_ptr->prior_percept_re[l] = bank_ptr->capture_percept_re[l] = re;
+		bank_ptr->percept_im[l] = bank_ptr->prior_percept_im[l] = bank_ptr->capture_percept_im[l] = im;
+	}
+}
+
+unsigned int period_bank_shed_sensors(struct period_bank *bank_ptr, unsigned int count) {
+	unsigned int shed;
+
+	shed = count * bank_ptr->channel_count;
+	if (shed > bank_ptr->sensor_count) {
+		shed = bank_ptr->sensor_count;
+	}
+	shed = (shed + PERIOD_BANK_LANE_ALIGN_F - 1) / PERIOD_BANK_LANE_ALIGN_F * PERIOD_BANK_LANE_ALIGN_F;
+	if (shed >= bank_ptr->sensor_count) {
+		/* leave the last run sampling */
+		shed = (bank_ptr->sensor_count - 1) / PERIOD_BANK_LANE_ALIGN_F * PERIOD_BANK_LANE_ALIGN_F;
+	}
+	if (shed < bank_ptr->sensor_shed) {
+		/* the oscillators of the sensors taken up again are stale, and their percepts and averages from before they were held */
+		bank_ptr->osc_age = PERIOD_BANK_RESYNC;
+		period_bank_restart_percepts(bank_ptr, shed, bank_ptr->sensor_shed);
+		period_bank_restart_strides(bank_ptr, shed * PERIOD_BANK_SCALES, bank_ptr->sensor_shed * PERIOD_BANK_SCALES, bank_ptr->response_phase);
+		/* held, they missed any stride the others took at a response */
+		period_bank_response_factors(bank_ptr, shed, bank_ptr->sensor_shed);
+	}
+	bank_ptr->sensor_shed = shed;
+
+	return shed / bank_ptr->channel_count;
+}
+
+void period_bank_resume(struct period_bank *bank_ptr, unsigned int response_stride, unsigned int next_response_stride, unsigned int response_phase) {
+	period_array_resume_sensors(bank_ptr->pa_ptr, 0, period_array_period_sensor_count(bank_ptr->pa_ptr), response_stride, next_response_stride, response_phase);
+	if (bank_ptr->sensor_count > 0) {
+		period_bank_take_response_stride(bank_ptr);
+	}
+	bank_ptr->osc_age = PERIOD_BANK_RESYNC;
+	bank_ptr->response_phase = response_phase % bank_ptr->response_stride;
+	bank_ptr->has_prior_percept = 0;
+	bank_ptr->has_capture_percept = 0;
+	period_bank_restart_strides(bank_ptr, 0, bank_ptr->lane_count, bank_ptr->response_phase);
+}
+
+void period_bank_shed_monochords(struct period_bank *bank_ptr, int shed) {
+	if (bank_ptr->monochord_count == 0) {
+		return;
+	}
+	if (shed && ! bank_ptr->monochords_shed) {
+		memset(bank_ptr->superposition_re, 0, bank_ptr->lane_stride * sizeof (double));
+		memset(bank_ptr->superposition_im, 0, bank_ptr->lane_stride * sizeof (double));
+	}
+	bank_ptr->monochords_shed = shed;
+}
+
+/*
+ * Hot stage: advance the resonators of lanes [lane_begin, lane_end) over `n` samples.
+ * This is `time_smoothing_d_sample()` with the lane state held in locals, and with a response stride `period_sensor_accumulate()`.
+ */
+static void period_bank_resonate_scalar(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time, const double *samples, size_t n) {
+	const double *x;
+	unsigned int c = bank_ptr->channel_count;
+	unsigned int l;
+	size_t j;
+	double complex cval;
+	double complex prior_cval;
+	double re;
+	double im;
+	double period;
+	double phase;
+	double window;
+	double rad;
+	double stride_period;
+	double stride_r;
+	int accumulate;
+
+	accumulate = bank_ptr->response_stride > 1;
+	for (l = lane_begin; l < lane_end; l++) {
+		re     = bank_ptr->cval_re[l];
+		im     = bank_ptr->cval_im[l];
+		period = bank_ptr->period[l];
+		phase  = bank_ptr->phase[l];
+		window = bank_ptr->window[l];
+		x      = &samples[l / PERIOD_BANK_SCALES % c];
+		/* the averages start over on the first sample of a stride */
+		stride_period = bank_ptr->response_phase > 0 ? bank_ptr->stride_period[l] : 0.0;
+		stride_r      = bank_ptr->response_phase > 0 ? bank_ptr->stride_r[l]      : 0.0;
+
+		for (j = 0; j < n; j++) {
+			prior_cval = CMPLX(re, im);
+			rad = tau2rad((time + j + phase) / period);
+			re += (cos(rad) * x[j * c] - re) / window;
+			im += (sin(rad) * x[j * c] - im) / window;
+			if (accumulate) {
+				cval = CMPLX(re, im);
+				stride_period += (1.0 / (1.0 / period - rad2tau(carg(cval * conj(prior_cval)))) - stride_period) / (period * bank_ptr->phase_factor[l]);
+				stride_r      += (cabs(cval) - stride_r) / bank_ptr->stride_r_factor[l];
+			}
+		}
+
+		bank_ptr->cval_re[l] = re;
+		bank_ptr->cval_im[l] = im;
+		if (accumulate) {
+			bank_ptr->stride_period[l] = stride_period;
+			bank_ptr->stride_r[l]      = stride_r;
+		}
+	}
+}
+
+/*
+ * Cold stage: take the percepts of lanes [lane_begin, lane_end) at `time`, and deduce their recepts and concepts.
+ * This is `period_sensor_sample()` after the resonator, less the polar forms nobody reads per sample.
+ */
+static void period_bank_perceive_scalar(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time) {
+	unsigned int l;
+	double complex cval;
+	double complex prior_cval;
+	double prior_time;
+	double duration;
+	double period;
+	double phi_t;
+	double instant_frequency;
+	double factor;
+
+	prior_time = bank_ptr->has_prior_percept ? bank_ptr->percept_time : time;
+	duration = time - prior_time;
+
+	for (l = lane_begin; l < lane_end; l++) {
+		if (bank_ptr->has_prior_percept) {
+			bank_ptr->prior_percept_re[l] = bank_ptr->percept_re[l];
+			bank_ptr->prior_percept_im[l] = bank_ptr->percept_im[l];
+		}
+		bank_ptr->percept_re[l] = bank_ptr->cval_re[l];
+		bank_ptr->percept_im[l] = bank_ptr->cval_im[l];
+		if (bank_ptr->monochord_count > 0) {
+			bank_ptr->percept_re[l] += bank_ptr->superposition_re[l];
+			bank_ptr->percept_im[l] += bank_ptr->superposition_im[l];
+		}
+		cval = CMPLX(bank_ptr->percept_re[l], bank_ptr->percept_im[l]);
+		bank_ptr->percept_r[l] = cabs(cval);
+		if ( ! bank_ptr->has_prior_percept) {
+			bank_ptr->prior_percept_re[l] = bank_ptr->percept_re[l];
+			bank_ptr->prior_percept_im[l] = bank_ptr->percept_im[l];
+		}
+		prior_cval = CMPLX(bank_ptr->prior_percept_re[l], bank_ptr->prior_percept_im[l]);
+
+		/* recept, or with a stride the average's */
+		period = bank_ptr->period[l];
+		factor = exponential_smoother_d_stride_factor(period * bank_ptr->phase_factor[l], bank_ptr->response_stride);
+		if (bank_ptr->response_stride > 1) {
+			bank_ptr->instant_period[l] = bank_ptr->stride_period[l] * factor;
+		} else {
+			if (duration > 0) {
+				phi_t = rad2tau(carg(delta_dc(cval, prior_cval))) / duration;
+			} else {
+				phi_t = 0.0;
+			}
+			instant_frequency = 1.0 / period - phi_t;
+			bank_ptr->instant_period[l] = 1.0 / instant_frequency;
+		}
+
+		/* concept */
+		bank_ptr->avg_instant_period[l] += (bank_ptr->instant_period[l] - bank_ptr->avg_instant_period[l]) / factor;
+		if (bank_ptr->instant_period_delta_has_prior[l]) {
+			bank_ptr->instant_period_delta[l] = bank_ptr->avg_instant_period[l];
+		} else {
+			bank_ptr->instant_period_delta[l] = bank_ptr->avg_instant_period[l] - bank_ptr->instant_period_delta_prior[l];
+		}
+		factor = exponential_smoother_d_stride_factor(fabs(bank_ptr->instant_period[l] * bank_ptr->phase_factor[l]), bank_ptr->response_stride);
+		bank_ptr->instant_period_stddev[l] += (fabs(bank_ptr->instant_period_delta[l]) - bank_ptr->instant_period_stddev[l]) / factor;
+	}
+}
+
+static void period_bank_lifecycle_sample_scalar(struct period_bank_lifecycle *blc_ptr, unsigned int s, double re, double im) {
+	double prev_phi;
+
+	blc_ptr->cval_re[s] = re;
+	blc_ptr->cval_im[s] = im;
+	blc_ptr->F[s] = re - im;
+	prev_phi = blc_ptr->phi[s];
+	blc_ptr->r[s]   =         cabs(CMPLX(re, im));
+	blc_ptr->phi[s] = rad2tau(carg(CMPLX(re, im)));
+	if (        blc_ptr->phi[s] - prev_phi >  0.5) {
+		blc_ptr->cycle[s]--;
+	}  else if (blc_ptr->phi[s] - prev_phi < -0.5) {
+		blc_ptr->cycle[s]++;
+	}
+
+	blc_ptr->lifecycle[s] = blc_ptr->cycle[s] + blc_ptr->phi[s];
+}
+
+/*
+ * Cold stage: sample the period and beat lifecycles of sensors [sensor_begin, sensor_end) from their percepts.
+ * This is `period_scale_space_sensor_sample_lifecycle()`.
+ */
+static void period_bank_sample_lifecycle_scalar(struct period_bank *bank_ptr, unsigned int sensor_begin, unsigned int sensor_end) {
+	unsigned int s;
+	unsigned int i;
+	double r[PERIOD_BANK_SCALES];
+	double value;
+
+	for (s = sensor_begin; s < sensor_end; s++) {
+		/* the percept magnitudes, or with a stride the averages' */
+		for (i = 0; i < PERIOD_BANK_SCALES; i++) {
+			if (bank_ptr->response_stride > 1) {
+				r[i] = bank_ptr->stride_r[s * PERIOD_BANK_SCALES + i] * bank_ptr->response_factor[s];
+			} else {
+				r[i] = bank_ptr->percept_r[s * PERIOD_BANK_SCALES + i];
+			}
+		}
+
+		/* period lifecycle: scale-space derivatives of the magnitudes */
+		bank_ptr->d[s]  = r[1] - r[0];
+		bank_ptr->dd[s] = (r[2] - r[1]) - bank_ptr->d[s];
+		bank_ptr->d_avg[s]  += (bank_ptr->d[s]  - bank_ptr->d_avg[s])  / bank_ptr->response_factor[s];
+		bank_ptr->dd_avg[s] += (bank_ptr->dd[s] - bank_ptr->dd_avg[s]) / bank_ptr->response_factor[s];
+		period_bank_lifecycle_sample_scalar(&bank_ptr->period_lifecycle, s, bank_ptr->d_avg[s], bank_ptr->dd_avg[s]);
+
+		/* beat lifecycle: time derivatives of the period lifecycle */
+		value = bank_ptr->period_lifecycle.lifecycle[s];
+		if ( ! bank_ptr->beat_d_has_prior[s]) {
+			bank_ptr->beat_d[s] = value - bank_ptr->beat_d_prior[s];
+		}
+		if ( ! bank_ptr->beat_dd_has_prior[s]) {
+			bank_ptr->beat_dd[s] = bank_ptr->beat_d[s] - bank_ptr->beat_dd_prior[s];
+		}
+		period_bank_lifecycle_sample_scalar(&bank_ptr->beat_lifecycle, s, bank_ptr->beat_d[s], bank_ptr->beat_dd[s]);
+	}
+}
+
+/*
+ * Vector kernels
+ *
+ * Each kernel is instantiated from bank_kernel.h with vectors of its native register width,
+ * so that the compiler keeps them in registers instead of splitting wider ones through the stack.
+ */
+
+#if defined(__GNUC__)
+#define PERIOD_BANK_VECTOR 1
+#define PERIOD_BANK_INLINE static inline __attribute__((always_inline))
+
+typedef double    period_bank_vd2 __attribute__((vector_size(16)));
+typedef long long period_bank_vl2 __attribute__((vector_size(16)));
+typedef double    period_bank_vd4 __attribute__((vector_size(32)));
+typedef long long period_bank_vl4 __attribute__((vector_size(32)));
+typedef double    period_bank_vd8 __attribute__((vector_size(64)));
+typedef long long period_bank_vl8 __attribute__((vector_size(64)));
+typedef float     period_bank_vf2  __attribute__((vector_size(8)));
+typedef float     period_bank_vf4  __attribute__((vector_size(16)));
+typedef float     period_bank_vf8  __attribute__((vector_size(32)));
+typedef float     period_bank_vf16 __attribute__((vector_size(64)));
+
+#define PERIOD_BANK_PASTE(name, isa) name##_##isa
+#define PERIOD_BANK_EXPAND(name, isa) PERIOD_BANK_PASTE(name, isa)
+#define PERIOD_BANK_ISA_NAME(name) PERIOD_BANK_EXPAND(name, PERIOD_BANK_ISA)
+
+#define PERIOD_BANK_VLOAD(v, array, i)  memcpy(&(v), &(array)[i], sizeof (v))
+#define PERIOD_BANK_VSTORE(array, i, v) memcpy(&(array)[i], &(v), sizeof (v))
+/* `mask ? a : b` per element, where `mask` is the result of a vector comparison */
+#define PERIOD_BANK_VSELECT(mask, a, b) ((PERIOD_BANK_VD) (((mask) & (PERIOD_BANK_VL) (a)) | (~(mask) & (PERIOD_BANK_VL) (b))))
+#define PERIOD_BANK_VFABS(a) ((PERIOD_BANK_VD) ((PERIOD_BANK_VL) (a) & 0x7FFFFFFFFFFFFFFFLL))
+#define PERIOD_BANK_VSQRT(r, a) do { \
+	PERIOD_BANK_VD va = (a); \
+	double vs[PERIOD_BANK_VW]; \
+	unsigned int vk; \
+	memcpy(vs, &va, sizeof (vs)); \
+	for (vk = 0; vk < PERIOD_BANK_VW; vk++) { \
+		vs[vk] = sqrt(vs[vk]); \
+	} \
+	memcpy(&(r), vs, sizeof (vs)); \
+} while (0)
+
+static int period_bank_supported(void) {
+	return 1;
+}
+
+#define PERIOD_BANK_ISA    vector
+#define PERIOD_BANK_TARGET
+#define PERIOD_BANK_VW     2
+#define PERIOD_BANK_VD     period_bank_vd2
+#define PERIOD_BANK_VL     period_bank_vl2
+#define PERIOD_BANK_VWF    4
+#define PERIOD_BANK_VF     period_bank_vf4
+#define PERIOD_BANK_VFH    period_bank_vf2
+#include "bank_kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PERIOD_BANK_X86 1
+#define PERIOD_BANK_VECTOR_NAME "sse2"
+#define PERIOD_BANK_VECTOR_NAME_F "sse2_f"
+#define PERIOD_BANK_VECTOR_NAME_SCAN "sse2_scan"
+
+#define PERIOD_BANK_ISA    avx2
+#define PERIOD_BANK_TARGET __attribute__((target("avx2")))
+#define PERIOD_BANK_VW     4
+#define PERIOD_BANK_VD     period_bank_vd4
+#define PERIOD_BANK_VL     period_bank_vl4
+#define PERIOD_BANK_VWF    8
+#define PERIOD_BANK_VF     period_bank_vf8
+#define PERIOD_BANK_VFH    period_bank_vf4
+#include "bank_kernel.h"
+
+#define PERIOD_BANK_ISA    avx512
+#define PERIOD_BANK_TARGET __attribute__((target("avx512f,prefer-vector-width=512")))
+#define PERIOD_BANK_VW     8
+#define PERIOD_BANK_VD     period_bank_vd8
+#define PERIOD_BANK_VL     period_bank_vl8
+#define PERIOD_BANK_VWF    16
+#define PERIOD_BANK_VF     period_bank_vf16
+#define PERIOD_BANK_VFH    period_bank_vf8
+#include "bank_kernel.h"
+
+static int period_bank_supported_avx2(void) {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+static int period_bank_supported_avx512(void) {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx512f");
+}
+#else
+#define PERIOD_BANK_VECTOR_NAME "vector"
+#define PERIOD_BANK_VECTOR_NAME_F "vector_f"
+#define PERIOD_BANK_VECTOR_NAME_SCAN "vector_scan"
+#endif
+#else
+static int period_bank_supported(void) {
+	return 1;
+}
+#endif
+
+/* in order of preference, fastest last */
+static const struct period_bank_kernel period_bank_kernels[] = {
+	{"scalar",                   0,                    0, 0, period_bank_supported,         period_bank_resonate_scalar,    period_bank_perceive_scalar,    period_bank_sample_lifecycle_scalar},
+#ifdef PERIOD_BANK_VECTOR
+	{PERIOD_BANK_VECTOR_NAME,    PERIOD_BANK_RESYNC,   0, 0, period_bank_supported,         period_bank_resonate_vector,    period_bank_perceive_vector,    period_bank_sample_lifecycle_vector},
+	{PERIOD_BANK_VECTOR_NAME_SCAN, PERIOD_BANK_RESYNC, 0, 1, period_bank_supported,         period_bank_resonate_scan_vector, period_bank_perceive_vector,  period_bank_sample_lifecycle_vector},
+	{PERIOD_BANK_VECTOR_NAME_F,  PERIOD_BANK_RESYNC_F, 1, 0, period_bank_supported,         period_bank_resonate_f_vector,  period_bank_perceive_f_vector,  period_bank_sample_lifecycle_vector},
+#endif
+#ifdef PERIOD_BANK_X86
+	{"avx2",                     PERIOD_BANK_RESYNC,   0, 0, period_bank_supported_avx2,    period_bank_resonate_avx2,      period_bank_perceive_avx2,      period_bank_sample_lifecycle_avx2},
+	{"avx2_scan",                PERIOD_BANK_RESYNC,   0, 1, period_bank_supported_avx2,    period_bank_resonate_scan_avx2, period_bank_perceive_avx2,      period_bank_sample_lifecycle_avx2},
+	{"avx2_f",                   PERIOD_BANK_RESYNC_F, 1, 0, period_bank_supported_avx2,    period_bank_resonate_f_avx2,    period_bank_perceive_f_avx2,    period_bank_sample_lifecycle_avx2},
+	{"avx512",                   PERIOD_BANK_RESYNC,   0, 0, period_bank_supported_avx512,  period_bank_resonate_avx512,    period_bank_perceive_avx512,    period_bank_sample_lifecycle_avx512},
+	{"avx512_scan",              PERIOD_BANK_RESYNC,   0, 1, period_bank_supported_avx512,  period_bank_resonate_scan_avx512, period_bank_perceive_avx512,  period_bank_sample_lifecycle_avx512},
+	{"avx512_f",                 PERIOD_BANK_RESYNC_F, 1, 0, period_bank_supported_avx512,  period_bank_resonate_f_avx512,  period_bank_perceive_f_avx512,  period_bank_sample_lifecycle_avx512},
+#endif
+};
+
+/* the last supported kernel named `name`, or of precision `single` when `name` is NULL, scanning small banks */
+static int period_bank_select_kernel(struct period_bank *bank_ptr, const char *name, int single) {
+	const struct period_bank_kernel *kernel;
+	unsigned int l;
+	int i;
+
+	for (i = sizeof (period_bank_kernels) / sizeof (period_bank_kernels[0]) - 1; i >= 0; i--) {
+		kernel = &period_bank_kernels[i];
+		if (name != NULL ? strcmp(name, kernel->name) != 0 : kernel->single != single) {
+			continue;
+		}
+		if (name == NULL && kernel->scan && bank_ptr->lane_count > PERIOD_BANK_SCAN_LANES) {
+			continue;
+		}
+		if ( ! kernel->supported()) {
+			continue;
+		}
+
+		/* move the resonator state into the lanes of the new precision */
+		if (kernel->single && (bank_ptr->kernel == NULL || ! bank_ptr->kernel->single)) {
+			for (l = 0; l < bank_ptr->lane_stride; l++) {
+				bank_ptr->cval_re_f[l] = bank_ptr->cval_re[l];
+				bank_ptr->cval_im_f[l] = bank_ptr->cval_im[l];
+			}
+		} else if ( ! kernel->single && bank_ptr->kernel != NULL && bank_ptr->kernel->single) {
+			period_bank_widen(bank_ptr);
+		}
+		bank_ptr->osc_age = PERIOD_BANK_RESYNC;
+		bank_ptr->kernel = kernel;
+		return 0;
+	}
+
+	errno = ENOTSUP;
+	return -1;
+}
+
+int period_bank_set_kernel(struct period_bank *bank_ptr, const char *name) {
+	return period_bank_select_kernel(bank_ptr, name, 0);
+}
+int period_bank_set_kernel_f(struct period_bank *bank_ptr) {
+	return period_bank_select_kernel(bank_ptr, NULL, 1);
+}
+const char *period_bank_get_kernel(struct period_bank *bank_ptr) {
+	return bank_ptr->kernel->name;
+}
+const char *period_bank_kernel_name(unsigned int i) {
+	return i < sizeof (period_bank_kernels) / sizeof (period_bank_kernels[0]) ? period_bank_kernels[i].name : NULL;
+}
+int period_bank_kernel_single(unsigned int i) {
+	return i < sizeof (period_bank_kernels) / sizeof (period_bank_kernels[0]) ? period_bank_kernels[i].single : 0;
+}
+
+/* evaluate the oscillators of lanes [lane_begin, lane_end) exactly at `time` */
+static void period_bank_resync(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time) {
+	unsigned int l;
+	double rad;
+
+	for (l = lane_begin; l < lane_end; l++) {
+		rad = tau2rad((time + bank_ptr->phase[l]) / bank_ptr->period[l]);
+		bank_ptr->osc_re[l] = cos(rad);
+		bank_ptr->osc_im[l] = sin(rad);
+		bank_ptr->osc_re_f[l] = bank_ptr->osc_re[l];
+		bank_ptr->osc_im_f[l] = bank_ptr->osc_im[l];
+	}
+	bank_ptr->osc_time = time;
+	bank_ptr->osc_age = 0;
+}
+
+/* gather the resonators of sensors [sensor_begin, sensor_end) as monochord sources, one cache line per sensor, into the next buffer */
+/* whether the bank gathers and superimposes its monochords: while shed, the superpositions stay 0 */
+static int period_bank_superimposes(struct period_bank *bank_ptr) {
+	return bank_ptr->monochord_count > 0 && ! bank_ptr->monochords_shed;
+}
+
+static void period_bank_gather(struct period_bank *bank_ptr, unsigned int sensor_begin, unsigned int sensor_end) {
+	double *sources;
+	unsigned int s;
+	unsigned int i;
+
+	bank_ptr->monochord_parity ^= 1;
+	sources = &bank_ptr->monochord_sources[bank_ptr->monochord_parity * bank_ptr->sensor_stride * PERIOD_BANK_MONOCHORD_STRIDE];
+
+	if (sensor_end > bank_ptr->sensor_count) {
+		sensor_end = bank_ptr->sensor_count;
+	}
+	for (s = sensor_begin; s < sensor_end; s++) {
+		for (i = 0; i < PERIOD_BANK_SCALES; i++) {
+			if (bank_ptr->kernel->single) {
+				sources[s * PERIOD_BANK_MONOCHORD_STRIDE + i]     = bank_ptr->cval_re_f[s * PERIOD_BANK_SCALES + i];
+				sources[s * PERIOD_BANK_MONOCHORD_STRIDE + 4 + i] = bank_ptr->cval_im_f[s * PERIOD_BANK_SCALES + i];
+			} else {
+				sources[s * PERIOD_BANK_MONOCHORD_STRIDE + i]     = bank_ptr->cval_re[s * PERIOD_BANK_SCALES + i];
+				sources[s * PERIOD_BANK_MONOCHORD_STRIDE + 4 + i] = bank_ptr->cval_im[s * PERIOD_BANK_SCALES + i];
+			}
+		}
+	}
+}
+
+/*
+ * Sum the monochords of target sensors [sensor_begin, sensor_end) into their lanes' superposition, from the sources
+ * gathered last: the product a row at a time, all 3 scales in one vector.
+ */
+static void period_bank_superimpose(struct period_bank *bank_ptr, unsigned int sensor_begin, unsigned int sensor_end) {
+	const double *sources = &bank_ptr->monochord_sources[bank_ptr->monochord_parity * bank_ptr->sensor_stride * PERIOD_BANK_MONOCHORD_STRIDE];
+	const double *source;
+	unsigned int s;
+	unsigned int i;
+	unsigned int k;
+	double cre;
+	double cim;
+#ifdef PERIOD_BANK_VECTOR
+	period_bank_vd4 xre, xim;
+	period_bank_vd4 sre, sim;
+#else
+	double sre[4];
+	double sim[4];
+#endif
+
+	if (sensor_end > bank_ptr->sensor_count) {
+		sensor_end = bank_ptr->sensor_count;
+	}
+	for (s = sensor_begin; s < sensor_end; s++) {
+		if (bank_ptr->monochord_row_begin[s] == bank_ptr->monochord_row_begin[s + 1]) {
+			continue;
+		}
+#ifdef PERIOD_BANK_VECTOR
+		sre = (period_bank_vd4) {0.0, 0.0, 0.0, 0.0};
+		sim = (period_bank_vd4) {0.0, 0.0, 0.0, 0.0};
+#else
+		for (i = 0; i < 4; i++) {
+			sre[i] = 0.0;
+			sim[i] = 0.0;
+		}
+#endif
+		for (k = bank_ptr->monochord_row_begin[s]; k < bank_ptr->monochord_row_begin[s + 1]; k++) {
+			source = &sources[bank_ptr->monochord_source[k] * PERIOD_BANK_MONOCHORD_STRIDE];
+			cre = bank_ptr->monochord_re[k];
+			cim = bank_ptr->monochord_im[k];
+			/* as `double complex` multiplies source by rotation */
+#ifdef PERIOD_BANK_VECTOR
+			memcpy(&xre, &source[0], sizeof (xre));
+			memcpy(&xim, &source[4], sizeof (xim));
+			sre += xre * cre - xim * cim;
+			sim += xre * cim + xim * cre;
+#else
+			for (i = 0; i < PERIOD_BANK_SCALES; i++) {
+				sre[i] += source[i] * cre - source[4 + i] * cim;
+				sim[i] += source[i] * cim + source[4 + i] * cre;
+			}
+#endif
+		}
+		for (i = 0; i < PERIOD_BANK_SCALES; i++) {
+			bank_ptr->superposition_re[s * PERIOD_BANK_SCALES + i] = sre[i];
+			bank_ptr->superposition_im[s * PERIOD_BANK_SCALES + i] = sim[i];
+		}
+	}
+}
+
+/* capture the percepts to be the priors of the next response, on the sample before it */
+static void period_bank_capture(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time) {
+	unsigned int l;
+
+	for (l = lane_begin; l < lane_end; l++) {
+		if (bank_ptr->kernel->single) {
+			bank_ptr->capture_percept_re[l] = bank_ptr->cval_re_f[l];
+			bank_ptr->capture_percept_im[l] = bank_ptr->cval_im_f[l];
+		} else {
+			bank_ptr->capture_percept_re[l] = bank_ptr->cval_re[l];
+			bank_ptr->capture_percept_im[l] = bank_ptr->cval_im[l];
+		}
+		if (bank_ptr->monochord_count > 0) {
+			bank_ptr->capture_percept_re[l] += bank_ptr->superposition_re[l];
+			bank_ptr->capture_percept_im[l] += bank_ptr->superposition_im[l];
+		}
+	}
+	bank_ptr->capture_percept_time = time;
+	bank_ptr->has_capture_percept = 1;
+}
+
+/* make the captured percepts current, so that the kernel's perceive takes them as priors */
+static void period_bank_uncapture(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end) {
+	memcpy(&bank_ptr->percept_re[lane_begin], &bank_ptr->capture_percept_re[lane_begin], (lane_end - lane_begin) * sizeof (double));
+	memcpy(&bank_ptr->percept_im[lane_begin], &bank_ptr->capture_percept_im[lane_begin], (lane_end - lane_begin) * sizeof (double));
+	bank_ptr->percept_time = bank_ptr->capture_percept_time;
+	bank_ptr->has_capture_percept = 0;
+}
+
+/* take the percepts of sensors [sensor_begin, sensor_end) at `time`, in `stage`, after superimposing their monochords */
+static void period_bank_take(struct period_bank *bank_ptr, unsigned int sensor_begin, unsigned int sensor_end, int stage, double time) {
+	const struct period_bank_kernel *kernel = bank_ptr->kernel;
+	unsigned int lane_begin;
+	unsigned int lane_end;
+
+	lane_begin = sensor_begin * PERIOD_BANK_SCALES;
+	lane_end   = sensor_end == bank_ptr->sensor_stride ? bank_ptr->lane_stride : sensor_end * PERIOD_BANK_SCALES;
+
+	if (period_bank_superimposes(bank_ptr)) {
+		RECEPT_PROFILE_BEGIN(monochords_begin);
+		period_bank_superimpose(bank_ptr, sensor_begin, sensor_end);
+		RECEPT_PROFILE_END(monochords_begin, RECEPT_PROFILE_MONOCHORDS);
+	}
+	RECEPT_PROFILE_BEGIN(sensor_begin_ticks);
+	if (stage == PERIOD_BANK_STAGE_CAPTURE) {
+		period_bank_capture(bank_ptr, lane_begin, lane_end, time);
+		RECEPT_PROFILE_END(sensor_begin_ticks, RECEPT_PROFILE_SENSOR);
+		return;
+	}
+
+	if (bank_ptr->has_capture_percept) {
+		period_bank_uncapture(bank_ptr, lane_begin, lane_end);
+	}
+	kernel->perceive(bank_ptr, lane_begin, lane_end, time);
+	RECEPT_PROFILE_END(sensor_begin_ticks, RECEPT_PROFILE_SENSOR);
+	RECEPT_PROFILE_BEGIN(lifecycle_begin);
+	kernel->sample_lifecycle(bank_ptr, sensor_begin, sensor_end);
+	RECEPT_PROFILE_END(lifecycle_begin, RECEPT_PROFILE_LIFECYCLE);
+	bank_ptr->response_phase = 0;
+	if (bank_ptr->next_response_stride > 0) {
+		/* the stride set since the last response starts with this one */
+		bank_ptr->response_stride      = bank_ptr->next_response_stride;
+		bank_ptr->next_response_stride = 0;
+		period_bank_response_factors(bank_ptr, sensor_begin, sensor_end);
+	}
+
+	bank_ptr->prior_percept_time = bank_ptr->has_prior_percept ? bank_ptr->percept_time : time;
+	bank_ptr->percept_time       = time;
+	bank_ptr->has_prior_percept  = 1;
+}
+
+/*
+ * Resonate sensors [sensor_begin, sensor_end) in runs up to the next sample that takes percepts: with a response stride of 1
+ * that is every sample, otherwise the sample before each response, which captures the priors, and the response
+ * (see `period_scale_space_sensor_set_response_stride()`).
+ *
+ * With `split`, return after resonating a sample that takes percepts with monochords, having gathered the sources,
+ * and leave the stage pending for the next call, once every other range has gathered its own.
+ * Returns the samples taken.
+ */
+static size_t period_bank_sample_range(struct period_bank *bank_ptr, unsigned int sensor_begin, unsigned int sensor_end, double time, const double *samples, size_t n, int split) {
+	const struct period_bank_kernel *kernel = bank_ptr->kernel;
+	unsigned int lane_begin;
+	unsigned int lane_end;
+	int stage;
+	size_t j;
+	size_t m;
+
+	lane_begin = sensor_begin * PERIOD_BANK_SCALES;
+	lane_end   = sensor_end == bank_ptr->sensor_stride ? bank_ptr->lane_stride : sensor_end * PERIOD_BANK_SCALES;
+
+	if (bank_ptr->pending_stage != PERIOD_BANK_STAGE_NONE) {
+		period_bank_take(bank_ptr, sensor_begin, sensor_end, bank_ptr->pending_stage, bank_ptr->pending_time);
+		bank_ptr->pending_stage = PERIOD_BANK_STAGE_NONE;
+	}
+
+	for (j = 0; j < n; j += m) {
+		RECEPT_PROFILE_BEGIN(resonate_begin);
+		m = 1;
+		if (bank_ptr->response_phase + 1 < bank_ptr->response_stride) {
+			m = bank_ptr->response_stride - 1 - bank_ptr->response_phase;
+			if (m > n - j) {
+				m = n - j;
+			}
+		}
+		if (kernel->resync > 0) {
+			if (bank_ptr->osc_time != time + j || bank_ptr->osc_age >= kernel->resync) {
+				period_bank_resync(bank_ptr, lane_begin, lane_end, time + j);
+			}
+			if (m > kernel->resync - bank_ptr->osc_age) {
+				m = kernel->resync - bank_ptr->osc_age;
+			}
+		}
+		kernel->resonate(bank_ptr, lane_begin, lane_end, time + j, &samples[j * bank_ptr->channel_count], m);
+		bank_ptr->osc_time = time + j + m;
+		bank_ptr->osc_age += m;
+		bank_ptr->response_phase += m;
+		RECEPT_PROFILE_END(resonate_begin, RECEPT_PROFILE_SENSOR);
+
+		if (bank_ptr->response_phase == bank_ptr->response_stride - 1) {
+			stage = PERIOD_BANK_STAGE_CAPTURE;
+		} else if (bank_ptr->response_phase >= bank_ptr->response_stride) {
+			stage = PERIOD_BANK_STAGE_RESPOND;
+		} else {
+			continue;
+		}
+
+		if (period_bank_superimposes(bank_ptr)) {
+			RECEPT_PROFILE_BEGIN(gather_begin);
+			period_bank_gather(bank_ptr, sensor_begin, sensor_end);
+			RECEPT_PROFILE_END(gather_begin, RECEPT_PROFILE_MONOCHORDS);
+			if (split) {
+				bank_ptr->pending_stage = stage;
+				bank_ptr->pending_time  = time + j + m - 1;
+				return j + m;
+			}
+		}
+		period_bank_take(bank_ptr, sensor_begin, sensor_end, stage, time + j + m - 1);
+	}
+
+	return n;
+}
+
+void period_bank_sample_block(struct period_bank *bank_ptr, double time, const double *samples, size_t n) {
+	(void) period_bank_sample_range(bank_ptr, bank_ptr->sensor_shed, bank_ptr->sensor_stride, time, samples, n, 0);
+}
+
+/* sensor blocks */
+
+unsigned int period_bank_block_count(struct period_bank *bank_ptr) {
+	return (bank_ptr->sensor_stride + PERIOD_BANK_BLOCK_SENSORS - 1) / PERIOD_BANK_BLOCK_SENSORS;
+}
+
+unsigned int period_bank_block_begin(struct period_bank *bank_ptr) {
+	return bank_ptr->sensor_shed / PERIOD_BANK_BLOCK_SENSORS;
+}
+
+size_t period_bank_sample_piece(struct period_bank *view_ptr, unsigned int block, double time, const double *samples, size_t n) {
+	unsigned int sensor_begin;
+	unsigned int sensor_end;
+
+	sensor_begin = block * PERIOD_BANK_BLOCK_SENSORS;
+	sensor_end   = sensor_begin + PERIOD_BANK_BLOCK_SENSORS;
+	if (sensor_end > view_ptr->sensor_stride) {
+		sensor_end = view_ptr->sensor_stride;
+	}
+	if (sensor_begin < view_ptr->sensor_shed) {
+		sensor_begin = view_ptr->sensor_shed;
+	}
+
+	return period_bank_sample_range(view_ptr, sensor_begin, sensor_end, time, samples, n, 1);
+}
+
+void period_bank_adopt(struct period_bank *bank_ptr, const struct period_bank *view_ptr) {
+	*bank_ptr = *view_ptr;
+}
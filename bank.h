@@ -0,0 +1,251 @@
+#ifndef BANK_H
+#define BANK_H
+
+#include <stddef.h>
+
+#include "receptlib.h"
+
+/*
+ * Structure-of-Arrays Sensor Bank
+ *
+ * Mirrors the period sensors of a `struct period_array` as flat lanes, where lane `3 * s + i` is
+ * `period_sensors[i]` of scale-space sensor `s`.
+ *
+ * The per-sample (hot) resonator state lives in contiguous aligned arrays, apart from the
+ * recept/concept/lifecycle (cold) state, so that advancing the resonators only streams hot cache lines.
+ *
+ * The `struct period_array` stays the compatibility view: `period_bank_store()` writes the bank state back into its entries.
+ *
+ * Monochords are taken from the array's compiled matrix when the bank is initialized (see `period_array_compile_monochords()`),
+ * and superimposed on the percepts and captures by one sparse matrix-vector product over the resonators.
+ *
+ * A bank of several channels runs the array's sensors once per channel of interleaved input, channel-minor:
+ * bank sensor `s * channel_count + c` is array sensor `s` on channel `c`, so that a vector of lanes spans channels.
+ * Each lane reads the sample of its own channel, and everything past the resonators is per sensor as before.
+ */
+
+#define PERIOD_BANK_SCALES 3
+#define PERIOD_BANK_ALIGN 64
+#define PERIOD_BANK_LANE_ALIGN (PERIOD_BANK_ALIGN / sizeof (double))
+#define PERIOD_BANK_LANE_ALIGN_F (PERIOD_BANK_ALIGN / sizeof (float))
+/* samples between exact re-evaluations of the vector kernels' oscillators, in double and float */
+#define PERIOD_BANK_RESYNC 1024
+#define PERIOD_BANK_RESYNC_F 128
+/* doubles per sensor in the monochord product, one cache line */
+#define PERIOD_BANK_MONOCHORD_STRIDE 8
+/*
+ * The scan kernels ("sse2_scan", "avx2_scan", "avx512_scan") resonate across time in runs of PERIOD_BANK_SCAN_RUN vectors or more,
+ * and are the default for banks of up to PERIOD_BANK_SCAN_LANES lanes. They agree with their lane kernels to within
+ * PERIOD_BANK_SCAN_TOLERANCE, relative to the resonator's magnitude.
+ */
+#define PERIOD_BANK_SCAN_RUN 16
+#define PERIOD_BANK_SCAN_LANES 24
+#define PERIOD_BANK_SCAN_TOLERANCE 1e-12
+/* channels per bank, and the doubles taken by a chunk of frames spread over the lanes, see bank_kernel.h */
+#define PERIOD_BANK_CHANNEL_MAX 256
+#define PERIOD_BANK_CHANNEL_ROWS 4096
+/* sensors per block, a multiple of PERIOD_BANK_LANE_ALIGN_F: 64 sensors keep about 20kB of hot lanes, within a 32kB L1 */
+#define PERIOD_BANK_BLOCK_SENSORS 64
+
+/* the stages taking percepts */
+#define PERIOD_BANK_STAGE_NONE    0
+#define PERIOD_BANK_STAGE_CAPTURE 1
+#define PERIOD_BANK_STAGE_RESPOND 2
+
+struct period_bank;
+
+/*
+ * A kernel implements the three per-sample stages over a range of lanes or sensors.
+ * Ranges are multiples of PERIOD_BANK_LANE_ALIGN, as padding lanes and sensors are kept finite.
+ *
+ * "scalar" is the reference: bitwise identical to `struct period_array`.
+ * The vector kernels ("sse2", "avx2", "avx512") update 2, 4 and 8 lanes at a time, chosen at run time by CPU support.
+ * They rotate a per-lane oscillator instead of evaluating cos/sin per sample, and use a polynomial arctangent,
+ * so they agree with the reference to within a few ulp per sample rather than bitwise.
+ *
+ * The single-precision kernels ("sse2_f", "avx2_f", "avx512_f") resonate float lanes, twice as many per vector,
+ * and widen the result for the double cold stages. See receptlib.h on where float precision is lost.
+ */
+struct period_bank_kernel {
+	const char *name;
+	unsigned int resync; /* samples between exact oscillator evaluations, or 0 without oscillators */
+	int single;          /* resonates the float lanes */
+	int scan;            /* resonates across time, see PERIOD_BANK_SCAN_RUN */
+	int (*supported)(void);
+	void (*resonate)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time, const double *samples, size_t n);
+	void (*perceive)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time);
+	void (*sample_lifecycle)(struct period_bank *bank_ptr, unsigned int sensor_begin, unsigned int sensor_end);
+};
+
+/* lifecycle state of each sensor, as in `struct lifecycle` */
+struct period_bank_lifecycle {
+	double *max_r;
+	double *F;
+	double *r;
+	double *phi;
+	int    *cycle;
+	double *lifecycle;
+	double *cval_re;
+	double *cval_im;
+};
+
+struct period_bank {
+	struct period_array *pa_ptr;
+	const struct period_bank_kernel *kernel;
+
+	unsigned int channel_count;
+	unsigned int sensor_count;  /* the array's, times channel_count */
+	unsigned int sensor_stride; /* sensor_count padded to PERIOD_BANK_LANE_ALIGN */
+	unsigned int lane_count;
+	unsigned int lane_stride;   /* lane_count padded to PERIOD_BANK_LANE_ALIGN_F, covering sensor_stride */
+
+	/* hot lanes: resonator state, touched every sample */
+	double *cval_re;
+	double *cval_im;
+	double *period;
+	double *phase;
+	double *window; /* period * period_factor */
+	double *alpha;  /* 1 / window */
+	double *osc_re; /* oscillator at `osc_time`, for the vector kernels */
+	double *osc_im;
+	double *step_re; /* oscillator rotation per sample */
+	double *step_im;
+	double  osc_time;
+	unsigned int osc_age;
+
+	/* hot lanes in single precision, for the float kernels */
+	float  *cval_re_f;
+	float  *cval_im_f;
+	float  *alpha_f;
+	float  *osc_re_f;
+	float  *osc_im_f;
+	float  *step_re_f;
+	float  *step_im_f;
+
+	/* hot lanes with a response stride: the averages of every sample since the last response, see `period_sensor_accumulate()` */
+	double *stride_period;
+	double *stride_r;
+	double *stride_r_factor;
+
+	/* cold lanes: percept/recept/concept, touched at response time */
+	unsigned int response_stride; /* as in `struct period_scale_space_sensor` */
+	unsigned int next_response_stride;
+	unsigned int response_phase;
+	int     has_prior_percept;
+	double  percept_time;
+	double  prior_percept_time;
+	double *percept_re;
+	double *percept_im;
+	double *percept_r;
+	double *prior_percept_re;
+	double *prior_percept_im;
+	int     has_capture_percept; /* the priors of the next strided response */
+	double  capture_percept_time;
+	double *capture_percept_re;
+	double *capture_percept_im;
+	double *phase_factor;
+	double *instant_period;
+	double *avg_instant_period;
+	int    *instant_period_delta_has_prior;
+	double *instant_period_delta_prior;
+	double *instant_period_delta;
+	double *instant_period_stddev;
+	int     pending_stage; /* left for the next piece, see `period_bank_sample_piece()` */
+	double  pending_time;
+
+	/* load shed, see `period_bank_shed_sensors()` */
+	unsigned int sensor_shed; /* the first sensors, held still, a multiple of PERIOD_BANK_LANE_ALIGN_F */
+	int          monochords_shed;
+
+	/* monochords: rows of target sensors, by source sensor, with each row's sum spread over its lanes */
+	unsigned int  monochord_count;
+	unsigned int *monochord_row_begin; /* sensor_count + 1 */
+	unsigned int *monochord_source;
+	double       *monochord_re;
+	double       *monochord_im;
+	double       *monochord_sources;   /* 2 buffers of PERIOD_BANK_MONOCHORD_STRIDE per sensor: the 3 scales' re, padding, then im */
+	unsigned int  monochord_parity;    /* the buffer gathered last */
+	double       *superposition_re;
+	double       *superposition_im;
+
+	/* cold sensors: period and beat lifecycles */
+	double *response_factor;
+	double *d_avg;
+	double *dd_avg;
+	double *d;  /* of the last response */
+	double *dd;
+	struct period_bank_lifecycle period_lifecycle;
+	int    *beat_d_has_prior;
+	double *beat_d_prior;
+	double *beat_d;
+	int    *beat_dd_has_prior;
+	double *beat_dd_prior;
+	double *beat_dd;
+	struct period_bank_lifecycle beat_lifecycle;
+
+	void  *arena;
+	size_t arena_size;
+};
+
+int  period_bank_init(struct period_bank *bank_ptr, struct period_array *pa_ptr);
+/* a bank of `channel_count` channels, sampling interleaved frames of as many samples */
+int  period_bank_init_channels(struct period_bank *bank_ptr, struct period_array *pa_ptr, unsigned int channel_count);
+void period_bank_deinit(struct period_bank *bank_ptr);
+
+unsigned int period_bank_channel_count(struct period_bank *bank_ptr);
+unsigned int period_bank_sensor_count(struct period_bank *bank_ptr);
+unsigned int period_bank_lane_count(struct period_bank *bank_ptr);
+
+/* select a kernel by name, or the fastest double kernel the CPU supports when `name` is NULL */
+int period_bank_set_kernel(struct period_bank *bank_ptr, const char *name);
+/* select the fastest single-precision (float) kernel the CPU supports */
+int period_bank_set_kernel_f(struct period_bank *bank_ptr);
+const char *period_bank_get_kernel(struct period_bank *bank_ptr);
+/* the name of built-in kernel `i`, in order of preference, whether or not the CPU supports it, or NULL past the last */
+const char *period_bank_kernel_name(unsigned int i);
+/* whether built-in kernel `i` resonates float lanes */
+int period_bank_kernel_single(unsigned int i);
+
+/* load every channel of the bank from the current state of its period array, response stride included, or store the bank state back into it */
+void period_bank_load(struct period_bank *bank_ptr);
+void period_bank_store(struct period_bank *bank_ptr);
+/* store channel `channel` back into the period array, `period_bank_store()` storing channel 0 */
+void period_bank_store_channel(struct period_bank *bank_ptr, unsigned int channel);
+/* set the response stride of the bank and its array, between blocks, see `period_array_set_response_stride()` */
+void period_bank_set_response_stride(struct period_bank *bank_ptr, unsigned int response_stride);
+
+/*
+ * Load shedding, as `period_array_shed_sensors()` and `period_array_shed_monochords()`, between blocks. Sensors are held in
+ * whole runs of PERIOD_BANK_LANE_ALIGN_F, so the first `count` of the array's sensors round up to the next run, in every
+ * channel; returns the array's sensors held.
+ */
+unsigned int period_bank_shed_sensors(struct period_bank *bank_ptr, unsigned int count);
+void period_bank_shed_monochords(struct period_bank *bank_ptr, int shed);
+/* take the whole bank, held by other means than shedding, up again, as `period_array_resume_sensors()` */
+void period_bank_resume(struct period_bank *bank_ptr, unsigned int response_stride, unsigned int next_response_stride, unsigned int response_phase);
+
+/*
+ * sample a block of `n` samples, where `samples[i]` is at `time + i`, like `period_array_sample_block()`;
+ * with channels, `n` frames, where `samples[i * channel_count + c]` is channel `c` at `time + i`
+ */
+void period_bank_sample_block(struct period_bank *bank_ptr, double time, const double *samples, size_t n);
+
+/*
+ * Sensor blocks: the bank in runs of PERIOD_BANK_BLOCK_SENSORS sensors and their lanes, to be sampled concurrently.
+ *
+ * A piece samples each block on a view, a copy of the bank whose arrays are shared but whose scalars are private.
+ * Blocks touch disjoint lanes and sensors, except that monochords read the sources of every block: with monochords,
+ * a piece ends on each sample that takes percepts, once its block has gathered its sources, and the next piece begins
+ * by superimposing them and taking the percepts. A piece of 0 samples only does the latter.
+ *
+ * Every view of a piece evolves its scalars alike, so the bank adopts any one of them after all are done.
+ * The result is bitwise that of `period_bank_sample_block()`, however the blocks are scheduled.
+ */
+unsigned int period_bank_block_count(struct period_bank *bank_ptr);
+/* the first block holding sensors not shed */
+unsigned int period_bank_block_begin(struct period_bank *bank_ptr);
+/* returns the samples taken: `n`, or fewer with monochords */
+size_t period_bank_sample_piece(struct period_bank *view_ptr, unsigned int block, double time, const double *samples, size_t n);
+void   period_bank_adopt(struct period_bank *bank_ptr, const struct period_bank *view_ptr);
+
+#endif
@@ -0,0 +1,804 @@
+/*
+ * Vector kernel template, included by bank.c once per instruction set with
+ *
+ * PERIOD_BANK_ISA    the kernel name suffix
+ * PERIOD_BANK_TARGET the function attributes enabling the instruction set
+ * PERIOD_BANK_VW     lanes per vector, matching the native register width
+ * PERIOD_BANK_VD     a vector of PERIOD_BANK_VW doubles
+ * PERIOD_BANK_VL     a vector of PERIOD_BANK_VW long longs, for masks
+ * PERIOD_BANK_VWF    lanes per float vector of the same width
+ * PERIOD_BANK_VF     a vector of PERIOD_BANK_VWF floats
+ * PERIOD_BANK_VFH    a vector of PERIOD_BANK_VW floats, to widen into PERIOD_BANK_VD
+ *
+ * Lane ranges are multiples of PERIOD_BANK_LANE_ALIGN_F, and sensor ranges of PERIOD_BANK_LANE_ALIGN,
+ * so of PERIOD_BANK_VWF and PERIOD_BANK_VW too.
+ */
+
+/*
+ * Branch-free arctangent of `y / x` in tau units, in [-0.5, 0.5) like `rad2tau(carg())`.
+ * Reduces to |u| <= tan(pi/8), and evaluates a degree 19 odd Chebyshev fit there (error below 1e-15 radians).
+ */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_vcarg_tau)(PERIOD_BANK_VD *tau_ptr, const PERIOD_BANK_VD *y_ptr, const PERIOD_BANK_VD *x_ptr) {
+	PERIOD_BANK_VD ax, ay;
+	PERIOD_BANK_VD mn, mx;
+	PERIOD_BANK_VD t, u, s;
+	PERIOD_BANK_VD a;
+	PERIOD_BANK_VL swap;
+	PERIOD_BANK_VL big;
+
+	ax = PERIOD_BANK_VFABS(*x_ptr);
+	ay = PERIOD_BANK_VFABS(*y_ptr);
+	swap = ay > ax;
+	mx = PERIOD_BANK_VSELECT(swap, ay, ax);
+	mn = PERIOD_BANK_VSELECT(swap, ax, ay);
+	t = mn / PERIOD_BANK_VSELECT(mx > 0.0, mx, mx * 0.0 + 1.0);
+	big = t > 0.41421356237309503;
+	u = PERIOD_BANK_VSELECT(big, (t - 1.0) / (t + 1.0), t);
+	s = u * u;
+
+	a = s * -0.024617240329098015;
+	a = (a +  0.049715827936569604) * s;
+	a = (a + -0.064890698895336149) * s;
+	a = (a +  0.076706135233025705) * s;
+	a = (a + -0.0908923195846153)   * s;
+	a = (a +  0.11111030633372461)  * s;
+	a = (a + -0.14285712017623661)  * s;
+	a = (a +  0.1999999996658019)   * s;
+	a = (a + -0.33333333333133808)  * s;
+	a = (a +  0.99999999999999745)  * u;
+
+	a = PERIOD_BANK_VSELECT(big,          a + M_PI_4, a);
+	a = PERIOD_BANK_VSELECT(swap,    M_PI_2 - a,      a);
+	a = PERIOD_BANK_VSELECT(*x_ptr < 0.0, M_PI - a,   a);
+	a = PERIOD_BANK_VSELECT(*y_ptr < 0.0,      - a,   a);
+	a = a / RADIAN_CYCLE;
+
+	*tau_ptr = PERIOD_BANK_VSELECT(a >= 0.5, a - 1.0, a);
+}
+
+/* `exponential_smoother_d_stride_factor()` of each lane */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_vstride_factor)(PERIOD_BANK_VD *factor_ptr, unsigned int stride) {
+	PERIOD_BANK_VD base;
+	PERIOD_BANK_VD power;
+
+	if (stride <= 1) {
+		return;
+	}
+
+	base = 1.0 - 1.0 / *factor_ptr;
+	power = base * 0.0 + 1.0;
+	while (stride > 0) {
+		if (stride & 1) {
+			power *= base;
+		}
+		base *= base;
+		stride >>= 1;
+	}
+
+	*factor_ptr = 1.0 / (1.0 - power);
+}
+
+/* a mask of the nonzero `flags[i, i + PERIOD_BANK_VW)` */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_vmask)(PERIOD_BANK_VL *mask_ptr, const int *flags, unsigned int i) {
+	long long mask[PERIOD_BANK_VW];
+	unsigned int k;
+
+	for (k = 0; k < PERIOD_BANK_VW; k++) {
+		mask[k] = flags[i + k] ? -1 : 0;
+	}
+	memcpy(mask_ptr, mask, sizeof (mask));
+}
+
+/* the low and high halves of the float lanes `v`, widened */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_vwiden)(PERIOD_BANK_VD *lo_ptr, PERIOD_BANK_VD *hi_ptr, const PERIOD_BANK_VF *v_ptr) {
+	PERIOD_BANK_VFH h;
+
+	memcpy(&h, v_ptr, sizeof (h));
+	*lo_ptr = __builtin_convertvector(h, PERIOD_BANK_VD);
+	memcpy(&h, (const char *) v_ptr + sizeof (h), sizeof (h));
+	*hi_ptr = __builtin_convertvector(h, PERIOD_BANK_VD);
+}
+
+/*
+ * The response stride's averages of a vector of lanes from `l`: the constants of their smoothing, and the averages themselves,
+ * started over with `restart`, on the first sample of a stride (see `period_sensor_accumulate()`)
+ */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_stride_load)(struct period_bank *bank_ptr, unsigned int l, int restart, PERIOD_BANK_VD *frequency_ptr, PERIOD_BANK_VD *alpha_ptr, PERIOD_BANK_VD *r_alpha_ptr, PERIOD_BANK_VD *period_ptr, PERIOD_BANK_VD *r_ptr) {
+	PERIOD_BANK_VD phase_factor;
+
+	PERIOD_BANK_VLOAD(*frequency_ptr, bank_ptr->period,          l);
+	PERIOD_BANK_VLOAD(phase_factor,   bank_ptr->phase_factor,    l);
+	PERIOD_BANK_VLOAD(*r_alpha_ptr,   bank_ptr->stride_r_factor, l);
+	*alpha_ptr     = 1.0 / (*frequency_ptr * phase_factor);
+	*frequency_ptr = 1.0 / *frequency_ptr;
+	*r_alpha_ptr   = 1.0 / *r_alpha_ptr;
+	if (restart) {
+		*period_ptr = *frequency_ptr * 0.0;
+		*r_ptr      = *frequency_ptr * 0.0;
+	} else {
+		PERIOD_BANK_VLOAD(*period_ptr, bank_ptr->stride_period, l);
+		PERIOD_BANK_VLOAD(*r_ptr,      bank_ptr->stride_r,      l);
+	}
+}
+
+/* add a sample's instant period, from the resonators `pre, pim` before it to `re, im`, and magnitude into the averages */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_accumulate)(PERIOD_BANK_VD *period_ptr, PERIOD_BANK_VD *r_ptr, const PERIOD_BANK_VD *re_ptr, const PERIOD_BANK_VD *im_ptr, const PERIOD_BANK_VD *pre_ptr, const PERIOD_BANK_VD *pim_ptr, const PERIOD_BANK_VD *frequency_ptr, const PERIOD_BANK_VD *alpha_ptr, const PERIOD_BANK_VD *r_alpha_ptr) {
+	PERIOD_BANK_VD y, x;
+	PERIOD_BANK_VD tau;
+	PERIOD_BANK_VD r;
+
+	y = *im_ptr * *pre_ptr - *re_ptr * *pim_ptr;
+	x = *re_ptr * *pre_ptr + *im_ptr * *pim_ptr;
+	PERIOD_BANK_ISA_NAME(period_bank_vcarg_tau)(&tau, &y, &x);
+	*period_ptr += (1.0 / (*frequency_ptr - tau) - *period_ptr) * *alpha_ptr;
+	PERIOD_BANK_VSQRT(r, *re_ptr * *re_ptr + *im_ptr * *im_ptr);
+	*r_ptr += (r - *r_ptr) * *r_alpha_ptr;
+}
+
+/* the same of the float lanes, in double precision: the averages hold far more samples than a float resolves */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_accumulate_f)(PERIOD_BANK_VD *period_ptr, PERIOD_BANK_VD *r_ptr, const PERIOD_BANK_VF *re_ptr, const PERIOD_BANK_VF *im_ptr, const PERIOD_BANK_VF *pre_ptr, const PERIOD_BANK_VF *pim_ptr, const PERIOD_BANK_VD *frequency_ptr, const PERIOD_BANK_VD *alpha_ptr, const PERIOD_BANK_VD *r_alpha_ptr) {
+	PERIOD_BANK_VD re[2], im[2];
+	PERIOD_BANK_VD pre[2], pim[2];
+	unsigned int h;
+
+	PERIOD_BANK_ISA_NAME(period_bank_vwiden)(&re[0],  &re[1],  re_ptr);
+	PERIOD_BANK_ISA_NAME(period_bank_vwiden)(&im[0],  &im[1],  im_ptr);
+	PERIOD_BANK_ISA_NAME(period_bank_vwiden)(&pre[0], &pre[1], pre_ptr);
+	PERIOD_BANK_ISA_NAME(period_bank_vwiden)(&pim[0], &pim[1], pim_ptr);
+	for (h = 0; h < 2; h++) {
+		PERIOD_BANK_ISA_NAME(period_bank_accumulate)(&period_ptr[h], &r_ptr[h], &re[h], &im[h], &pre[h], &pim[h], &frequency_ptr[h], &alpha_ptr[h], &r_alpha_ptr[h]);
+	}
+}
+
+/*
+ * The resonator over interleaved frames, each lane mixing the sample of its channel.
+ * Lane channels repeat every 3 * channel_count lanes, so each chunk of frames is first spread into rows of that many
+ * samples, and a vector's worth more wrapping around, from which any vector of lanes loads its samples at once.
+ * With `accumulate`, the response stride's averages are taken too.
+ */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_resonate_channel_lanes)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, const double *samples, size_t n, int accumulate) {
+	PERIOD_BANK_VD re, im;
+	PERIOD_BANK_VD pre, pim;
+	PERIOD_BANK_VD ore, oim;
+	PERIOD_BANK_VD sre, sim;
+	PERIOD_BANK_VD alpha;
+	PERIOD_BANK_VD t;
+	PERIOD_BANK_VD x;
+	PERIOD_BANK_VD frequency, stride_alpha, r_alpha;
+	PERIOD_BANK_VD stride_period, stride_r;
+	double rows[PERIOD_BANK_CHANNEL_ROWS];
+	unsigned int period;
+	unsigned int width;
+	unsigned int offset;
+	unsigned int q;
+	unsigned int l;
+	size_t chunk;
+	size_t i;
+	int restart;
+	size_t j;
+	size_t m;
+
+	period = PERIOD_BANK_SCALES * bank_ptr->channel_count;
+	width  = period + PERIOD_BANK_VW;
+	chunk  = PERIOD_BANK_CHANNEL_ROWS / width;
+
+	for (i = 0; i < n; i += m) {
+		m = n - i < chunk ? n - i : chunk;
+		for (j = 0; j < m; j++) {
+			for (q = 0; q < width; q++) {
+				rows[j * width + q] = samples[(i + j) * bank_ptr->channel_count + q % period / PERIOD_BANK_SCALES];
+			}
+		}
+
+		/* the averages start over on a stride's first sample, which only the first chunk may hold */
+		restart = i == 0 && bank_ptr->response_phase == 0;
+		for (l = lane_begin; l < lane_end; l += PERIOD_BANK_VW) {
+			PERIOD_BANK_VLOAD(re,    bank_ptr->cval_re, l);
+			PERIOD_BANK_VLOAD(im,    bank_ptr->cval_im, l);
+			PERIOD_BANK_VLOAD(ore,   bank_ptr->osc_re,  l);
+			PERIOD_BANK_VLOAD(oim,   bank_ptr->osc_im,  l);
+			PERIOD_BANK_VLOAD(sre,   bank_ptr->step_re, l);
+			PERIOD_BANK_VLOAD(sim,   bank_ptr->step_im, l);
+			PERIOD_BANK_VLOAD(alpha, bank_ptr->alpha,   l);
+			if (accumulate) {
+				PERIOD_BANK_ISA_NAME(period_bank_stride_load)(bank_ptr, l, restart, &frequency, &stride_alpha, &r_alpha, &stride_period, &stride_r);
+			}
+			offset = l % period;
+
+			for (j = 0; j < m; j++) {
+				PERIOD_BANK_VLOAD(x, rows, j * width + offset);
+				pre = re;
+				pim = im;
+				re += (ore * x - re) * alpha;
+				im += (oim * x - im) * alpha;
+				if (accumulate) {
+					PERIOD_BANK_ISA_NAME(period_bank_accumulate)(&stride_period, &stride_r, &re, &im, &pre, &pim, &frequency, &stride_alpha, &r_alpha);
+				}
+				t   = ore * sre - oim * sim;
+				oim = ore * sim + oim * sre;
+				ore = t;
+			}
+
+			PERIOD_BANK_VSTORE(bank_ptr->cval_re, l, re);
+			PERIOD_BANK_VSTORE(bank_ptr->cval_im, l, im);
+			PERIOD_BANK_VSTORE(bank_ptr->osc_re,  l, ore);
+			PERIOD_BANK_VSTORE(bank_ptr->osc_im,  l, oim);
+			if (accumulate) {
+				PERIOD_BANK_VSTORE(bank_ptr->stride_period, l, stride_period);
+				PERIOD_BANK_VSTORE(bank_ptr->stride_r,      l, stride_r);
+			}
+		}
+	}
+}
+
+static PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_resonate_channels)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, const double *samples, size_t n) {
+	if (bank_ptr->response_stride > 1) {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_channel_lanes)(bank_ptr, lane_begin, lane_end, samples, n, 1);
+	} else {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_channel_lanes)(bank_ptr, lane_begin, lane_end, samples, n, 0);
+	}
+}
+
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_resonate_channel_lanes_f)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, const double *samples, size_t n, int accumulate) {
+	PERIOD_BANK_VF re, im;
+	PERIOD_BANK_VF pre, pim;
+	PERIOD_BANK_VF ore, oim;
+	PERIOD_BANK_VF sre, sim;
+	PERIOD_BANK_VF alpha;
+	PERIOD_BANK_VF t;
+	PERIOD_BANK_VF x;
+	PERIOD_BANK_VD frequency[2], stride_alpha[2], r_alpha[2];
+	PERIOD_BANK_VD stride_period[2], stride_r[2];
+	float rows[PERIOD_BANK_CHANNEL_ROWS];
+	unsigned int period;
+	unsigned int width;
+	unsigned int offset;
+	unsigned int q;
+	unsigned int l;
+	unsigned int h;
+	size_t chunk;
+	size_t i;
+	int restart;
+	size_t j;
+	size_t m;
+
+	period = PERIOD_BANK_SCALES * bank_ptr->channel_count;
+	width  = period + PERIOD_BANK_VWF;
+	chunk  = PERIOD_BANK_CHANNEL_ROWS / width;
+
+	for (i = 0; i < n; i += m) {
+		m = n - i < chunk ? n - i : chunk;
+		for (j = 0; j < m; j++) {
+			for (q = 0; q < width; q++) {
+				rows[j * width + q] = samples[(i + j) * bank_ptr->channel_count + q % period / PERIOD_BANK_SCALES];
+			}
+		}
+
+		restart = i == 0 && bank_ptr->response_phase == 0;
+		for (l = lane_begin; l < lane_end; l += PERIOD_BANK_VWF) {
+			PERIOD_BANK_VLOAD(re,    bank_ptr->cval_re_f, l);
+			PERIOD_BANK_VLOAD(im,    bank_ptr->cval_im_f, l);
+			PERIOD_BANK_VLOAD(ore,   bank_ptr->osc_re_f,  l);
+			PERIOD_BANK_VLOAD(oim,   bank_ptr->osc_im_f,  l);
+			PERIOD_BANK_VLOAD(sre,   bank_ptr->step_re_f, l);
+			PERIOD_BANK_VLOAD(sim,   bank_ptr->step_im_f, l);
+			PERIOD_BANK_VLOAD(alpha, bank_ptr->alpha_f,   l);
+			if (accumulate) {
+				for (h = 0; h < 2; h++) {
+					PERIOD_BANK_ISA_NAME(period_bank_stride_load)(bank_ptr, l + h * PERIOD_BANK_VW, restart, &frequency[h], &stride_alpha[h], &r_alpha[h], &stride_period[h], &stride_r[h]);
+				}
+			}
+			offset = l % period;
+
+			for (j = 0; j < m; j++) {
+				PERIOD_BANK_VLOAD(x, rows, j * width + offset);
+				pre = re;
+				pim = im;
+				re += (ore * x - re) * alpha;
+				im += (oim * x - im) * alpha;
+				if (accumulate) {
+					PERIOD_BANK_ISA_NAME(period_bank_accumulate_f)(stride_period, stride_r, &re, &im, &pre, &pim, frequency, stride_alpha, r_alpha);
+				}
+				t   = ore * sre - oim * sim;
+				oim = ore * sim + oim * sre;
+				ore = t;
+			}
+
+			PERIOD_BANK_VSTORE(bank_ptr->cval_re_f, l, re);
+			PERIOD_BANK_VSTORE(bank_ptr->cval_im_f, l, im);
+			PERIOD_BANK_VSTORE(bank_ptr->osc_re_f,  l, ore);
+			PERIOD_BANK_VSTORE(bank_ptr->osc_im_f,  l, oim);
+			if (accumulate) {
+				for (h = 0; h < 2; h++) {
+					PERIOD_BANK_VSTORE(bank_ptr->stride_period, l + h * PERIOD_BANK_VW, stride_period[h]);
+					PERIOD_BANK_VSTORE(bank_ptr->stride_r,      l + h * PERIOD_BANK_VW, stride_r[h]);
+				}
+			}
+		}
+	}
+}
+
+static PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_resonate_channels_f)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, const double *samples, size_t n) {
+	if (bank_ptr->response_stride > 1) {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_channel_lanes_f)(bank_ptr, lane_begin, lane_end, samples, n, 1);
+	} else {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_channel_lanes_f)(bank_ptr, lane_begin, lane_end, samples, n, 0);
+	}
+}
+
+/* with `accumulate`, the response stride's averages are taken too */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_resonate_lanes)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, const double *samples, size_t n, int accumulate) {
+	PERIOD_BANK_VD re, im;
+	PERIOD_BANK_VD pre, pim;
+	PERIOD_BANK_VD ore, oim;
+	PERIOD_BANK_VD sre, sim;
+	PERIOD_BANK_VD alpha;
+	PERIOD_BANK_VD t;
+	PERIOD_BANK_VD frequency, stride_alpha, r_alpha;
+	PERIOD_BANK_VD stride_period, stride_r;
+	double x;
+	unsigned int l;
+	size_t j;
+	int restart;
+
+	restart = bank_ptr->response_phase == 0;
+	for (l = lane_begin; l < lane_end; l += PERIOD_BANK_VW) {
+		PERIOD_BANK_VLOAD(re,    bank_ptr->cval_re, l);
+		PERIOD_BANK_VLOAD(im,    bank_ptr->cval_im, l);
+		PERIOD_BANK_VLOAD(ore,   bank_ptr->osc_re,  l);
+		PERIOD_BANK_VLOAD(oim,   bank_ptr->osc_im,  l);
+		PERIOD_BANK_VLOAD(sre,   bank_ptr->step_re, l);
+		PERIOD_BANK_VLOAD(sim,   bank_ptr->step_im, l);
+		PERIOD_BANK_VLOAD(alpha, bank_ptr->alpha,   l);
+		if (accumulate) {
+			PERIOD_BANK_ISA_NAME(period_bank_stride_load)(bank_ptr, l, restart, &frequency, &stride_alpha, &r_alpha, &stride_period, &stride_r);
+		}
+
+		for (j = 0; j < n; j++) {
+			x = samples[j];
+			pre = re;
+			pim = im;
+			/* complex mix and exponential smoothing */
+			re += (ore * x - re) * alpha;
+			im += (oim * x - im) * alpha;
+			if (accumulate) {
+				PERIOD_BANK_ISA_NAME(period_bank_accumulate)(&stride_period, &stride_r, &re, &im, &pre, &pim, &frequency, &stride_alpha, &r_alpha);
+			}
+			/* advance the oscillator */
+			t   = ore * sre - oim * sim;
+			oim = ore * sim + oim * sre;
+			ore = t;
+		}
+
+		PERIOD_BANK_VSTORE(bank_ptr->cval_re, l, re);
+		PERIOD_BANK_VSTORE(bank_ptr->cval_im, l, im);
+		PERIOD_BANK_VSTORE(bank_ptr->osc_re,  l, ore);
+		PERIOD_BANK_VSTORE(bank_ptr->osc_im,  l, oim);
+		if (accumulate) {
+			PERIOD_BANK_VSTORE(bank_ptr->stride_period, l, stride_period);
+			PERIOD_BANK_VSTORE(bank_ptr->stride_r,      l, stride_r);
+		}
+	}
+}
+
+static PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_resonate)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time, const double *samples, size_t n) {
+	(void) time; /* the oscillators are already at `time` */
+
+	if (bank_ptr->channel_count > 1) {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_channels)(bank_ptr, lane_begin, lane_end, samples, n);
+	} else if (bank_ptr->response_stride > 1) {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_lanes)(bank_ptr, lane_begin, lane_end, samples, n, 1);
+	} else {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_lanes)(bank_ptr, lane_begin, lane_end, samples, n, 0);
+	}
+}
+
+/* the single-precision resonator, on the float lanes */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_resonate_lanes_f)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, const double *samples, size_t n, int accumulate) {
+	PERIOD_BANK_VF re, im;
+	PERIOD_BANK_VF pre, pim;
+	PERIOD_BANK_VF ore, oim;
+	PERIOD_BANK_VF sre, sim;
+	PERIOD_BANK_VF alpha;
+	PERIOD_BANK_VF t;
+	PERIOD_BANK_VD frequency[2], stride_alpha[2], r_alpha[2];
+	PERIOD_BANK_VD stride_period[2], stride_r[2];
+	float x;
+	unsigned int l;
+	unsigned int h;
+	size_t j;
+	int restart;
+
+	restart = bank_ptr->response_phase == 0;
+	for (l = lane_begin; l < lane_end; l += PERIOD_BANK_VWF) {
+		PERIOD_BANK_VLOAD(re,    bank_ptr->cval_re_f, l);
+		PERIOD_BANK_VLOAD(im,    bank_ptr->cval_im_f, l);
+		PERIOD_BANK_VLOAD(ore,   bank_ptr->osc_re_f,  l);
+		PERIOD_BANK_VLOAD(oim,   bank_ptr->osc_im_f,  l);
+		PERIOD_BANK_VLOAD(sre,   bank_ptr->step_re_f, l);
+		PERIOD_BANK_VLOAD(sim,   bank_ptr->step_im_f, l);
+		PERIOD_BANK_VLOAD(alpha, bank_ptr->alpha_f,   l);
+		if (accumulate) {
+			for (h = 0; h < 2; h++) {
+				PERIOD_BANK_ISA_NAME(period_bank_stride_load)(bank_ptr, l + h * PERIOD_BANK_VW, restart, &frequency[h], &stride_alpha[h], &r_alpha[h], &stride_period[h], &stride_r[h]);
+			}
+		}
+
+		for (j = 0; j < n; j++) {
+			x = samples[j];
+			pre = re;
+			pim = im;
+			re += (ore * x - re) * alpha;
+			im += (oim * x - im) * alpha;
+			if (accumulate) {
+				PERIOD_BANK_ISA_NAME(period_bank_accumulate_f)(stride_period, stride_r, &re, &im, &pre, &pim, frequency, stride_alpha, r_alpha);
+			}
+			t   = ore * sre - oim * sim;
+			oim = ore * sim + oim * sre;
+			ore = t;
+		}
+
+		PERIOD_BANK_VSTORE(bank_ptr->cval_re_f, l, re);
+		PERIOD_BANK_VSTORE(bank_ptr->cval_im_f, l, im);
+		PERIOD_BANK_VSTORE(bank_ptr->osc_re_f,  l, ore);
+		PERIOD_BANK_VSTORE(bank_ptr->osc_im_f,  l, oim);
+		if (accumulate) {
+			for (h = 0; h < 2; h++) {
+				PERIOD_BANK_VSTORE(bank_ptr->stride_period, l + h * PERIOD_BANK_VW, stride_period[h]);
+				PERIOD_BANK_VSTORE(bank_ptr->stride_r,      l + h * PERIOD_BANK_VW, stride_r[h]);
+			}
+		}
+	}
+}
+
+static PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_resonate_f)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time, const double *samples, size_t n) {
+	(void) time; /* the oscillators are already at `time` */
+
+	if (bank_ptr->channel_count > 1) {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_channels_f)(bank_ptr, lane_begin, lane_end, samples, n);
+	} else if (bank_ptr->response_stride > 1) {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_lanes_f)(bank_ptr, lane_begin, lane_end, samples, n, 1);
+	} else {
+		PERIOD_BANK_ISA_NAME(period_bank_resonate_lanes_f)(bank_ptr, lane_begin, lane_end, samples, n, 0);
+	}
+}
+
+/*
+ * The resonator vectorized across time rather than lanes, for banks too small to fill the vectors.
+ *
+ * The smoother is linear: after `n` samples, cval = beta^n cval + alpha sum_k beta^(n - 1 - k) osc_k x_k, with beta = 1 - alpha.
+ * A lane takes PERIOD_BANK_VW samples at a time, with a vector of as many oscillators and of the weights beta^(VW - 1 - i),
+ * into a vector accumulator that decays by beta^VW per step, and is summed once at the end.
+ * Two such steps run interleaved, even and odd, each rotating and decaying by two steps at once,
+ * so that the only sequential dependencies are two independent multiply-adds. The remainder is sampled sequentially.
+ *
+ * Reassociating the sum changes the rounding: see PERIOD_BANK_SCAN_TOLERANCE.
+ */
+
+/* accumulate the samples `samples[j, j + VW)` into `are, aim`, at the oscillators `ore, oim` */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_scan_step)(PERIOD_BANK_VD *are_ptr, PERIOD_BANK_VD *aim_ptr, const PERIOD_BANK_VD *ore_ptr, const PERIOD_BANK_VD *oim_ptr, const PERIOD_BANK_VD *weight_ptr, double decay, const double *samples, size_t j) {
+	PERIOD_BANK_VD x;
+
+	PERIOD_BANK_VLOAD(x, samples, j);
+	x *= *weight_ptr;
+	*are_ptr = *are_ptr * decay + *ore_ptr * x;
+	*aim_ptr = *aim_ptr * decay + *oim_ptr * x;
+}
+
+/* rotate the oscillators `ore, oim` by `wre, wim` */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_scan_rotate)(PERIOD_BANK_VD *ore_ptr, PERIOD_BANK_VD *oim_ptr, double wre, double wim) {
+	PERIOD_BANK_VD t;
+
+	t        = *ore_ptr * wre - *oim_ptr * wim;
+	*oim_ptr = *ore_ptr * wim + *oim_ptr * wre;
+	*ore_ptr = t;
+}
+
+static PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_resonate_scan)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time, const double *samples, size_t n) {
+	PERIOD_BANK_VD are0, aim0, are1, aim1;
+	PERIOD_BANK_VD ore0, oim0, ore1, oim1;
+	PERIOD_BANK_VD weight;
+	double lane_ore[PERIOD_BANK_VW];
+	double lane_oim[PERIOD_BANK_VW];
+	double lane_weight[PERIOD_BANK_VW];
+	double lane_are[PERIOD_BANK_VW];
+	double lane_aim[PERIOD_BANK_VW];
+	unsigned int l;
+	unsigned int i;
+	double alpha, beta, decay, decay2;
+	double sre, sim;
+	double wre, wim;
+	double w2re, w2im;
+	double re, im;
+	double u;
+	size_t j;
+
+	if (n < PERIOD_BANK_SCAN_RUN * PERIOD_BANK_VW || bank_ptr->channel_count > 1 || bank_ptr->response_stride > 1) {
+		/* too short to pay for the setup, channels that fill the vectors anyway, or a stride averaging every sample's resonator */
+		PERIOD_BANK_ISA_NAME(period_bank_resonate)(bank_ptr, lane_begin, lane_end, time, samples, n);
+		return;
+	}
+
+	/* lane by lane, the padding lanes may as well stay put */
+	if (lane_end > bank_ptr->lane_count) {
+		lane_end = bank_ptr->lane_count;
+	}
+	for (l = lane_begin; l < lane_end; l++) {
+		alpha = bank_ptr->alpha[l];
+		beta  = 1.0 - alpha;
+		sre   = bank_ptr->step_re[l];
+		sim   = bank_ptr->step_im[l];
+
+		/* the oscillators of the first step and the weights, then the rotation and decay per step and per two */
+		lane_ore[0] = bank_ptr->osc_re[l];
+		lane_oim[0] = bank_ptr->osc_im[l];
+		lane_weight[PERIOD_BANK_VW - 1] = alpha;
+		wre = sre;
+		wim = sim;
+		decay = beta;
+		for (i = 1; i < PERIOD_BANK_VW; i++) {
+			lane_ore[i] = lane_ore[i - 1] * sre - lane_oim[i - 1] * sim;
+			lane_oim[i] = lane_ore[i - 1] * sim + lane_oim[i - 1] * sre;
+			lane_weight[PERIOD_BANK_VW - 1 - i] = lane_weight[PERIOD_BANK_VW - i] * beta;
+			re  = wre * sre - wim * sim;
+			wim = wre * sim + wim * sre;
+			wre = re;
+			decay *= beta;
+		}
+		w2re   = wre * wre - wim * wim;
+		w2im   = 2.0 * wre * wim;
+		decay2 = decay * decay;
+
+		/* the initial value decays with the odd steps, which end last */
+		for (i = 0; i < PERIOD_BANK_VW; i++) {
+			lane_are[i] = 0.0;
+			lane_aim[i] = 0.0;
+		}
+		PERIOD_BANK_VLOAD(are0, lane_are, 0);
+		PERIOD_BANK_VLOAD(aim0, lane_aim, 0);
+		lane_are[0] = bank_ptr->cval_re[l];
+		lane_aim[0] = bank_ptr->cval_im[l];
+		PERIOD_BANK_VLOAD(are1, lane_are, 0);
+		PERIOD_BANK_VLOAD(aim1, lane_aim, 0);
+
+		PERIOD_BANK_VLOAD(weight, lane_weight, 0);
+		PERIOD_BANK_VLOAD(ore0, lane_ore, 0);
+		PERIOD_BANK_VLOAD(oim0, lane_oim, 0);
+		ore1 = ore0;
+		oim1 = oim0;
+		PERIOD_BANK_ISA_NAME(period_bank_scan_rotate)(&ore1, &oim1, wre, wim);
+
+		for (j = 0; j + 2 * PERIOD_BANK_VW <= n; j += 2 * PERIOD_BANK_VW) {
+			PERIOD_BANK_ISA_NAME(period_bank_scan_step)(&are0, &aim0, &ore0, &oim0, &weight, decay2, samples, j);
+			PERIOD_BANK_ISA_NAME(period_bank_scan_step)(&are1, &aim1, &ore1, &oim1, &weight, decay2, samples, j + PERIOD_BANK_VW);
+			PERIOD_BANK_ISA_NAME(period_bank_scan_rotate)(&ore0, &oim0, w2re, w2im);
+			PERIOD_BANK_ISA_NAME(period_bank_scan_rotate)(&ore1, &oim1, w2re, w2im);
+		}
+		/* the even steps are one step older */
+		are0 = are0 * decay + are1;
+		aim0 = aim0 * decay + aim1;
+		if (j + PERIOD_BANK_VW <= n) {
+			PERIOD_BANK_ISA_NAME(period_bank_scan_step)(&are0, &aim0, &ore0, &oim0, &weight, decay, samples, j);
+			ore0 = ore1;
+			oim0 = oim1;
+			j += PERIOD_BANK_VW;
+		}
+
+		PERIOD_BANK_VSTORE(lane_are, 0, are0);
+		PERIOD_BANK_VSTORE(lane_aim, 0, aim0);
+		re = 0.0;
+		im = 0.0;
+		for (i = 0; i < PERIOD_BANK_VW; i++) {
+			re += lane_are[i];
+			im += lane_aim[i];
+		}
+
+		PERIOD_BANK_VSTORE(lane_ore, 0, ore0);
+		PERIOD_BANK_VSTORE(lane_oim, 0, oim0);
+		for (i = 0; j < n; i++, j++) {
+			u = samples[j];
+			re += (lane_ore[i] * u - re) * alpha;
+			im += (lane_oim[i] * u - im) * alpha;
+		}
+
+		bank_ptr->cval_re[l] = re;
+		bank_ptr->cval_im[l] = im;
+		bank_ptr->osc_re[l]  = lane_ore[i];
+		bank_ptr->osc_im[l]  = lane_oim[i];
+	}
+}
+
+/* `single` reads the resonators from the float lanes */
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_perceive_lanes)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time, int single) {
+	PERIOD_BANK_VD re, im;
+	PERIOD_BANK_VD sre, sim;
+	PERIOD_BANK_VD pre, pim;
+	PERIOD_BANK_VD r;
+	PERIOD_BANK_VD y, x;
+	PERIOD_BANK_VD phi;
+	PERIOD_BANK_VD period, phase_factor;
+	PERIOD_BANK_VD instant_period;
+	PERIOD_BANK_VD avg, delta, delta_prior, stddev;
+	PERIOD_BANK_VD factor;
+	PERIOD_BANK_VL delta_has_prior;
+	PERIOD_BANK_VFH fre, fim;
+	double duration_reciprocal;
+	unsigned int l;
+
+	duration_reciprocal = bank_ptr->has_prior_percept && time > bank_ptr->percept_time ? 1.0 / (time - bank_ptr->percept_time) : 0.0;
+
+	for (l = lane_begin; l < lane_end; l += PERIOD_BANK_VW) {
+		if (single) {
+			PERIOD_BANK_VLOAD(fre, bank_ptr->cval_re_f, l);
+			PERIOD_BANK_VLOAD(fim, bank_ptr->cval_im_f, l);
+			re = __builtin_convertvector(fre, PERIOD_BANK_VD);
+			im = __builtin_convertvector(fim, PERIOD_BANK_VD);
+		} else {
+			PERIOD_BANK_VLOAD(re, bank_ptr->cval_re, l);
+			PERIOD_BANK_VLOAD(im, bank_ptr->cval_im, l);
+		}
+		if (bank_ptr->monochord_count > 0) {
+			PERIOD_BANK_VLOAD(sre, bank_ptr->superposition_re, l);
+			PERIOD_BANK_VLOAD(sim, bank_ptr->superposition_im, l);
+			re += sre;
+			im += sim;
+		}
+		if (bank_ptr->has_prior_percept) {
+			PERIOD_BANK_VLOAD(pre, bank_ptr->percept_re, l);
+			PERIOD_BANK_VLOAD(pim, bank_ptr->percept_im, l);
+		} else {
+			pre = re;
+			pim = im;
+		}
+		PERIOD_BANK_VSTORE(bank_ptr->prior_percept_re, l, pre);
+		PERIOD_BANK_VSTORE(bank_ptr->prior_percept_im, l, pim);
+		PERIOD_BANK_VSTORE(bank_ptr->percept_re, l, re);
+		PERIOD_BANK_VSTORE(bank_ptr->percept_im, l, im);
+		PERIOD_BANK_VSQRT(r, re * re + im * im);
+		PERIOD_BANK_VSTORE(bank_ptr->percept_r, l, r);
+
+		/* recept: the angle of cval / prior_cval is the angle of cval * conj(prior_cval), or with a stride the average's */
+		PERIOD_BANK_VLOAD(period,       bank_ptr->period,       l);
+		PERIOD_BANK_VLOAD(phase_factor, bank_ptr->phase_factor, l);
+		factor = period * phase_factor;
+		PERIOD_BANK_ISA_NAME(period_bank_vstride_factor)(&factor, bank_ptr->response_stride);
+		if (bank_ptr->response_stride > 1) {
+			PERIOD_BANK_VLOAD(instant_period, bank_ptr->stride_period, l);
+			instant_period *= factor;
+		} else {
+			y = im * pre - re * pim;
+			x = re * pre + im * pim;
+			PERIOD_BANK_ISA_NAME(period_bank_vcarg_tau)(&phi, &y, &x);
+			instant_period = 1.0 / (1.0 / period - phi * duration_reciprocal);
+		}
+		PERIOD_BANK_VSTORE(bank_ptr->instant_period, l, instant_period);
+
+		/* concept */
+		PERIOD_BANK_VLOAD(avg,          bank_ptr->avg_instant_period,         l);
+		PERIOD_BANK_VLOAD(delta_prior,  bank_ptr->instant_period_delta_prior, l);
+		PERIOD_BANK_VLOAD(stddev,       bank_ptr->instant_period_stddev,      l);
+		PERIOD_BANK_ISA_NAME(period_bank_vmask)(&delta_has_prior, bank_ptr->instant_period_delta_has_prior, l);
+		avg += (instant_period - avg) / factor;
+		delta = PERIOD_BANK_VSELECT(delta_has_prior, avg, avg - delta_prior);
+		factor = PERIOD_BANK_VFABS(instant_period * phase_factor);
+		PERIOD_BANK_ISA_NAME(period_bank_vstride_factor)(&factor, bank_ptr->response_stride);
+		stddev += (PERIOD_BANK_VFABS(delta) - stddev) / factor;
+		PERIOD_BANK_VSTORE(bank_ptr->avg_instant_period,    l, avg);
+		PERIOD_BANK_VSTORE(bank_ptr->instant_period_delta,  l, delta);
+		PERIOD_BANK_VSTORE(bank_ptr->instant_period_stddev, l, stddev);
+	}
+}
+
+static PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_perceive)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time) {
+	PERIOD_BANK_ISA_NAME(period_bank_perceive_lanes)(bank_ptr, lane_begin, lane_end, time, 0);
+}
+static PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_perceive_f)(struct period_bank *bank_ptr, unsigned int lane_begin, unsigned int lane_end, double time) {
+	PERIOD_BANK_ISA_NAME(period_bank_perceive_lanes)(bank_ptr, lane_begin, lane_end, time, 1);
+}
+
+PERIOD_BANK_INLINE PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_lifecycle_sample_lanes)(struct period_bank_lifecycle *blc_ptr, unsigned int s, const PERIOD_BANK_VD *re_ptr, const PERIOD_BANK_VD *im_ptr) {
+	PERIOD_BANK_VD prev_phi;
+	PERIOD_BANK_VD phi;
+	PERIOD_BANK_VD dphi;
+	PERIOD_BANK_VD r;
+	PERIOD_BANK_VD lifecycle;
+	PERIOD_BANK_VL cycle;
+	long long cycles[PERIOD_BANK_VW];
+	unsigned int k;
+
+	PERIOD_BANK_VSTORE(blc_ptr->cval_re, s, *re_ptr);
+	PERIOD_BANK_VSTORE(blc_ptr->cval_im, s, *im_ptr);
+	r = *re_ptr - *im_ptr;
+	PERIOD_BANK_VSTORE(blc_ptr->F, s, r);
+	PERIOD_BANK_VSQRT(r, *re_ptr * *re_ptr + *im_ptr * *im_ptr);
+	PERIOD_BANK_VSTORE(blc_ptr->r, s, r);
+
+	PERIOD_BANK_VLOAD(prev_phi, blc_ptr->phi, s);
+	PERIOD_BANK_ISA_NAME(period_bank_vcarg_tau)(&phi, im_ptr, re_ptr);
+	PERIOD_BANK_VSTORE(blc_ptr->phi, s, phi);
+
+	/* comparisons are -1 where true */
+	for (k = 0; k < PERIOD_BANK_VW; k++) {
+		cycles[k] = blc_ptr->cycle[s + k];
+	}
+	memcpy(&cycle, cycles, sizeof (cycles));
+	dphi = phi - prev_phi;
+	cycle += (dphi > 0.5) - (dphi < -0.5);
+	memcpy(cycles, &cycle, sizeof (cycles));
+	for (k = 0; k < PERIOD_BANK_VW; k++) {
+		blc_ptr->cycle[s + k] = cycles[k];
+	}
+
+	lifecycle = __builtin_convertvector(cycle, PERIOD_BANK_VD) + phi;
+	PERIOD_BANK_VSTORE(blc_ptr->lifecycle, s, lifecycle);
+}
+
+static PERIOD_BANK_TARGET void PERIOD_BANK_ISA_NAME(period_bank_sample_lifecycle)(struct period_bank *bank_ptr, unsigned int sensor_begin, unsigned int sensor_end) {
+	PERIOD_BANK_VD r0, r1, r2;
+	PERIOD_BANK_VD d, dd;
+	PERIOD_BANK_VD d_avg, dd_avg;
+	PERIOD_BANK_VD response_factor;
+	PERIOD_BANK_VD value;
+	PERIOD_BANK_VD beat_d, beat_dd;
+	PERIOD_BANK_VD prior;
+	PERIOD_BANK_VL has_prior;
+	double r[PERIOD_BANK_SCALES][PERIOD_BANK_VW];
+	const double *magnitudes;
+	unsigned int s;
+	unsigned int k;
+
+	magnitudes = bank_ptr->response_stride > 1 ? bank_ptr->stride_r : bank_ptr->percept_r;
+	for (s = sensor_begin; s < sensor_end; s += PERIOD_BANK_VW) {
+		/* transpose the magnitudes of the sensors' scales: the percepts', or with a stride the averages' */
+		for (k = 0; k < PERIOD_BANK_VW; k++) {
+			r[0][k] = magnitudes[(s + k) * PERIOD_BANK_SCALES + 0];
+			r[1][k] = magnitudes[(s + k) * PERIOD_BANK_SCALES + 1];
+			r[2][k] = magnitudes[(s + k) * PERIOD_BANK_SCALES + 2];
+		}
+		PERIOD_BANK_VLOAD(r0, r[0], 0);
+		PERIOD_BANK_VLOAD(r1, r[1], 0);
+		PERIOD_BANK_VLOAD(r2, r[2], 0);
+
+		/* period lifecycle: scale-space derivatives of the magnitudes */
+		PERIOD_BANK_VLOAD(response_factor, bank_ptr->response_factor, s);
+		PERIOD_BANK_VLOAD(d_avg,  bank_ptr->d_avg,  s);
+		PERIOD_BANK_VLOAD(dd_avg, bank_ptr->dd_avg, s);
+		if (bank_ptr->response_stride > 1) {
+			r0 *= response_factor;
+			r1 *= response_factor;
+			r2 *= response_factor;
+		}
+		d  = r1 - r0;
+		dd = (r2 - r1) - d;
+		PERIOD_BANK_VSTORE(bank_ptr->d,  s, d);
+		PERIOD_BANK_VSTORE(bank_ptr->dd, s, dd);
+		d_avg  += (d  - d_avg)  / response_factor;
+		dd_avg += (dd - dd_avg) / response_factor;
+		PERIOD_BANK_VSTORE(bank_ptr->d_avg,  s, d_avg);
+		PERIOD_BANK_VSTORE(bank_ptr->dd_avg, s, dd_avg);
+		PERIOD_BANK_ISA_NAME(period_bank_lifecycle_sample_lanes)(&bank_ptr->period_lifecycle, s, &d_avg, &dd_avg);
+
+		/* beat lifecycle: time derivatives of the period lifecycle */
+		PERIOD_BANK_VLOAD(value, bank_ptr->period_lifecycle.lifecycle, s);
+		PERIOD_BANK_VLOAD(beat_d, bank_ptr->beat_d, s);
+		PERIOD_BANK_VLOAD(prior, bank_ptr->beat_d_prior, s);
+		PERIOD_BANK_ISA_NAME(period_bank_vmask)(&has_prior, bank_ptr->beat_d_has_prior, s);
+		beat_d = PERIOD_BANK_VSELECT(has_prior, beat_d, value - prior);
+		PERIOD_BANK_VLOAD(beat_dd, bank_ptr->beat_dd, s);
+		PERIOD_BANK_VLOAD(prior, bank_ptr->beat_dd_prior, s);
+		PERIOD_BANK_ISA_NAME(period_bank_vmask)(&has_prior, bank_ptr->beat_dd_has_prior, s);
+		beat_dd = PERIOD_BANK_VSELECT(has_prior, beat_dd, beat_d - prior);
+		PERIOD_BANK_VSTORE(bank_ptr->beat_d,  s, beat_d);
+		PERIOD_BANK_VSTORE(bank_ptr->beat_dd, s, beat_dd);
+		PERIOD_BANK_ISA_NAME(period_bank_lifecycle_sample_lanes)(&bank_ptr->beat_lifecycle, s, &beat_d, &beat_dd);
+	}
+}
+
+#undef PERIOD_BANK_ISA
+#undef PERIOD_BANK_TARGET
+#undef PERIOD_BANK_VW
+#undef PERIOD_BANK_VD
+#undef PERIOD_BANK_VL
+#undef PERIOD_BANK_VWF
+#undef PERIOD_BANK_VF
+#undef PERIOD_BANK_VFH
@@ -0,0 +1,160 @@
+#include "bank_pool.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+/* run the blocks of each thread's run, starting with worker `w`'s own */
+static void period_bank_pool_work(struct period_bank_pool *pool_ptr, unsigned int w) {
+	struct period_bank_pool_run *run_ptr;
+	struct period_bank view;
+	unsigned int block;
+	unsigned int v;
+	size_t taken;
+
+	for (v = 0; v < pool_ptr->thread_count; v++) {
+		run_ptr = &pool_ptr->runs[(w + v) % pool_ptr->thread_count];
+		for (;;) {
+			block = atomic_fetch_add_explicit(&run_ptr->next, 1, memory_order_relaxed);
+			if (block >= run_ptr->end) {
+				break;
+			}
+			view = *pool_ptr->bank_ptr;
+			taken = period_bank_sample_piece(&view, block, pool_ptr->time, pool_ptr->samples, pool_ptr->n);
+			if (block == period_bank_block_begin(pool_ptr->bank_ptr)) {
+				pool_ptr->result = view;
+				pool_ptr->taken = taken;
+			}
+		}
+	}
+}
+
+static void *period_bank_pool_thread(void *arg) {
+	struct period_bank_pool_worker *worker_ptr = arg;
+	struct period_bank_pool *pool_ptr = worker_ptr->pool_ptr;
+	unsigned long generation = 0;
+
+	pthread_mutex_lock(&pool_ptr->mutex);
+	for (;;) {
+		while ( ! pool_ptr->stop && pool_ptr->generation == generation) {
+			pthread_cond_wait(&pool_ptr->start_cond, &pool_ptr->mutex);
+		}
+		if (pool_ptr->stop) {
+			break;
+		}
+		generation = pool_ptr->generation;
+		pthread_mutex_unlock(&pool_ptr->mutex);
+
+		period_bank_pool_work(pool_ptr, worker_ptr->index);
+
+		pthread_mutex_lock(&pool_ptr->mutex);
+		if (--pool_ptr->active == 0) {
+			pthread_cond_signal(&pool_ptr->done_cond);
+		}
+	}
+	pthread_mutex_unlock(&pool_ptr->mutex);
+
+	return NULL;
+}
+
+int period_bank_pool_init(struct period_bank_pool *pool_ptr, unsigned int thread_count) {
+	long cpus;
+	unsigned int w;
+	int rc;
+
+	if (thread_count == 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		thread_count = cpus > 0 ? cpus : 1;
+	}
+	if (thread_count > PERIOD_BANK_POOL_MAX) {
+		thread_count = PERIOD_BANK_POOL_MAX;
+	}
+
+	pool_ptr->generation = 0;
+	pool_ptr->stop = 0;
+	pool_ptr->active = 0;
+	rc = pthread_mutex_init(&pool_ptr->mutex, NULL);
+	if (rc != 0) {
+		errno = rc;
+		return -1;
+	}
+	pthread_cond_init(&pool_ptr->start_cond, NULL);
+	pthread_cond_init(&pool_ptr->done_cond, NULL);
+
+	pool_ptr->thread_count = 1;
+	pool_ptr->workers[0].pool_ptr = pool_ptr;
+	pool_ptr->workers[0].index = 0;
+	for (w = 1; w < thread_count; w++) {
+		pool_ptr->workers[w].pool_ptr = pool_ptr;
+		pool_ptr->workers[w].index = w;
+		if (pthread_create(&pool_ptr->workers[w].thread, NULL, period_bank_pool_thread, &pool_ptr->workers[w]) != 0) {
+			break;
+		}
+		pool_ptr->thread_count++;
+	}
+
+	return 0;
+}
+
+void period_bank_pool_deinit(struct period_bank_pool *pool_ptr) {
+	unsigned int w;
+
+	pthread_mutex_lock(&pool_ptr->mutex);
+	pool_ptr->stop = 1;
+	pthread_cond_broadcast(&pool_ptr->start_cond);
+	pthread_mutex_unlock(&pool_ptr->mutex);
+
+	for (w = 1; w < pool_ptr->thread_count; w++) {
+		pthread_join(pool_ptr->workers[w].thread, NULL);
+	}
+	pool_ptr->thread_count = 1;
+
+	pthread_cond_destroy(&pool_ptr->done_cond);
+	pthread_cond_destroy(&pool_ptr->start_cond);
+	pthread_mutex_destroy(&pool_ptr->mutex);
+}
+
+unsigned int period_bank_pool_thread_count(struct period_bank_pool *pool_ptr) {
+	return pool_ptr->thread_count;
+}
+
+/* one piece at a time, until the samples are taken and no stage is left pending */
+void period_bank_pool_sample_block(struct period_bank_pool *pool_ptr, struct period_bank *bank_ptr, double time, const double *samples, size_t n) {
+	unsigned int block_begin;
+	unsigned int block_count;
+	unsigned int w;
+	size_t j;
+
+	block_begin = period_bank_block_begin(bank_ptr);
+	block_count = period_bank_block_count(bank_ptr) - block_begin;
+	if (pool_ptr->thread_count == 1 || block_count == 1) {
+		period_bank_sample_block(bank_ptr, time, samples, n);
+		return;
+	}
+
+	for (j = 0; j < n || bank_ptr->pending_stage != PERIOD_BANK_STAGE_NONE; j += pool_ptr->taken) {
+		for (w = 0; w < pool_ptr->thread_count; w++) {
+			atomic_store_explicit(&pool_ptr->runs[w].next, block_begin + block_count * w / pool_ptr->thread_count, memory_order_relaxed);
+			pool_ptr->runs[w].end = block_begin + block_count * (w + 1) / pool_ptr->thread_count;
+		}
+
+		pthread_mutex_lock(&pool_ptr->mutex);
+		pool_ptr->bank_ptr = bank_ptr;
+		pool_ptr->time     = time + j;
+		pool_ptr->samples  = &samples[j * bank_ptr->channel_count];
+		pool_ptr->n        = n - j;
+		pool_ptr->active   = pool_ptr->thread_count - 1;
+		pool_ptr->generation++;
+		pthread_cond_broadcast(&pool_ptr->start_cond);
+		pthread_mutex_unlock(&pool_ptr->mutex);
+
+		period_bank_pool_work(pool_ptr, 0);
+
+		pthread_mutex_lock(&pool_ptr->mutex);
+		while (pool_ptr->active > 0) {
+			pthread_cond_wait(&pool_ptr->done_cond, &pool_ptr->mutex);
+		}
+		pthread_mutex_unlock(&pool_ptr->mutex);
+
+		period_bank_adopt(bank_ptr, &pool_ptr->result);
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef BANK_POOL_H
+#define BANK_POOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "bank.h"
+
+/*
+ * Bank Thread Pool
+ *
+ * Samples the sensor blocks of a `struct period_bank` on a pool of threads, the calling thread among them,
+ * with one synchronization per piece (see `period_bank_sample_piece()`): one per block of samples, or with
+ * monochords, one per sample that takes percepts.
+ *
+ * Each thread owns a contiguous run of blocks, the same on every piece, so that their lanes stay in its cache,
+ * and steals from the others' runs once its own is done. Owners and thieves claim from the front of a run alike.
+ * As blocks never depend on scheduling, the result is bitwise the same for any number of threads.
+ */
+
+#define PERIOD_BANK_POOL_MAX 64
+
+struct period_bank_pool {
+	unsigned int thread_count; /* the calling thread included */
+	struct period_bank_pool_worker {
+		struct period_bank_pool *pool_ptr;
+		unsigned int index;
+		pthread_t thread;
+	} workers[PERIOD_BANK_POOL_MAX]; /* 0 is the calling thread */
+	pthread_mutex_t mutex;
+	pthread_cond_t start_cond;
+	pthread_cond_t done_cond;
+	unsigned long generation;
+	int stop;
+	unsigned int active; /* threads yet to finish the piece */
+
+	/* the piece */
+	struct period_bank *bank_ptr;
+	double time;
+	const double *samples;
+	size_t n;
+	size_t taken;
+	struct period_bank result; /* the view of the first block sampled, see `period_bank_block_begin()` */
+
+	struct period_bank_pool_run {
+		atomic_uint next;
+		unsigned int end;
+	} __attribute__((aligned(64))) runs[PERIOD_BANK_POOL_MAX];
+};
+
+/* start `thread_count` - 1 threads, 0 for one per online CPU; fewer when they cannot be created */
+int  period_bank_pool_init(struct period_bank_pool *pool_ptr, unsigned int thread_count);
+void period_bank_pool_deinit(struct period_bank_pool *pool_ptr);
+unsigned int period_bank_pool_thread_count(struct period_bank_pool *pool_ptr);
+
+/* like `period_bank_sample_block()` */
+void period_bank_pool_sample_block(struct period_bank_pool *pool_ptr, struct period_bank *bank_ptr, double time, const double *samples, size_t n);
+
+#endif
@@ -0,0 +1,516 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "recept.h"
+#include "bank.h"
+#include "bank_pool.h"
+#include "multirate.h"
+
+/* as in `recept_test`'s config */
+#define RECEPT_BENCH_STARTING_NOTE (-9 -12)
+
+/* struct recept_bench_signal */
+
+void recept_bench_signal_init(struct recept_bench_signal *signal_ptr, double sample_rate, double amplitude) {
+	signal_ptr->sample_rate    = sample_rate;
+	signal_ptr->amplitude      = amplitude;
+	signal_ptr->sample         = 0;
+	signal_ptr->chord_phase[0] = 0.0;
+	signal_ptr->chord_phase[1] = 0.0;
+	signal_ptr->sweep_phase    = 0.0;
+	signal_ptr->sweep_period   = sample_rate / 440.0;
+	signal_ptr->fade           = 1.0;
+}
+
+void recept_bench_signal_generate(struct recept_bench_signal *signal_ptr, double *samples, size_t n) {
+	double C4;
+	double wave_period;
+	double power;
+	double value;
+	size_t segment;
+	size_t i;
+
+	C4          = 440.0 * pow(2, -9.0 / 12);
+	wave_period = signal_ptr->sample_rate / 440.0;
+	power       = signal_ptr->amplitude;
+
+	for (i = 0; i < n; i++, signal_ptr->sample++) {
+		segment = (size_t) (signal_ptr->sample / (signal_ptr->sample_rate * RECEPT_BENCH_SEGMENT_SECONDS)) % 3;
+
+		/* the chord runs on through every segment, so that it fades out from where it was */
+		signal_ptr->chord_phase[0] = fmod(signal_ptr->chord_phase[0] + C4 / signal_ptr->sample_rate, 1.0);
+		signal_ptr->chord_phase[1] = fmod(signal_ptr->chord_phase[1] + C4 * 4 / 3 / signal_ptr->sample_rate, 1.0);
+		value  = cos(2.0 * M_PI * signal_ptr->chord_phase[0]) * power / 4;
+		value += cos(2.0 * M_PI * signal_ptr->chord_phase[1]) * power / 4;
+
+		if (segment == 0) {
+			signal_ptr->fade = 1.0;
+		} else if (segment == 1) {
+			signal_ptr->sweep_period *= 0.99999;
+			if (signal_ptr->sweep_period < wave_period / 8) {
+				signal_ptr->sweep_period = wave_period;
+			}
+			signal_ptr->sweep_phase = fmod(signal_ptr->sweep_phase + 1.0 / signal_ptr->sweep_period, 1.0);
+			value = cos(2.0 * M_PI * signal_ptr->sweep_phase) * power / 2;
+		} else {
+			/* down to silence, and then exactly silent */
+			signal_ptr->fade *= 0.9998;
+			value = signal_ptr->fade > 1e-3 ? value * signal_ptr->fade : 0.0;
+		}
+
+		samples[i] = value;
+	}
+}
+
+/* struct recept_bench */
+
+static const char *recept_bench_engine_names[RECEPT_BENCH_ENGINE_COUNT] = {
+	"array",
+	"bank",
+	"multirate",
+};
+
+const char *recept_bench_engine_name(unsigned int engine) {
+	return engine < RECEPT_BENCH_ENGINE_COUNT ? recept_bench_engine_names[engine] : NULL;
+}
+
+int recept_bench_engine_parse(const char *name) {
+	int e;
+
+	for (e = 0; e < RECEPT_BENCH_ENGINE_COUNT; e++) {
+		if (strcmp(name, recept_bench_engine_names[e]) == 0) {
+			return e;
+		}
+	}
+
+	return -1;
+}
+
+int recept_bench_init(struct recept_bench *bench_ptr, double sample_rate, double seconds, unsigned int repeats, unsigned int thread_count) {
+	struct recept_bench_signal signal;
+
+	bench_ptr->sample_rate   = sample_rate;
+	bench_ptr->repeats       = repeats > 0 ? repeats : 1;
+	bench_ptr->signal_frames = (size_t) (seconds * sample_rate);
+	if (bench_ptr->signal_frames == 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	bench_ptr->signal = calloc(bench_ptr->signal_frames, sizeof (*bench_ptr->signal));
+	if (bench_ptr->signal == NULL) {
+		return -1;
+	}
+	recept_bench_signal_init(&signal, sample_rate, RECEPT_BENCH_AMPLITUDE);
+	recept_bench_signal_generate(&signal, bench_ptr->signal, bench_ptr->signal_frames);
+
+	if (period_bank_pool_init(&bench_ptr->pool, thread_count) == -1) {
+		free(bench_ptr->signal);
+		return -1;
+	}
+
+	return 0;
+}
+
+void recept_bench_deinit(struct recept_bench *bench_ptr) {
+	period_bank_pool_deinit(&bench_ptr->pool);
+	free(bench_ptr->signal);
+}
+
+/*
+ * The lowest sensor's period: `recept_test`'s starting note, or low enough that the highest sensor keeps
+ * PERIOD_OCTAVE_MIN_PERIOD samples per period, whichever is longer.
+ */
+static double recept_bench_field_period(double sample_rate, const struct recept_bench_config *config_ptr) {
+	double period;
+	double least;
+
+	period = sample_rate / (440 * pow(2, ((double) RECEPT_BENCH_STARTING_NOTE) / 12));
+	least  = PERIOD_OCTAVE_MIN_PERIOD * pow(2, ((double) config_ptr->field_count) / config_ptr->octave_bandwidth);
+
+	return period > least ? period : least;
+}
+
+struct period_array *recept_bench_array_create(double sample_rate, const struct recept_bench_config *config_ptr) {
+	struct period_array *array_ptr;
+	struct receptive_field *field_ptr;
+	unsigned int sensor_count;
+	double cycle_area;
+	unsigned int h;
+	int source;
+	int t;
+
+	if (config_ptr->field_count < 0 || config_ptr->octave_bandwidth <= 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	cycle_area = 1.0 / (1.0 - exp(-1.0));
+	array_ptr = period_array_create(config_ptr->field_count + 1, config_ptr->monochord_count, 0);
+	if (array_ptr == NULL) {
+		return NULL;
+	}
+	field_ptr = period_array_get_receptive_field(array_ptr);
+	field_ptr->period = recept_bench_field_period(sample_rate, config_ptr);
+	field_ptr->phase = 0.0;
+	field_ptr->phase_factor = cycle_area;
+	period_array_init(array_ptr, sample_rate / RECEPT_BENCH_RESPONSE_HZ, config_ptr->octave_bandwidth, cycle_area);
+	if (period_array_populate(array_ptr, ((double) config_ptr->field_count) / config_ptr->octave_bandwidth, 1.0) == -1) {
+		period_array_destroy(array_ptr);
+		errno = ENOSPC;
+		return NULL;
+	}
+	period_array_set_response_stride(array_ptr, (unsigned int) (sample_rate / RECEPT_BENCH_RESPONSE_HZ));
+
+	/* sensors are populated from the shortest period up, so harmonic `h` of sensor `t` is about log2(h) octaves of sensors before it */
+	sensor_count = period_array_period_sensor_count(array_ptr);
+	for (t = 0; t < (int) sensor_count; t++) {
+		for (h = 2; h < config_ptr->monochord_count + 2; h++) {
+			source = t - (int) lround(config_ptr->octave_bandwidth * log2(h));
+			if (source < 0) {
+				break;
+			}
+			if (period_array_add_monochord(array_ptr, source, t, h) == -1) {
+				period_array_destroy(array_ptr);
+				return NULL;
+			}
+		}
+	}
+
+	return array_ptr;
+}
+
+int recept_bench_octave_array_init(struct period_octave_array *poa_ptr, double sample_rate, const struct recept_bench_config *config_ptr) {
+	struct receptive_field *field_ptr;
+	double cycle_area;
+
+	if (config_ptr->field_count < 0 || config_ptr->octave_bandwidth <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	cycle_area = 1.0 / (1.0 - exp(-1.0));
+	field_ptr = period_octave_array_get_receptive_field(poa_ptr);
+	field_ptr->period = recept_bench_field_period(sample_rate, config_ptr);
+	field_ptr->phase = 0.0;
+	field_ptr->phase_factor = cycle_area;
+	period_octave_array_init(poa_ptr, sample_rate / RECEPT_BENCH_RESPONSE_HZ, config_ptr->octave_bandwidth, cycle_area, PERIOD_OCTAVE_MIN_PERIOD, config_ptr->field_count + 1, 0);
+	if (period_octave_array_populate(poa_ptr, ((double) config_ptr->field_count) / config_ptr->octave_bandwidth, 1.0) == -1) {
+		period_octave_array_deinit(poa_ptr);
+		return -1;
+	}
+	period_octave_array_set_response_stride(poa_ptr, (unsigned int) poa_ptr->response_period);
+	if (period_octave_array_init_banks(poa_ptr, config_ptr->bank_kernel) == -1) {
+		period_octave_array_deinit(poa_ptr);
+		return -1;
+	}
+
+	return 0;
+}
+
+static double recept_bench_now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int recept_bench_run(struct recept_bench *bench_ptr, const struct recept_bench_config *config_ptr, struct recept_bench_result *result_ptr) {
+	struct period_array *array_ptr = NULL;
+	struct period_bank bank;
+	struct period_octave_array octave_array;
+	double time;
+	double start;
+	double elapsed;
+	size_t block_size;
+	size_t i;
+	size_t m;
+	unsigned int r;
+	unsigned int o;
+
+	if (config_ptr->field_count < 0 || config_ptr->octave_bandwidth <= 0 || config_ptr->block_size == 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (config_ptr->engine == RECEPT_BENCH_MULTIRATE && config_ptr->monochord_count > 0) {
+		/* monochords do not reach across octaves */
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	result_ptr->monochord_count = 0;
+
+	switch (config_ptr->engine) {
+		case RECEPT_BENCH_ARRAY:
+		case RECEPT_BENCH_BANK:
+			array_ptr = recept_bench_array_create(bench_ptr->sample_rate, config_ptr);
+			if (array_ptr == NULL) {
+				return -1;
+			}
+			result_ptr->sensor_count    = period_array_period_sensor_count(array_ptr);
+			result_ptr->monochord_count = period_array_compile_monochords(array_ptr);
+			result_ptr->kernel          = "array";
+			if (config_ptr->engine == RECEPT_BENCH_BANK) {
+				if (period_bank_init(&bank, array_ptr) == -1) {
+					period_array_destroy(array_ptr);
+					return -1;
+				}
+				if (period_bank_set_kernel(&bank, config_ptr->bank_kernel) == -1) {
+					period_bank_deinit(&bank);
+					period_array_destroy(array_ptr);
+					return -1;
+				}
+				result_ptr->kernel = period_bank_get_kernel(&bank);
+			}
+			break;
+		case RECEPT_BENCH_MULTIRATE:
+			if (recept_bench_octave_array_init(&octave_array, bench_ptr->sample_rate, config_ptr) == -1) {
+				return -1;
+			}
+			period_octave_array_set_pool(&octave_array, &bench_ptr->pool);
+			result_ptr->sensor_count = 0;
+			result_ptr->kernel = NULL;
+			for (o = 0; o < period_octave_array_octave_count(&octave_array); o++) {
+				if (octave_array.octaves[o].pa_ptr == NULL) {
+					continue;
+				}
+				result_ptr->sensor_count += period_array_period_sensor_count(octave_array.octaves[o].pa_ptr);
+				if (result_ptr->kernel == NULL) {
+					result_ptr->kernel = period_bank_get_kernel(octave_array.octaves[o].bank_ptr);
+				}
+			}
+			break;
+		default:
+			errno = EINVAL;
+			return -1;
+	}
+
+	/* the signal's samples keep counting up through the runs, as the sensors' oscillators do */
+	block_size = config_ptr->block_size;
+	time = 1;
+	result_ptr->seconds = INFINITY;
+	for (r = 0; r < bench_ptr->repeats; r++) {
+		start = recept_bench_now();
+		for (i = 0; i < bench_ptr->signal_frames; i += m) {
+			m = bench_ptr->signal_frames - i < block_size ? bench_ptr->signal_frames - i : block_size;
+			switch (config_ptr->engine) {
+				case RECEPT_BENCH_ARRAY:
+					period_array_sample_block(array_ptr, time, bench_ptr->signal + i, m);
+					break;
+				case RECEPT_BENCH_BANK:
+					period_bank_pool_sample_block(&bench_ptr->pool, &bank, time, bench_ptr->signal + i, m);
+					break;
+				case RECEPT_BENCH_MULTIRATE:
+					period_octave_array_sample_block(&octave_array, time, bench_ptr->signal + i, m);
+					break;
+			}
+			time += m;
+		}
+		elapsed = recept_bench_now() - start;
+		if (elapsed < result_ptr->seconds) {
+			result_ptr->seconds = elapsed;
+		}
+	}
+
+	result_ptr->samples_per_sec      = bench_ptr->signal_frames / result_ptr->seconds;
+	result_ptr->ns_per_sensor_sample = result_ptr->seconds * 1e9 / ((double) bench_ptr->signal_frames * (result_ptr->sensor_count > 0 ? result_ptr->sensor_count : 1));
+	result_ptr->realtime_factor      = result_ptr->samples_per_sec / bench_ptr->sample_rate;
+
+	switch (config_ptr->engine) {
+		case RECEPT_BENCH_BANK:
+			period_bank_deinit(&bank);
+			/* fall through */
+		case RECEPT_BENCH_ARRAY:
+			period_array_destroy(array_ptr);
+			break;
+		case RECEPT_BENCH_MULTIRATE:
+			period_octave_array_deinit(&octave_array);
+			break;
+	}
+
+	return 0;
+}
+
+#ifdef RECEPT_BENCH
+#define RECEPT_BENCH_LIST_MAX 32
+
+/* a comma-separated list of numbers, returning how many, or -1 */
+static int recept_bench_parse_list(const char *list, unsigned int *values) {
+	const char *p = list;
+	char *end;
+	int count = 0;
+
+	while (count < RECEPT_BENCH_LIST_MAX) {
+		values[count++] = strtoul(p, &end, 10);
+		if (end == p || (*end != ',' && *end != '\0')) {
+			return -1;
+		}
+		if (*end == '\0') {
+			return count;
+		}
+		p = end + 1;
+	}
+
+	return -1;
+}
+
+/* a comma-separated list of engine names */
+static int recept_bench_parse_engines(const char *list, unsigned int *values) {
+	char name[32];
+	const char *p = list;
+	size_t length;
+	int count = 0;
+	int e;
+
+	while (count < RECEPT_BENCH_LIST_MAX) {
+		length = strcspn(p, ",");
+		if (length >= sizeof (name)) {
+			return -1;
+		}
+		memcpy(name, p, length);
+		name[length] = '\0';
+		e = recept_bench_engine_parse(name);
+		if (e == -1) {
+			return -1;
+		}
+		values[count++] = e;
+		if (p[length] == '\0') {
+			return count;
+		}
+		p += length + 1;
+	}
+
+	return -1;
+}
+
+int main(int argc, char *argv[]) {
+	struct recept_bench bench;
+	struct recept_bench_config config;
+	struct recept_bench_result result;
+	double sample_rate = 44100;
+	double seconds = 10.0;
+	unsigned int repeats = 5;
+	unsigned int thread_count = 1;
+	const char *bank_kernel = NULL;
+	unsigned int engines[RECEPT_BENCH_LIST_MAX]       = {RECEPT_BENCH_BANK, RECEPT_BENCH_MULTIRATE};
+	unsigned int field_counts[RECEPT_BENCH_LIST_MAX]  = {24, 48, 96, 192};
+	unsigned int bandwidths[RECEPT_BENCH_LIST_MAX]    = {12, 24, 48};
+	unsigned int monochords[RECEPT_BENCH_LIST_MAX]    = {0, 2};
+	unsigned int block_sizes[RECEPT_BENCH_LIST_MAX]   = {64, 735, 4096};
+	int engine_count = 2;
+	int field_count_count = 4;
+	int bandwidth_count = 3;
+	int monochord_count = 2;
+	int block_size_count = 3;
+	int first = 1;
+	int e, f, w, m, b;
+	int rc;
+	int c;
+
+	while ((c = getopt(argc, argv, "r:s:n:j:k:e:f:o:m:b:")) != -1) {
+		switch (c) {
+			case 'r':
+				rc = sscanf(optarg, "%lf", &sample_rate);
+				break;
+			case 's':
+				rc = sscanf(optarg, "%lf", &seconds);
+				break;
+			case 'n':
+				rc = sscanf(optarg, "%u", &repeats);
+				break;
+			case 'j':
+				rc = sscanf(optarg, "%u", &thread_count);
+				break;
+			case 'k':
+				bank_kernel = optarg;
+				rc = 1;
+				break;
+			case 'e':
+				engine_count = recept_bench_parse_engines(optarg, engines);
+				rc = engine_count != -1;
+				break;
+			case 'f':
+				field_count_count = recept_bench_parse_list(optarg, field_counts);
+				rc = field_count_count != -1;
+				break;
+			case 'o':
+				bandwidth_count = recept_bench_parse_list(optarg, bandwidths);
+				rc = bandwidth_count != -1;
+				break;
+			case 'm':
+				monochord_count = recept_bench_parse_list(optarg, monochords);
+				rc = monochord_count != -1;
+				break;
+			case 'b':
+				block_size_count = recept_bench_parse_list(optarg, block_sizes);
+				rc = block_size_count != -1;
+				break;
+			default:
+				rc = 0;
+				break;
+		}
+		if (rc != 1) {
+			optind = argc; /* usage */
+			break;
+		}
+	}
+	if (optind != argc) {
+		fprintf(stderr, "usage: %s [-r rate] [-s seconds] [-n repeats] [-j threads] [-k kernel] [-e array,bank,multirate] [-f fields,...] [-o octave bandwidths,...] [-m monochords,...] [-b block sizes,...]\n", argv[0]);
+		return -1;
+	}
+
+	rc = recept_bench_init(&bench, sample_rate, seconds, repeats, thread_count);
+	if (rc == -1) {
+		perror("recept_bench_init");
+		return -1;
+	}
+
+	/* a JSON object, a line per result, so that it can be read as it comes */
+	printf("{\"sample_rate\": %g, \"seconds\": %g, \"repeats\": %u, \"threads\": %u, \"results\": [\n", sample_rate, seconds, bench.repeats, period_bank_pool_thread_count(&bench.pool));
+	for (e = 0; e < engine_count; e++) {
+		for (f = 0; f < field_count_count; f++) {
+			for (w = 0; w < bandwidth_count; w++) {
+				for (m = 0; m < monochord_count; m++) {
+					for (b = 0; b < block_size_count; b++) {
+						config.engine           = engines[e];
+						config.bank_kernel      = bank_kernel;
+						config.field_count      = field_counts[f];
+						config.octave_bandwidth = bandwidths[w];
+						config.monochord_count  = monochords[m];
+						config.block_size       = block_sizes[b];
+						if (config.octave_bandwidth == 0 || config.field_count > RECEPT_BENCH_OCTAVE_MAX * config.octave_bandwidth ||
+							(config.engine == RECEPT_BENCH_MULTIRATE && config.monochord_count > 0)) {
+							continue;
+						}
+
+						rc = recept_bench_run(&bench, &config, &result);
+						if (rc == -1) {
+							perror("recept_bench_run");
+							return -1;
+						}
+						printf("%s  {\"engine\": \"%s\", \"kernel\": \"%s\", \"fields\": %d, \"sensors\": %u, \"octave_bandwidth\": %d, \"monochords\": %u, \"monochord_links\": %u, \"block_size\": %zu, "
+							"\"seconds\": %.6f, \"samples_per_sec\": %.1f, \"ns_per_sensor_sample\": %.3f, \"realtime_factor\": %.3f}",
+							first ? "" : ",\n", recept_bench_engine_name(config.engine), result.kernel, config.field_count, result.sensor_count, config.octave_bandwidth,
+							config.monochord_count, result.monochord_count, config.block_size,
+							result.seconds, result.samples_per_sec, result.ns_per_sensor_sample, result.realtime_factor);
+						fflush(stdout);
+						first = 0;
+					}
+				}
+			}
+		}
+	}
+	printf("\n]}\n");
+
+	recept_bench_deinit(&bench);
+
+	return 0;
+}
+#endif
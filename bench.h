@@ -0,0 +1,95 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+
+#include "bank_pool.h"
+
+/*
+ * Throughput Benchmark
+ *
+ * Runs a synthetic signal through the sensors of `recept_test`, for a range of sizes and engines, and times it.
+ *
+ * The signal is deterministic, as `periodic_test(generate=True)` in recept.py: it cycles through segments of
+ * RECEPT_BENCH_SEGMENT_SECONDS each, a chord of C4 and F4, an exponential sweep down from A4's period to an eighth of it,
+ * and the chord fading out into silence. So every run samples the same values, wherever the signal is cut into blocks.
+ *
+ * Each configuration runs the whole signal `repeats` times on one engine, without a display, and keeps the fastest
+ * run, as the least disturbed by the rest of the machine. Sensors and their state carry over between runs.
+ */
+
+#define RECEPT_BENCH_SEGMENT_SECONDS 1.0
+#define RECEPT_BENCH_AMPLITUDE 100.0
+/* responses per second, as in `recept_test`'s config */
+#define RECEPT_BENCH_RESPONSE_HZ 60.0
+/* the widest span of sensors taken, in octaves, as of hearing */
+#define RECEPT_BENCH_OCTAVE_MAX 10
+
+struct recept_bench_signal {
+	double sample_rate;
+	double amplitude;
+	size_t sample;
+	double chord_phase[2]; /* cycles */
+	double sweep_phase;
+	double sweep_period;   /* samples */
+	double fade;
+};
+
+void recept_bench_signal_init(struct recept_bench_signal *signal_ptr, double sample_rate, double amplitude);
+/* the next `n` samples */
+void recept_bench_signal_generate(struct recept_bench_signal *signal_ptr, double *samples, size_t n);
+
+enum recept_bench_engine {
+	RECEPT_BENCH_ARRAY,     /* `period_array_sample_block()`, the scalar reference */
+	RECEPT_BENCH_BANK,      /* a `struct period_bank` on the pool */
+	RECEPT_BENCH_MULTIRATE, /* a `struct period_octave_array` of banks on the pool, without monochords */
+	RECEPT_BENCH_ENGINE_COUNT
+};
+
+/* one run, of the sensors of `recept_test`'s config */
+struct recept_bench_config {
+	int engine;
+	const char *bank_kernel; /* NULL for the fastest double kernel */
+	int field_count;
+	int octave_bandwidth;
+	unsigned int monochord_count; /* per sensor, from the sensors a harmonic above it */
+	size_t block_size;            /* samples per call */
+};
+
+struct recept_bench_result {
+	const char  *kernel;         /* of the bank, or of the lowest octave holding sensors, or "array" */
+	unsigned int sensor_count;
+	unsigned int monochord_count; /* in all, as some sensors have fewer harmonics in range */
+	double seconds;              /* of the fastest run */
+	double samples_per_sec;
+	double ns_per_sensor_sample;
+	double realtime_factor;      /* samples per second over the sample rate */
+};
+
+struct recept_bench {
+	double sample_rate;
+	double *signal;
+	size_t  signal_frames;
+	unsigned int repeats;
+	struct period_bank_pool pool;
+};
+
+struct period_array;
+struct period_octave_array;
+
+/* the sensors of the configuration, with `monochord_count` monochords on each sensor from its harmonics 2, 3, ... in range */
+struct period_array *recept_bench_array_create(double sample_rate, const struct recept_bench_config *config_ptr);
+/* as `recept_bench_array_create()`, without monochords, in octaves of banks of the configuration's kernel */
+int recept_bench_octave_array_init(struct period_octave_array *poa_ptr, double sample_rate, const struct recept_bench_config *config_ptr);
+
+const char *recept_bench_engine_name(unsigned int engine);
+/* the engine named `name`, as by `recept_bench_engine_name()`, or -1 */
+int recept_bench_engine_parse(const char *name);
+
+/* generate `seconds` of the signal, and start a pool of `thread_count` threads, 0 for one per online CPU */
+int  recept_bench_init(struct recept_bench *bench_ptr, double sample_rate, double seconds, unsigned int repeats, unsigned int thread_count);
+void recept_bench_deinit(struct recept_bench *bench_ptr);
+/* set up the configuration's sensors, time them, and tear them down; -1 with ENOTSUP for monochords in multirate */
+int  recept_bench_run(struct recept_bench *bench_ptr, const struct recept_bench_config *config_ptr, struct recept_bench_result *result_ptr);
+
+#endif
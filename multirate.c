@@ -0,0 +1,491 @@
+#include "multirate.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "recept.h"
+#include "bank.h"
+#include "bank_pool.h"
+#include "profile.h"
+
+/* struct half_band_d */
+
+#define HALF_BAND_KAISER_BETA 8.0
+
+/* modified Bessel function of the first kind, order 0, for the Kaiser window */
+static double half_band_bessel_i0(double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	int k;
+
+	for (k = 1; term > 1e-20 * sum; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+
+	return sum;
+}
+
+void half_band_d_init(struct half_band_d *hb_d_ptr) {
+	double sum;
+	double x;
+	int n;
+	int k;
+
+	/* every other tap of a half-band filter is zero, and the center is 1/2 */
+	sum = 0.0;
+	for (k = 0; k < HALF_BAND_SIDE; k++) {
+		n = 2 * k + 1;
+		x = (double) n / HALF_BAND_DELAY;
+		hb_d_ptr->coefficients[k]  = sin(M_PI * n / 2.0) / (M_PI * n);
+		hb_d_ptr->coefficients[k] *= half_band_bessel_i0(HALF_BAND_KAISER_BETA * sqrt(1.0 - x * x)) / half_band_bessel_i0(HALF_BAND_KAISER_BETA);
+		sum += hb_d_ptr->coefficients[k];
+	}
+	/* unity gain at DC */
+	for (k = 0; k < HALF_BAND_SIDE; k++) {
+		hb_d_ptr->coefficients[k] *= 0.25 / sum;
+	}
+
+	memset(hb_d_ptr->history, 0, sizeof (hb_d_ptr->history));
+	hb_d_ptr->position = 0;
+	hb_d_ptr->phase = 0;
+}
+
+int half_band_d_sample(struct half_band_d *hb_d_ptr, double value, double *decimated_ptr) {
+	const double *x;
+	double y;
+	int k;
+
+	hb_d_ptr->history[hb_d_ptr->position] = value;
+	hb_d_ptr->history[hb_d_ptr->position + HALF_BAND_TAPS] = value;
+	hb_d_ptr->position = (hb_d_ptr->position + 1) % HALF_BAND_TAPS;
+
+	if (++hb_d_ptr->phase < 2) {
+		return 0;
+	}
+	hb_d_ptr->phase = 0;
+
+	/* oldest to newest */
+	x = &hb_d_ptr->history[hb_d_ptr->position];
+	y = 0.5 * x[HALF_BAND_DELAY];
+	for (k = 0; k < HALF_BAND_SIDE; k++) {
+		y += hb_d_ptr->coefficients[k] * (x[HALF_BAND_DELAY - 1 - 2 * k] + x[HALF_BAND_DELAY + 1 + 2 * k]);
+	}
+	*decimated_ptr = y;
+
+	return 1;
+}
+
+size_t half_band_d_sample_block(struct half_band_d *hb_d_ptr, const double *samples, size_t n, double *decimated) {
+	size_t count = 0;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		count += half_band_d_sample(hb_d_ptr, samples[i], &decimated[count]);
+	}
+
+	return count;
+}
+
+/* struct period_octave_array */
+
+struct receptive_field *period_octave_array_get_receptive_field(struct period_octave_array *poa_ptr) {
+	return &poa_ptr->field;
+}
+
+int period_octave_array_init(struct period_octave_array *poa_ptr, double response_period, double octave_bandwidth, double scale_factor, double min_period, unsigned int octave_capacity, int flags) {
+	unsigned int o;
+
+	poa_ptr->response_period  = response_period;
+	poa_ptr->octave_bandwidth = octave_bandwidth;
+	poa_ptr->scale_factor     = scale_factor;
+	poa_ptr->min_period       = min_period;
+	poa_ptr->octave_capacity  = octave_capacity;
+	poa_ptr->octave_flags     = flags;
+	poa_ptr->response_stride  = 1;
+	poa_ptr->pool_ptr         = NULL;
+	poa_ptr->octave_shed      = 0;
+	poa_ptr->octave_count     = 0;
+
+	for (o = 0; o < PERIOD_OCTAVE_MAX; o++) {
+		poa_ptr->octaves[o].pa_ptr     = NULL;
+		poa_ptr->octaves[o].bank_ptr   = NULL;
+		poa_ptr->octaves[o].decimation = 1u << o;
+		half_band_d_init(&poa_ptr->octaves[o].filter);
+		poa_ptr->octaves[o].delay          = NULL;
+		poa_ptr->octaves[o].delay_length   = 0;
+		poa_ptr->octaves[o].delay_position = 0;
+	}
+
+	return 0;
+}
+
+void period_octave_array_deinit(struct period_octave_array *poa_ptr) {
+	unsigned int o;
+
+	for (o = 0; o < PERIOD_OCTAVE_MAX; o++) {
+		if (poa_ptr->octaves[o].bank_ptr != NULL) {
+			period_bank_deinit(poa_ptr->octaves[o].bank_ptr);
+			free(poa_ptr->octaves[o].bank_ptr);
+			poa_ptr->octaves[o].bank_ptr = NULL;
+		}
+		period_array_destroy(poa_ptr->octaves[o].pa_ptr);
+		poa_ptr->octaves[o].pa_ptr = NULL;
+		free(poa_ptr->octaves[o].delay);
+		poa_ptr->octaves[o].delay = NULL;
+		poa_ptr->octaves[o].delay_length = 0;
+	}
+	poa_ptr->octave_count = 0;
+}
+
+/* the decimation of the slowest octave */
+static unsigned int period_octave_array_slowest(struct period_octave_array *poa_ptr) {
+	return poa_ptr->octave_count > 0 ? poa_ptr->octaves[poa_ptr->octave_count - 1].decimation : 1;
+}
+
+unsigned int period_octave_array_response_stride(struct period_octave_array *poa_ptr) {
+	unsigned int slowest = period_octave_array_slowest(poa_ptr);
+	unsigned int stride;
+
+	stride = (poa_ptr->response_stride + slowest / 2) / slowest * slowest;
+
+	return stride < slowest ? slowest : stride;
+}
+
+unsigned int period_octave_array_latency(struct period_octave_array *poa_ptr) {
+	return HALF_BAND_DELAY * (period_octave_array_slowest(poa_ptr) - 1);
+}
+
+/* a whole number of octave `o` samples, so that its responses fall on those of every other octave */
+static unsigned int period_octave_array_octave_stride(struct period_octave_array *poa_ptr, unsigned int o) {
+	return period_octave_array_response_stride(poa_ptr) >> o;
+}
+
+/* size each octave's delay to the rest of the slowest octave's, in its own samples */
+static int period_octave_array_delays_init(struct period_octave_array *poa_ptr) {
+	struct period_octave *octave_ptr;
+	unsigned int length;
+	unsigned int o;
+
+	for (o = 0; o < poa_ptr->octave_count; o++) {
+		octave_ptr = &poa_ptr->octaves[o];
+		length = HALF_BAND_DELAY * (period_octave_array_slowest(poa_ptr) / octave_ptr->decimation - 1);
+		if (length == octave_ptr->delay_length) {
+			continue;
+		}
+		free(octave_ptr->delay);
+		octave_ptr->delay = NULL;
+		octave_ptr->delay_length = 0;
+		octave_ptr->delay_position = 0;
+		if (length > 0) {
+			octave_ptr->delay = calloc(length, sizeof (*octave_ptr->delay));
+			if (octave_ptr->delay == NULL) {
+				return -1;
+			}
+			octave_ptr->delay_length = length;
+		}
+	}
+
+	return 0;
+}
+
+/* hold `n` samples back by the octave's delay, into `delayed`; returns the samples to take, `samples` itself without a delay */
+static const double *period_octave_delay(struct period_octave *octave_ptr, const double *samples, size_t n, double *delayed) {
+	size_t i;
+
+	if (octave_ptr->delay_length == 0) {
+		return samples;
+	}
+	for (i = 0; i < n; i++) {
+		delayed[i] = octave_ptr->delay[octave_ptr->delay_position];
+		octave_ptr->delay[octave_ptr->delay_position] = samples[i];
+		if (++octave_ptr->delay_position == octave_ptr->delay_length) {
+			octave_ptr->delay_position = 0;
+		}
+	}
+
+	return delayed;
+}
+
+/* the period array of octave `o`, in the octave's samples */
+static struct period_array *period_octave_array_octave_init(struct period_octave_array *poa_ptr, unsigned int o) {
+	struct period_octave *octave_ptr = &poa_ptr->octaves[o];
+	struct receptive_field *field_ptr;
+
+	if (octave_ptr->pa_ptr != NULL) {
+		return octave_ptr->pa_ptr;
+	}
+
+	octave_ptr->pa_ptr = period_array_create(poa_ptr->octave_capacity, 0, poa_ptr->octave_flags);
+	if (octave_ptr->pa_ptr == NULL) {
+		return NULL;
+	}
+
+	field_ptr = period_array_get_receptive_field(octave_ptr->pa_ptr);
+	*field_ptr = poa_ptr->field;
+	field_ptr->period /= octave_ptr->decimation;
+	field_ptr->phase  /= octave_ptr->decimation;
+	period_array_init(octave_ptr->pa_ptr, poa_ptr->response_period / octave_ptr->decimation, poa_ptr->octave_bandwidth, poa_ptr->scale_factor);
+	period_array_set_response_stride(octave_ptr->pa_ptr, period_octave_array_octave_stride(poa_ptr, o));
+
+	return octave_ptr->pa_ptr;
+}
+
+/*
+ * The highest frequency, in cycles per input sample, at which a sensor of `period` still responds with PERIOD_OCTAVE_SKIRT
+ * of its peak: the skirt of its widest scale, a one-pole resonator over a window of `period * period_factor` samples,
+ * whose response falls off as 1 / sqrt(1 + (2 pi window df)^2) at `df` from its frequency.
+ */
+static double period_octave_array_skirt(struct period_octave_array *poa_ptr, double period, double bandwidth_factor) {
+	double window;
+
+	window = period * bandwidth_factor / (pow(2.0, 1.0 / poa_ptr->octave_bandwidth) - 1) * pow(poa_ptr->scale_factor, -3.0);
+
+	return 1.0 / period + sqrt(1.0 / (PERIOD_OCTAVE_SKIRT * PERIOD_OCTAVE_SKIRT) - 1) / (2 * M_PI * window);
+}
+
+int period_octave_array_add_period_sensor(struct period_octave_array *poa_ptr, double period, double bandwidth_factor) {
+	struct period_array *pa_ptr;
+	double skirt;
+	unsigned int o;
+
+	/* the lowest rate that leaves `min_period` samples per period, and passes the sensor's skirt in the filters' flat band */
+	skirt = period_octave_array_skirt(poa_ptr, period, bandwidth_factor);
+	for (o = 0; o + 1 < PERIOD_OCTAVE_MAX && period / poa_ptr->octaves[o + 1].decimation >= poa_ptr->min_period && skirt * poa_ptr->octaves[o + 1].decimation <= HALF_BAND_PASSBAND * 2; o++) {
+	}
+
+	pa_ptr = period_octave_array_octave_init(poa_ptr, o);
+	if (pa_ptr == NULL) {
+		return -1;
+	}
+	if (period_array_add_period_sensor(pa_ptr, period / poa_ptr->octaves[o].decimation, bandwidth_factor) == -1) {
+		errno = ENOSPC;
+		return -1;
+	}
+	if (o + 1 > poa_ptr->octave_count) {
+		/* a slower octave: the others are held back, and respond, to it */
+		poa_ptr->octave_count = o + 1;
+		if (period_octave_array_delays_init(poa_ptr) == -1) {
+			return -1;
+		}
+		period_octave_array_set_response_stride(poa_ptr, poa_ptr->response_stride);
+	}
+
+	return o;
+}
+
+int period_octave_array_populate(struct period_octave_array *poa_ptr, double octaves, double bandwidth_factor) {
+	int rc;
+	int n;
+
+	for (n = - poa_ptr->octave_bandwidth * octaves; n <= 0; n++) {
+		rc = period_octave_array_add_period_sensor(poa_ptr, poa_ptr->field.period * pow(2, n / poa_ptr->octave_bandwidth), bandwidth_factor);
+		if (rc == -1) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+void period_octave_array_set_response_stride(struct period_octave_array *poa_ptr, unsigned int response_stride) {
+	unsigned int o;
+
+	poa_ptr->response_stride = response_stride;
+	for (o = 0; o < PERIOD_OCTAVE_MAX; o++) {
+		if (poa_ptr->octaves[o].bank_ptr != NULL) {
+			period_bank_set_response_stride(poa_ptr->octaves[o].bank_ptr, period_octave_array_octave_stride(poa_ptr, o));
+		} else if (poa_ptr->octaves[o].pa_ptr != NULL) {
+			period_array_set_response_stride(poa_ptr->octaves[o].pa_ptr, period_octave_array_octave_stride(poa_ptr, o));
+		}
+	}
+}
+
+/*
+ * Take octaves [octave_begin, octave_end) up again, in step with octave `octave_end`, which kept sampling: an octave's response
+ * phase counts its samples since the common response, the sampling octave's in its own samples, each of which stood for two of
+ * the octave below, plus the inputs pending in the filters between them.
+ */
+static void period_octave_array_resume_octaves(struct period_octave_array *poa_ptr, unsigned int octave_begin, unsigned int octave_end) {
+	struct period_octave *octave_ptr;
+	struct period_scale_space_sensor *sss_ptr;
+	unsigned int response_stride;
+	unsigned int next_response_stride;
+	unsigned int response_phase;
+	unsigned int stride;
+	unsigned int next_stride;
+	unsigned int phase;
+	unsigned int k;
+	unsigned int o;
+
+	octave_ptr = &poa_ptr->octaves[octave_end];
+	if (octave_ptr->bank_ptr != NULL) {
+		response_stride      = octave_ptr->bank_ptr->response_stride;
+		next_response_stride = octave_ptr->bank_ptr->next_response_stride;
+		response_phase       = octave_ptr->bank_ptr->response_phase;
+	} else {
+		sss_ptr = &period_array_get_entries(octave_ptr->pa_ptr)[0].sensor;
+		response_stride      = sss_ptr->response_stride;
+		next_response_stride = sss_ptr->next_response_stride;
+		response_phase       = sss_ptr->response_phase;
+	}
+	for (o = octave_begin; o < octave_end; o++) {
+		octave_ptr = &poa_ptr->octaves[o];
+		if (octave_ptr->pa_ptr == NULL) {
+			continue;
+		}
+		/* on the sampling octave's strides, which may have changed at a response the held octave missed */
+		stride      = response_stride << (octave_end - o);
+		next_stride = next_response_stride << (octave_end - o);
+		phase = response_phase << (octave_end - o);
+		for (k = o + 1; k <= octave_end; k++) {
+			phase += poa_ptr->octaves[k].filter.phase << (k - 1 - o);
+		}
+		phase %= stride;
+		if (octave_ptr->bank_ptr != NULL) {
+			period_bank_resume(octave_ptr->bank_ptr, stride, next_stride, phase);
+		} else {
+			period_array_resume_sensors(octave_ptr->pa_ptr, 0, period_array_period_sensor_count(octave_ptr->pa_ptr), stride, next_stride, phase);
+		}
+	}
+}
+
+unsigned int period_octave_array_shed_octaves(struct period_octave_array *poa_ptr, unsigned int count) {
+	unsigned int shed;
+	unsigned int o;
+
+	shed = 0;
+	for (o = 0; o < poa_ptr->octave_count; o++) {
+		if (poa_ptr->octaves[o].pa_ptr == NULL) {
+			continue;
+		}
+		if (shed == count) {
+			break;
+		}
+		shed++;
+	}
+	if (o == poa_ptr->octave_count && shed > 0) {
+		/* leave the last octave sampling */
+		shed--;
+		do {
+			o--;
+		} while (poa_ptr->octaves[o].pa_ptr == NULL);
+	}
+	if (o < poa_ptr->octave_shed) {
+		period_octave_array_resume_octaves(poa_ptr, o, poa_ptr->octave_shed);
+	}
+	poa_ptr->octave_shed = o;
+
+	return shed;
+}
+
+int period_octave_array_init_banks(struct period_octave_array *poa_ptr, const char *kernel_name) {
+	struct period_octave *octave_ptr;
+	unsigned int o;
+
+	for (o = 0; o < poa_ptr->octave_count; o++) {
+		octave_ptr = &poa_ptr->octaves[o];
+		if (octave_ptr->pa_ptr == NULL || octave_ptr->bank_ptr != NULL) {
+			continue;
+		}
+
+		octave_ptr->bank_ptr = malloc(sizeof (*octave_ptr->bank_ptr));
+		if (octave_ptr->bank_ptr == NULL) {
+			return -1;
+		}
+		if (period_bank_init(octave_ptr->bank_ptr, octave_ptr->pa_ptr) == -1) {
+			free(octave_ptr->bank_ptr);
+			octave_ptr->bank_ptr = NULL;
+			return -1;
+		}
+		if (period_bank_set_kernel(octave_ptr->bank_ptr, kernel_name) == -1) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+void period_octave_array_set_pool(struct period_octave_array *poa_ptr, struct period_bank_pool *pool_ptr) {
+	poa_ptr->pool_ptr = pool_ptr;
+}
+
+void period_octave_array_store(struct period_octave_array *poa_ptr) {
+	unsigned int o;
+
+	for (o = 0; o < poa_ptr->octave_count; o++) {
+		if (poa_ptr->octaves[o].bank_ptr != NULL) {
+			period_bank_store(poa_ptr->octaves[o].bank_ptr);
+		}
+	}
+}
+
+unsigned int period_octave_array_octave_count(struct period_octave_array *poa_ptr) {
+	return poa_ptr->octave_count;
+}
+
+struct period_array *period_octave_array_get_octave(struct period_octave_array *poa_ptr, unsigned int octave, unsigned int *decimation_ptr) {
+	if (decimation_ptr != NULL) {
+		*decimation_ptr = poa_ptr->octaves[octave].decimation;
+	}
+	return poa_ptr->octaves[octave].pa_ptr;
+}
+
+/*
+ * Each chunk goes down the ladder: octave `o` samples the chunk decimated `o` times, starting at the time of its first output.
+ * The filters delay octave `o` by HALF_BAND_DELAY * (2^o - 1) input samples, and its own delay by the rest of the latency,
+ * so each octave is timed by the input it holds: the time of its output, less the latency.
+ */
+void period_octave_array_sample_block(struct period_octave_array *poa_ptr, double time, const double *samples, size_t n) {
+	double buffers[2][PERIOD_OCTAVE_CHUNK / 2];
+	double delayed[PERIOD_OCTAVE_CHUNK];
+	struct period_octave *octave_ptr;
+	const double *in;
+	const double *out;
+	size_t in_n;
+	double in_time;
+	double latency;
+	unsigned int phase;
+	unsigned int o;
+	size_t j;
+	size_t m;
+
+	latency = period_octave_array_latency(poa_ptr);
+	for (j = 0; j < n; j += m) {
+		m = n - j < PERIOD_OCTAVE_CHUNK ? n - j : PERIOD_OCTAVE_CHUNK;
+		in = &samples[j];
+		in_n = m;
+		in_time = time + j;
+
+		for (o = 0; o < poa_ptr->octave_count; o++) {
+			octave_ptr = &poa_ptr->octaves[o];
+
+			if (o > 0) {
+				/* the first output is on the input that completes a pair */
+				phase = octave_ptr->filter.phase;
+				RECEPT_PROFILE_BEGIN(decimate_begin);
+				in_n = half_band_d_sample_block(&octave_ptr->filter, in, in_n, buffers[o & 1]);
+				RECEPT_PROFILE_END(decimate_begin, RECEPT_PROFILE_DECIMATE);
+				in = buffers[o & 1];
+				in_time = (in_time + 1 - phase) / 2;
+			}
+			if (in_n == 0) {
+				break;
+			}
+			/* held back even while shed, so that it lags alike once taken up again */
+			out = period_octave_delay(octave_ptr, in, in_n, delayed);
+
+			if (o < poa_ptr->octave_shed) {
+				continue;
+			} else if (octave_ptr->bank_ptr != NULL && poa_ptr->pool_ptr != NULL) {
+				period_bank_pool_sample_block(poa_ptr->pool_ptr, octave_ptr->bank_ptr, in_time - latency / octave_ptr->decimation, out, in_n);
+			} else if (octave_ptr->bank_ptr != NULL) {
+				period_bank_sample_block(octave_ptr->bank_ptr, in_time - latency / octave_ptr->decimation, out, in_n);
+			} else if (octave_ptr->pa_ptr != NULL) {
+				period_array_sample_block(octave_ptr->pa_ptr, in_time - latency / octave_ptr->decimation, out, in_n);
+			}
+		}
+	}
+}
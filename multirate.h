@@ -0,0 +1,114 @@
+#ifndef MULTIRATE_H
+#define MULTIRATE_H
+
+#include <stddef.h>
+
+#include "receptlib.h"
+
+/*
+ * Multirate Octave Array
+ *
+ * Runs each octave of period sensors at the lowest sample rate it allows, like `OctaveSamplers` in recept.py:
+ * octave `o` samples at 1 / 2^o of the input rate, fed by a ladder of half-band decimators.
+ *
+ * A sensor goes to the highest octave that leaves it at least `min_period` samples per period, and whose filters pass, in
+ * their flat band, all of the sensor's response above PERIOD_OCTAVE_SKIRT of its peak: the full-rate sensors are one-pole
+ * resonators, whose skirts reach far above their period, and an octave that takes a sensor's skirt out takes out what the
+ * full-rate sensor still responds to, and sees less of any tone above it. There it is a plain `period_scale_space_sensor`
+ * of that octave's `struct period_array`, with its period, phase and response period divided by 2^o and its times counted
+ * in the octave's samples (input time / 2^o). Sensors of `recept_test`'s bandwidths leave the input rate only below some
+ * 15 Hz at 44.1kHz with 12 sensors per octave, 30 Hz with 24: the ladder pays off for narrower sensors.
+ *
+ * The filters delay octave `o` by HALF_BAND_DELAY * (2^o - 1) input samples. Each octave is held back the rest of the
+ * slowest octave's delay, and timed by the input it holds, so that every octave lags the input alike, by
+ * `period_octave_array_latency()`, and the sensors on either side of an octave boundary see the same moment.
+ * Every octave responds on the same input samples, every `period_octave_array_response_stride()`.
+ * Against the full-rate array so delayed, the octaves agree to about the filters' flatness, as measured by accuracy.h.
+ */
+
+/* half-band FIR: Kaiser-windowed sinc, flat to 1e-4 below 1/8 of its input rate and -80dB above 3/8 */
+#define HALF_BAND_TAPS 23
+#define HALF_BAND_SIDE ((HALF_BAND_TAPS + 1) / 4) /* nonzero taps on either side of the center */
+#define HALF_BAND_DELAY ((HALF_BAND_TAPS - 1) / 2) /* in input samples */
+#define HALF_BAND_PASSBAND 0.125 /* of its input rate, where it is flat */
+
+#define PERIOD_OCTAVE_MAX 12
+#define PERIOD_OCTAVE_MIN_PERIOD 8.0
+/* the fraction of its peak a sensor's response falls to, above its period, before an octave's filters may take the rest: their flatness */
+#define PERIOD_OCTAVE_SKIRT 1e-4
+/* input samples per pass down the ladder */
+#define PERIOD_OCTAVE_CHUNK 1024
+
+/* halves the sample rate: filters, and keeps every second sample */
+struct half_band_d {
+	double coefficients[HALF_BAND_SIDE];
+	double history[HALF_BAND_TAPS * 2]; /* doubled, so that the newest HALF_BAND_TAPS are contiguous */
+	unsigned int position;
+	unsigned int phase; /* inputs pending for the next output */
+};
+void half_band_d_init(struct half_band_d *hb_d_ptr);
+/* returns 1 with the decimated value on every second sample, 0 otherwise */
+int half_band_d_sample(struct half_band_d *hb_d_ptr, double value, double *decimated_ptr);
+/* decimate `n` samples into `decimated`, returning how many, at most (n + 1) / 2 */
+size_t half_band_d_sample_block(struct half_band_d *hb_d_ptr, const double *samples, size_t n, double *decimated);
+
+struct period_bank;
+struct period_bank_pool;
+
+struct period_octave_array {
+	struct receptive_field field; /* at the input rate */
+	double response_period;       /* at the input rate */
+	double octave_bandwidth;
+	double scale_factor;
+	double min_period;
+	unsigned int octave_capacity; /* sensors per octave, see `period_array_create()` */
+	int octave_flags;
+	unsigned int response_stride; /* at the input rate */
+	struct period_bank_pool *pool_ptr; /* samples the banks, or NULL */
+	unsigned int octave_shed;      /* octaves below this one are held still, see `period_octave_array_shed_octaves()` */
+
+	unsigned int octave_count; /* octaves in use, up to the highest holding sensors */
+	struct period_octave {
+		struct period_array *pa_ptr;
+		struct period_bank  *bank_ptr;    /* NULL samples `pa_ptr` directly */
+		unsigned int decimation;          /* 2^octave */
+		struct half_band_d filter;        /* from the octave below, unused in octave 0 */
+		double *delay;                    /* the octave's samples held back, to the slowest octave's delay */
+		unsigned int delay_length;
+		unsigned int delay_position;
+	} octaves[PERIOD_OCTAVE_MAX];
+};
+
+struct receptive_field *period_octave_array_get_receptive_field(struct period_octave_array *poa_ptr);
+/* each octave's array holds up to `octave_capacity` sensors, created with `flags`, see `period_array_create()` */
+int  period_octave_array_init(struct period_octave_array *poa_ptr, double response_period, double octave_bandwidth, double scale_factor, double min_period, unsigned int octave_capacity, int flags);
+void period_octave_array_deinit(struct period_octave_array *poa_ptr);
+/* add a sensor of `period` input samples to its octave, returning that octave, or -1 when it is full */
+int  period_octave_array_add_period_sensor(struct period_octave_array *poa_ptr, double period, double bandwidth_factor);
+int  period_octave_array_populate(struct period_octave_array *poa_ptr, double octaves, double bandwidth_factor);
+/* the response stride in input samples, divided down per octave, see `period_array_set_response_stride()`; of the banks too, once made */
+void period_octave_array_set_response_stride(struct period_octave_array *poa_ptr, unsigned int response_stride);
+/* the response stride the octaves take: rounded to a whole number of the slowest octave's samples, at least one */
+unsigned int period_octave_array_response_stride(struct period_octave_array *poa_ptr);
+/* the input samples every octave lags the input by: the slowest octave's half-band delay */
+unsigned int period_octave_array_latency(struct period_octave_array *poa_ptr);
+/*
+ * Load shedding, as `period_array_shed_sensors()`: hold the sensors of the first `count` octaves holding any still, the highest
+ * and costliest, as the ladder goes on decimating through them; 0 takes them all up again, their responses falling on those of
+ * the octaves that kept sampling. One octave is always left sampling. Returns the octaves held.
+ */
+unsigned int period_octave_array_shed_octaves(struct period_octave_array *poa_ptr, unsigned int count);
+/* run each octave in a `struct period_bank` with the kernel `kernel_name`, see `period_bank_set_kernel()`; after populating */
+int  period_octave_array_init_banks(struct period_octave_array *poa_ptr, const char *kernel_name);
+/* sample the banks' sensor blocks on `pool_ptr`, see bank_pool.h, or on the calling thread when NULL */
+void period_octave_array_set_pool(struct period_octave_array *poa_ptr, struct period_bank_pool *pool_ptr);
+/* store the banks back into the octaves' period arrays */
+void period_octave_array_store(struct period_octave_array *poa_ptr);
+
+unsigned int period_octave_array_octave_count(struct period_octave_array *poa_ptr);
+struct period_array *period_octave_array_get_octave(struct period_octave_array *poa_ptr, unsigned int octave, unsigned int *decimation_ptr);
+
+/* sample a block of `n` samples, where `samples[i]` is at `time + i` */
+void period_octave_array_sample_block(struct period_octave_array *poa_ptr, double time, const double *samples, size_t n);
+
+#endif
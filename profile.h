@@ -0,0 +1,158 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Stage Profile and Realtime Sync
+ *
+ * `struct recept_profile` follows how far the wall clock has run ahead of the sample clock (the lag: for live input,
+ * how far behind the sensors are), and how fast that is changing (the leak, smoothed over a second of frames):
+ * a leak that stays off zero is falling behind, or for a file, running ahead of realtime.
+ *
+ * Built with RECEPT_PROFILE, the stages of the sensors also count their time, read from the TSC on x86 and from the
+ * monotonic clock elsewhere, between RECEPT_PROFILE_BEGIN() and RECEPT_PROFILE_END(), and each frame reports each
+ * stage's share of the wall time since the frame before. Stages on the bank pool's threads add up over the threads.
+ * A stage nested in another is taken out of the outer one by RECEPT_PROFILE_END_WITHIN(), so that shares do not
+ * overlap. Stages timed per sensor and sample count into the thread's own counters with the _LOCAL variants, which
+ * RECEPT_PROFILE_FLUSH() adds to the shared ones once a block, and each frame before it reads them, rather than taking an
+ * atomic add each. Without RECEPT_PROFILE, the macros are empty, and the stages cost nothing.
+ */
+
+/* a leak under this many seconds per frame keeps up */
+#define RECEPT_PROFILE_SYNC 0.0001
+
+enum recept_profile_stage {
+	RECEPT_PROFILE_READ,       /* reading and decoding input, including waiting for it */
+	RECEPT_PROFILE_DECIMATE,   /* the multirate half-band filters */
+	RECEPT_PROFILE_SENSOR,     /* resonating and perceiving */
+	RECEPT_PROFILE_MONOCHORDS, /* superimposing monochords */
+	RECEPT_PROFILE_LIFECYCLE,
+	RECEPT_PROFILE_DRAW,       /* storing the sensors for display, and drawing */
+	RECEPT_PROFILE_STAGE_COUNT
+};
+
+#ifdef RECEPT_PROFILE
+#include <stdatomic.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define recept_profile_now() ((uint64_t) __rdtsc())
+#else
+#include <time.h>
+static inline uint64_t recept_profile_now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
+
+extern _Atomic uint64_t recept_profile_ticks[RECEPT_PROFILE_STAGE_COUNT];
+
+#define RECEPT_PROFILE_BEGIN(begin) uint64_t begin = recept_profile_now()
+#define RECEPT_PROFILE_END(begin, stage) \
+	atomic_fetch_add_explicit(&recept_profile_ticks[stage], recept_profile_now() - (begin), memory_order_relaxed)
+#define RECEPT_PROFILE_END_WITHIN(begin, stage, outer) do { \
+	uint64_t recept_profile_elapsed = recept_profile_now() - (begin); \
+	atomic_fetch_add_explicit(&recept_profile_ticks[stage], recept_profile_elapsed, memory_order_relaxed); \
+	atomic_fetch_sub_explicit(&recept_profile_ticks[outer], recept_profile_elapsed, memory_order_relaxed); \
+} while (0)
+
+extern _Thread_local uint64_t recept_profile_local_ticks[RECEPT_PROFILE_STAGE_COUNT];
+
+#define RECEPT_PROFILE_END_LOCAL(begin, stage) (recept_profile_local_ticks[stage] += recept_profile_now() - (begin))
+#define RECEPT_PROFILE_END_WITHIN_LOCAL(begin, stage, outer) do { \
+	uint64_t recept_profile_elapsed = recept_profile_now() - (begin); \
+	recept_profile_local_ticks[stage] += recept_profile_elapsed; \
+	recept_profile_local_ticks[outer] -= recept_profile_elapsed; \
+} while (0)
+#define RECEPT_PROFILE_FLUSH() recept_profile_flush()
+
+/* add the thread's own counters to the shared ones */
+void recept_profile_flush(void);
+#else
+#define RECEPT_PROFILE_BEGIN(begin)
+#define RECEPT_PROFILE_END(begin, stage)
+#define RECEPT_PROFILE_END_WITHIN(begin, stage, outer)
+#define RECEPT_PROFILE_END_LOCAL(begin, stage)
+#define RECEPT_PROFILE_END_WITHIN_LOCAL(begin, stage, outer)
+#define RECEPT_PROFILE_FLUSH()
+#endif
+
+struct recept_profile {
+	double frame_rate;
+	double start_time; /* seconds of the monotonic clock at the first sample, as of the first frame */
+	double frame_time; /* since the start, at the last frame */
+	int    frame_count;
+	double lag;        /* seconds the wall clock is ahead of the sample clock */
+	double leak;       /* smoothed change in lag per frame */
+#ifdef RECEPT_PROFILE
+	uint64_t start_ticks;
+	double   start_ticks_time; /* since the start */
+	uint64_t stage_ticks[RECEPT_PROFILE_STAGE_COUNT]; /* at the last frame */
+	double   share[RECEPT_PROFILE_STAGE_COUNT];       /* of the wall time over the last frame */
+	double   other;                                  /* the rest of the frame, not in any stage */
+#endif
+};
+
+void recept_profile_init(struct recept_profile *profile_ptr, double frame_rate);
+/* take a frame at `sample_time` seconds of input */
+void recept_profile_frame(struct recept_profile *profile_ptr, double sample_time);
+/* whether the leak keeps up, see RECEPT_PROFILE_SYNC */
+int  recept_profile_in_sync(struct recept_profile *profile_ptr);
+const char *recept_profile_stage_name(unsigned int stage);
+
+/*
+ * Load Shedding
+ *
+ * `struct recept_shed` steps the load down while the sensors fall behind the input, once the lag is RECEPT_SHED_BEHIND
+ * over the lowest it has been and not coming down, and back up once they have kept up for RECEPT_SHED_RECOVER seconds,
+ * a step at most every RECEPT_SHED_HOLD seconds, for the last one to show in the lag. A step restored only to be shed
+ * again doubles the wait before the next restore, up to RECEPT_SHED_RECOVER_MAX, so that a load near the limit settles.
+ * Each step takes one more of the first action not at its limit, in order, and each step back restores the last:
+ *
+ *   frames:     draw one frame in 2, 4, ...
+ *   responses:  respond once in 2, 4, ... response strides, see `period_array_set_response_stride()`
+ *   monochords: sample without superimposing them
+ *   sensors:    hold an octave of sensors still, from the shortest periods down, see `period_array_shed_sensors()`
+ *
+ * The controller only keeps count; the caller applies the action each step returns to its sensors.
+ */
+
+/* seconds */
+#define RECEPT_SHED_BEHIND  0.25
+#define RECEPT_SHED_HOLD    2.0
+#define RECEPT_SHED_RECOVER 10.0
+#define RECEPT_SHED_RECOVER_MAX 160.0
+
+enum recept_shed_action {
+	RECEPT_SHED_FRAMES,
+	RECEPT_SHED_RESPONSES,
+	RECEPT_SHED_MONOCHORDS,
+	RECEPT_SHED_SENSORS,
+	RECEPT_SHED_ACTION_COUNT
+};
+
+struct recept_shed {
+	unsigned int limit[RECEPT_SHED_ACTION_COUNT]; /* the most steps of each action */
+	unsigned int steps[RECEPT_SHED_ACTION_COUNT]; /* taken */
+	double       lag_floor; /* the lowest lag yet */
+	double       step_time; /* the profile's frame time at the last step */
+	int          restored;  /* whether the last step was a restore */
+	double       recover;   /* seconds kept up before a restore */
+	unsigned int frame;
+};
+
+/* with no steps allowed, see `recept_shed_set_limit()` */
+void recept_shed_init(struct recept_shed *shed_ptr);
+void recept_shed_set_limit(struct recept_shed *shed_ptr, unsigned int action, unsigned int steps);
+/* after each `recept_profile_frame()`, take or restore a step, returning its action, or -1 for none */
+int  recept_shed_update(struct recept_shed *shed_ptr, struct recept_profile *profile_ptr);
+/* whether to draw the frame, counting it */
+int  recept_shed_draw(struct recept_shed *shed_ptr);
+/* what is shed, as "ui/4 r*2 mc -1oct", or "none" */
+void recept_shed_describe(struct recept_shed *shed_ptr, char *buf, size_t size);
+
+#endif
@@ -1,8 +1,20 @@
 #include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
 
 #include "recept.h"
 #include "bar.h"
 #include "tau.h"
+#include "profile.h"
 
 
 double complex delta_dc(double complex cval, double complex prior_cval) {
@@ -12,6 +24,13 @@ double complex delta_dc(double complex cval, double complex prior_cval) {
 		return 0.0;
 	}
 }
+float complex delta_fc(float complex cval, float complex prior_cval) {
+	if (prior_cval != 0.0f) {
+		return cval / prior_cval;
+	} else {
+		return 0.0f;
+	}
+}
 
 /* struct exponential_smoothing_d[c] */
 
@@ -22,6 +41,27 @@ double exponential_smoother_d_sample(struct exponential_smoother_d *es_d_ptr, do
 	es_d_ptr->v += (value - es_d_ptr->v) / factor;
 	return es_d_ptr->v;
 }
+/* `stride` samples of `factor` leave (1 - 1/factor)^stride of the prior value, so one sample of 1 / (1 - (1 - 1/factor)^stride) does the same */
+double exponential_smoother_d_stride_factor(double factor, unsigned int stride) {
+	double base;
+	double power;
+
+	if (stride <= 1) {
+		return factor;
+	}
+
+	base = 1.0 - 1.0 / factor;
+	power = 1.0;
+	while (stride > 0) {
+		if (stride & 1) {
+			power *= base;
+		}
+		base *= base;
+		stride >>= 1;
+	}
+
+	return 1.0 / (1.0 - power);
+}
 
 void exponential_smoother_dc_init(struct exponential_smoother_dc *es_dc_ptr, double complex initial_value) {
 	es_dc_ptr->v = initial_value;
@@ -31,6 +71,22 @@ double complex exponential_smoother_dc_sample(struct exponential_smoother_dc *es
 	return es_dc_ptr->v;
 }
 
+void exponential_smoother_f_init(struct exponential_smoother_f *es_f_ptr, float initial_value) {
+	es_f_ptr->v = initial_value;
+}
+float exponential_smoother_f_sample(struct exponential_smoother_f *es_f_ptr, float value, float factor) {
+	es_f_ptr->v += (value - es_f_ptr->v) / factor;
+	return es_f_ptr->v;
+}
+
+void exponential_smoother_fc_init(struct exponential_smoother_fc *es_fc_ptr, float complex initial_value) {
+	es_fc_ptr->v = initial_value;
+}
+float complex exponential_smoother_fc_sample(struct exponential_smoother_fc *es_fc_ptr, float complex value, float factor) {
+	es_fc_ptr->v += (value - es_fc_ptr->v) / factor;
+	return es_fc_ptr->v;
+}
+
 void exponential_smoothing_d_init(struct exponential_smoothing_d *esg_d_ptr, double window_size, double initial_value) {
 	esg_d_ptr->w = window_size;
 	exponential_smoother_d_init(&esg_d_ptr->v, initial_value);
@@ -47,6 +103,22 @@ double exponential_smoothing_dc_sample(struct exponential_smoothing_dc *esg_dc_p
 	return exponential_smoother_dc_sample(&esg_dc_ptr->v, value, esg_dc_ptr->w);
 }
 
+void exponential_smoothing_f_init(struct exponential_smoothing_f *esg_f_ptr, float window_size, float initial_value) {
+	esg_f_ptr->w = window_size;
+	exponential_smoother_f_init(&esg_f_ptr->v, initial_value);
+}
+float exponential_smoothing_f_sample(struct exponential_smoothing_f *esg_f_ptr, float value) {
+	return exponential_smoother_f_sample(&esg_f_ptr->v, value, esg_f_ptr->w);
+}
+
+void exponential_smoothing_fc_init(struct exponential_smoothing_fc *esg_fc_ptr, float window_size, float complex initial_value) {
+	esg_fc_ptr->w = window_size;
+	exponential_smoother_fc_init(&esg_fc_ptr->v, initial_value);
+}
+float complex exponential_smoothing_fc_sample(struct exponential_smoothing_fc *esg_fc_ptr, float complex value) {
+	return exponential_smoother_fc_sample(&esg_fc_ptr->v, value, esg_fc_ptr->w);
+}
+
 /* struct delta_d[c] */
 
 void delta_d_init(struct delta_d *d_d_ptr, int has_prior, double prior_sequence) {
@@ -81,6 +153,38 @@ int delta_dc_sample(struct delta_dc *d_dc_ptr, double complex sequence_value, do
 	return has_value;
 }
 
+void delta_f_init(struct delta_f *d_f_ptr, int has_prior, float prior_sequence) {
+	d_f_ptr->has_prior = has_prior;
+	d_f_ptr->prior_sequence = prior_sequence;
+}
+int delta_f_sample(struct delta_f *d_f_ptr, float sequence_value, float *delta_value_ptr) {
+	int has_value;
+	if (d_f_ptr->has_prior) {
+		has_value = 0;
+	} else {
+		has_value = 1;
+		*delta_value_ptr = sequence_value - d_f_ptr->prior_sequence;
+	}
+
+	return has_value;
+}
+
+void delta_fc_init(struct delta_fc *d_fc_ptr, int has_prior, float complex prior_sequence) {
+	d_fc_ptr->has_prior = has_prior;
+	d_fc_ptr->prior_sequence = prior_sequence;
+}
+int delta_fc_sample(struct delta_fc *d_fc_ptr, float complex sequence_value, float complex *delta_value_ptr) {
+	int has_value;
+	if (d_fc_ptr->has_prior) {
+		has_value = 0;
+	} else {
+		has_value = 1;
+		*delta_value_ptr = delta_fc(sequence_value, d_fc_ptr->prior_sequence);
+	}
+
+	return has_value;
+}
+
 /* struct distribution_d[c] */
 
 void distribution_d_init(struct distribution_d *dist_d_ptr, double initial_value) {
@@ -111,6 +215,34 @@ void distribution_dc_sample(struct distribution_dc *dist_dc_ptr, double complex
 	*dev_ptr = dist_dc_ptr->dev.v;
 }
 
+void distribution_f_init(struct distribution_f *dist_f_ptr, float initial_value) {
+	exponential_smoother_f_init(&dist_f_ptr->ave, initial_value);
+	exponential_smoother_f_init(&dist_f_ptr->dev, initial_value);
+}
+void distribution_f_sample(struct distribution_f *dist_f_ptr, float value, float factor, float *ave_ptr, float *dev_ptr) {
+	float deviation = fabsf(dist_f_ptr->ave.v - value);
+
+	exponential_smoother_f_sample(&dist_f_ptr->ave, value, factor);
+	exponential_smoother_f_sample(&dist_f_ptr->dev, deviation, factor);
+
+	*ave_ptr = dist_f_ptr->ave.v;
+	*dev_ptr = dist_f_ptr->dev.v;
+}
+
+void distribution_fc_init(struct distribution_fc *dist_fc_ptr, float complex initial_value) {
+	exponential_smoother_fc_init(&dist_fc_ptr->ave, initial_value);
+	exponential_smoother_fc_init(&dist_fc_ptr->dev, initial_value);
+}
+void distribution_fc_sample(struct distribution_fc *dist_fc_ptr, float complex value, float factor, float complex *ave_ptr, float complex *dev_ptr) {
+	float deviation = cabsf(delta_fc(dist_fc_ptr->ave.v, value));
+
+	exponential_smoother_fc_sample(&dist_fc_ptr->ave, value, factor);
+	exponential_smoother_fc_sample(&dist_fc_ptr->dev, deviation, factor);
+
+	*ave_ptr = dist_fc_ptr->ave.v;
+	*dev_ptr = dist_fc_ptr->dev.v;
+}
+
 /* struct weighted_distribution_d[c] */
 
 void weighted_distribution_d_init(struct weighted_distribution_d *wdist_d_ptr, double initial_value, double window_size) {
@@ -129,6 +261,22 @@ void weighted_distribution_dc_sample(struct weighted_distribution_dc *wdist_dc_p
 	distribution_dc_sample(&wdist_dc_ptr->dist, value, wdist_dc_ptr->w, ave_ptr, dev_ptr);
 }
 
+void weighted_distribution_f_init(struct weighted_distribution_f *wdist_f_ptr, float initial_value, float window_size) {
+	distribution_f_init(&wdist_f_ptr->dist, initial_value);
+	wdist_f_ptr->w = window_size;
+}
+void weighted_distribution_f_sample(struct weighted_distribution_f *wdist_f_ptr, float value, float *ave_ptr, float *dev_ptr) {
+	distribution_f_sample(&wdist_f_ptr->dist, value, wdist_f_ptr->w, ave_ptr, dev_ptr);
+}
+
+void weighted_distribution_fc_init(struct weighted_distribution_fc *wdist_fc_ptr, float complex initial_value, float window_size) {
+	distribution_fc_init(&wdist_fc_ptr->dist, initial_value);
+	wdist_fc_ptr->w = window_size;
+}
+void weighted_distribution_fc_sample(struct weighted_distribution_fc *wdist_fc_ptr, float complex value, float complex *ave_ptr, float complex *dev_ptr) {
+	distribution_fc_sample(&wdist_fc_ptr->dist, value, wdist_fc_ptr->w, ave_ptr, dev_ptr);
+}
+
 /* struct apex_d[c] */
 
 void apex_d_init(struct apex_d *ax_d_ptr, int has_prior, double prior_sequence) {
@@ -171,6 +319,46 @@ int apex_dc_sample(struct apex_dc *ax_dc_ptr, double complex sequence_value, dou
 	return 0;
 }
 
+void apex_f_init(struct apex_f *ax_f_ptr, int has_prior, float prior_sequence) {
+	delta_f_init(&ax_f_ptr->delta, has_prior, prior_sequence);
+	ax_f_ptr->prior_is_positive = 1;
+}
+int apex_f_sample(struct apex_f *ax_f_ptr, float sequence_value, float *delta_value_ptr) {
+	int has_value;
+	int is_positive;
+
+	has_value = delta_f_sample(&ax_f_ptr->delta, sequence_value, delta_value_ptr);
+	if (has_value) {
+		is_positive = *delta_value_ptr >= 0;
+		if (ax_f_ptr->prior_is_positive != is_positive) {
+			ax_f_ptr->prior_is_positive = is_positive;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+void apex_fc_init(struct apex_fc *ax_fc_ptr, int has_prior, float complex prior_sequence) {
+	delta_fc_init(&ax_fc_ptr->delta, has_prior, prior_sequence);
+	ax_fc_ptr->prior_is_positive = 1;
+}
+int apex_fc_sample(struct apex_fc *ax_fc_ptr, float complex sequence_value, float complex *delta_value_ptr) {
+	int has_value;
+	int is_positive;
+
+	has_value = delta_fc_sample(&ax_fc_ptr->delta, sequence_value, delta_value_ptr);
+	if (has_value) {
+		is_positive = crealf(*delta_value_ptr) >= 0;
+		if (ax_fc_ptr->prior_is_positive != is_positive) {
+			ax_fc_ptr->prior_is_positive = is_positive;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
 /* struct dynamic_window_d */
 
 void dynamic_window_d_init(struct dynamic_window_d *dw_d_ptr, double target_duration, double window_size, int has_prior, double prior_value, double initial_duration) {
@@ -192,6 +380,28 @@ double dynamic_window_d_sample(struct dynamic_window_d *dw_d_ptr, double sequenc
 	}
 }
 
+/* struct dynamic_window_f */
+
+void dynamic_window_f_init(struct dynamic_window_f *dw_f_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration) {
+	dw_f_ptr->td = target_duration;
+	delta_d_init(&dw_f_ptr->s, has_prior, prior_value);
+	exponential_smoothing_f_init(&dw_f_ptr->ed, window_size, initial_duration);
+}
+float dynamic_window_f_sample(struct dynamic_window_f *dw_f_ptr, double sequence_value) {
+	int has_duration_since;
+	double duration_since;
+	float expected_duration;
+
+	/* the duration is taken between double timestamps before narrowing */
+	has_duration_since = delta_d_sample(&dw_f_ptr->s, sequence_value, &duration_since);
+	if (has_duration_since) {
+		expected_duration = exponential_smoothing_f_sample(&dw_f_ptr->ed, duration_since);
+		return dw_f_ptr->td / expected_duration;
+	} else {
+		return dw_f_ptr->td;
+	}
+}
+
 /* struct smooth_duration_d[c] */
 
 void smooth_duration_d_init(struct smooth_duration_d *sd_d_ptr, double target_duration, double window_size, int has_prior, double prior_value, double initial_duration, double initial_value) {
@@ -216,6 +426,28 @@ double complex smooth_duration_dc_sample(struct smooth_duration_dc *sd_dc_ptr, d
 	return exponential_smoother_dc_sample(&sd_dc_ptr->v, value, w);
 }
 
+void smooth_duration_f_init(struct smooth_duration_f *sd_f_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration, float initial_value) {
+	dynamic_window_f_init(&sd_f_ptr->dw, target_duration, window_size, has_prior, prior_value, initial_duration);
+	exponential_smoother_f_init(&sd_f_ptr->v, initial_value);
+}
+float smooth_duration_f_sample(struct smooth_duration_f *sd_f_ptr, float value, double sequence_value) {
+	float w;
+
+	w = dynamic_window_f_sample(&sd_f_ptr->dw, sequence_value);
+	return exponential_smoother_f_sample(&sd_f_ptr->v, value, w);
+}
+
+void smooth_duration_fc_init(struct smooth_duration_fc *sd_fc_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration, float complex initial_value) {
+	dynamic_window_f_init(&sd_fc_ptr->dw, target_duration, window_size, has_prior, prior_value, initial_duration);
+	exponential_smoother_fc_init(&sd_fc_ptr->v, initial_value);
+}
+float complex smooth_duration_fc_sample(struct smooth_duration_fc *sd_fc_ptr, float complex value, double sequence_value) {
+	float w;
+
+	w = dynamic_window_f_sample(&sd_fc_ptr->dw, sequence_value);
+	return exponential_smoother_fc_sample(&sd_fc_ptr->v, value, w);
+}
+
 /* struct smooth_duration_distribution_d[c] */
 
 void smooth_duration_distribution_d_init(struct smooth_duration_distribution_d *sdd_d_ptr, double target_duration, double window_size, int has_prior, double prior_value, double initial_duration, double initial_value) {
@@ -240,6 +472,28 @@ void smooth_duration_distribution_dc_sample(struct smooth_duration_distribution_
 	distribution_dc_sample(&sdd_dc_ptr->v, value, w, ave_ptr, dev_ptr);
 }
 
+void smooth_duration_distribution_f_init(struct smooth_duration_distribution_f *sdd_f_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration, float initial_value) {
+	dynamic_window_f_init(&sdd_f_ptr->dw, target_duration, window_size, has_prior, prior_value, initial_duration);
+	distribution_f_init(&sdd_f_ptr->v, initial_value);
+}
+void smooth_duration_distribution_f_sample(struct smooth_duration_distribution_f *sdd_f_ptr, float value, double sequence_value, float *ave_ptr, float *dev_ptr) {
+	float w;
+
+	w = dynamic_window_f_sample(&sdd_f_ptr->dw, sequence_value);
+	distribution_f_sample(&sdd_f_ptr->v, value, w, ave_ptr, dev_ptr);
+}
+
+void smooth_duration_distribution_fc_init(struct smooth_duration_distribution_fc *sdd_fc_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration, float complex initial_value) {
+	dynamic_window_f_init(&sdd_fc_ptr->dw, target_duration, window_size, has_prior, prior_value, initial_duration);
+	distribution_fc_init(&sdd_fc_ptr->v, initial_value);
+}
+void smooth_duration_distribution_fc_sample(struct smooth_duration_distribution_fc *sdd_fc_ptr, float complex value, double sequence_value, float complex *ave_ptr, float complex *dev_ptr) {
+	float w;
+
+	w = dynamic_window_f_sample(&sdd_fc_ptr->dw, sequence_value);
+	distribution_fc_sample(&sdd_fc_ptr->v, value, w, ave_ptr, dev_ptr);
+}
+
 /* struct time_smoothing_d */
 
 void time_smoothing_d_init(struct time_smoothing_d *ts_d_ptr, struct receptive_field *field_ptr, struct receptive_value *value_ptr) {
@@ -248,11 +502,26 @@ void time_smoothing_d_init(struct time_smoothing_d *ts_d_ptr, struct receptive_f
 	exponential_smoother_dc_init(&ts_d_ptr->v, value_ptr->cval);
 }
 void time_smoothing_d_sample(struct time_smoothing_d *ts_d_ptr, double time, double value) {
-	ts_d_ptr->value_ptr->cval = exponential_smoother_dc_sample(&ts_d_ptr->v, rect1((time + ts_d_ptr->field_ptr->phase) / ts_d_ptr->field_ptr->period) * value, ts_d_ptr->field_ptr->period * ts_d_ptr->field_ptr->period_factor);
-	receptive_value_polar(ts_d_ptr->value_ptr);
+	receptive_value_set_cval(ts_d_ptr->value_ptr, exponential_smoother_dc_sample(&ts_d_ptr->v, rect1((time + ts_d_ptr->field_ptr->phase) / ts_d_ptr->field_ptr->period) * value, ts_d_ptr->field_ptr->period * ts_d_ptr->field_ptr->period_factor));
 	ts_d_ptr->value_ptr->timestamp = time;
 }
 
+/* struct time_smoothing_f */
+
+void time_smoothing_f_init(struct time_smoothing_f *ts_f_ptr, struct receptive_field *field_ptr, struct receptive_value_f *value_ptr) {
+	ts_f_ptr->field_ptr = field_ptr;
+	ts_f_ptr->value_ptr = value_ptr;
+	exponential_smoother_fc_init(&ts_f_ptr->v, value_ptr->cval);
+}
+void time_smoothing_f_sample(struct time_smoothing_f *ts_f_ptr, double time, float value) {
+	float tau;
+
+	/* the phase within the period is reduced in double, as float `time` would lose the phase within minutes */
+	tau = fmod((time + ts_f_ptr->field_ptr->phase) / ts_f_ptr->field_ptr->period, 1.0);
+	receptive_value_f_set_cval(ts_f_ptr->value_ptr, exponential_smoother_fc_sample(&ts_f_ptr->v, rect1f(tau) * value, ts_f_ptr->field_ptr->period * ts_f_ptr->field_ptr->period_factor));
+	ts_f_ptr->value_ptr->timestamp = time;
+}
+
 /* struct dynamic_time_smoothing_d */
 
 void dynamic_time_smoothing_d_init(struct dynamic_time_smoothing_d *dts_d_ptr, struct receptive_field *field_ptr, struct receptive_value *value_ptr, double initial_glissando) {
@@ -297,18 +566,78 @@ void receptive_field_init(struct receptive_field *field_ptr) {
 
 /* receptive_value */
 
+void receptive_value_set_cval(struct receptive_value *rv_ptr, double complex cval) {
+	rv_ptr->cval = cval;
+	rv_ptr->has_r   = 0;
+	rv_ptr->has_phi = 0;
+}
+double receptive_value_get_r(struct receptive_value *rv_ptr) {
+	if ( ! rv_ptr->has_r) {
+		rv_ptr->r = cabs(rv_ptr->cval);
+		rv_ptr->has_r = 1;
+	}
+	return rv_ptr->r;
+}
+double receptive_value_get_phi(struct receptive_value *rv_ptr) {
+	if ( ! rv_ptr->has_phi) {
+		rv_ptr->phi = rad2tau(carg(rv_ptr->cval));
+		rv_ptr->has_phi = 1;
+	}
+	return rv_ptr->phi;
+}
 void receptive_value_polar(struct receptive_value *rv_ptr) {
-	rv_ptr->r   =         cabs(rv_ptr->cval);
-	rv_ptr->phi = rad2tau(carg(rv_ptr->cval));
+	(void) receptive_value_get_r(rv_ptr);
+	(void) receptive_value_get_phi(rv_ptr);
 }
-void receptive_value_rect(struct receptive_value *rv_ptr) {
-	rv_ptr->cval = rect(rv_ptr->phi, rv_ptr->r);
+void receptive_value_set_polar(struct receptive_value *rv_ptr, double r, double phi) {
+	rv_ptr->cval = rect(phi, r);
+	rv_ptr->r   = r;
+	rv_ptr->phi = phi;
+	rv_ptr->has_r   = 1;
+	rv_ptr->has_phi = 1;
 }
 void receptive_value_init(struct receptive_value *rv_ptr, double complex cval) {
-	rv_ptr->cval = cval;
+	receptive_value_set_cval(rv_ptr, cval);
 	receptive_value_polar(rv_ptr);
 }
 
+/* receptive_value_f */
+
+void receptive_value_f_set_cval(struct receptive_value_f *rv_f_ptr, float complex cval) {
+	rv_f_ptr->cval = cval;
+	rv_f_ptr->has_r   = 0;
+	rv_f_ptr->has_phi = 0;
+}
+float receptive_value_f_get_r(struct receptive_value_f *rv_f_ptr) {
+	if ( ! rv_f_ptr->has_r) {
+		rv_f_ptr->r = cabsf(rv_f_ptr->cval);
+		rv_f_ptr->has_r = 1;
+	}
+	return rv_f_ptr->r;
+}
+float receptive_value_f_get_phi(struct receptive_value_f *rv_f_ptr) {
+	if ( ! rv_f_ptr->has_phi) {
+		rv_f_ptr->phi = rad2tauf(cargf(rv_f_ptr->cval));
+		rv_f_ptr->has_phi = 1;
+	}
+	return rv_f_ptr->phi;
+}
+void receptive_value_f_polar(struct receptive_value_f *rv_f_ptr) {
+	(void) receptive_value_f_get_r(rv_f_ptr);
+	(void) receptive_value_f_get_phi(rv_f_ptr);
+}
+void receptive_value_f_set_polar(struct receptive_value_f *rv_f_ptr, float r, float phi) {
+	rv_f_ptr->cval = rectf(phi, r);
+	rv_f_ptr->r   = r;
+	rv_f_ptr->phi = phi;
+	rv_f_ptr->has_r   = 1;
+	rv_f_ptr->has_phi = 1;
+}
+void receptive_value_f_init(struct receptive_value_f *rv_f_ptr, float complex cval) {
+	receptive_value_f_set_cval(rv_f_ptr, cval);
+	receptive_value_f_polar(rv_f_ptr);
+}
+
 /* struct monochord */
 
 void monochord_construct(struct monochord *mc_ptr) {
@@ -327,7 +656,9 @@ void monochord_init(struct monochord *mc_ptr, double source_period, double targe
 
 void monochord_rotate(struct monochord *mc_ptr, struct receptive_value *rv_ptr) {
 	rv_ptr->cval *= mc_ptr->value;
-	rv_ptr->phi = fmod(rv_ptr->phi + mc_ptr->phi_offset + 0.5, 1) - 0.5;
+	if (rv_ptr->has_phi) {
+		rv_ptr->phi = fmod(rv_ptr->phi + mc_ptr->phi_offset + 0.5, 1) - 0.5;
+	}
 }
 
 /* struct period_result */
@@ -337,8 +668,7 @@ void receptive_value_dup_monochord(struct receptive_value *rv_dup_ptr, struct re
 	monochord_rotate(mc_ptr, rv_dup_ptr);
 }
 void receptive_value_superimpose(struct receptive_value *rv_target_ptr, struct receptive_value *rv_source_ptr) {
-	rv_target_ptr->cval += rv_source_ptr->cval;
-	receptive_value_polar(rv_target_ptr);
+	receptive_value_set_cval(rv_target_ptr, rv_target_ptr->cval + rv_source_ptr->cval);
 }
 
 /* struct period_percept */
@@ -367,12 +697,11 @@ void period_recept_init(struct period_recept *pr_ptr, struct period_percept *pha
 	pr_ptr->frequency = 1.0 / pr_ptr->field.period;
 
 	pr_ptr->value.timestamp = pr_ptr->phase->value.timestamp;
-	pr_ptr->value.cval = delta_dc(pr_ptr->phase->value.cval, pr_ptr->prior_phase->value.cval);
-	receptive_value_polar(&pr_ptr->value);
+	receptive_value_set_cval(&pr_ptr->value, delta_dc(pr_ptr->phase->value.cval, pr_ptr->prior_phase->value.cval));
 	pr_ptr->duration = pr_ptr->phase->timestamp - pr_ptr->prior_phase->timestamp;
 
 	if (pr_ptr->duration > 0) {
-		phi_t = pr_ptr->value.phi / pr_ptr->duration;
+		phi_t = receptive_value_get_phi(&pr_ptr->value) / pr_ptr->duration;
 	} else {
 		phi_t = 0.0;
 	}
@@ -381,18 +710,28 @@ void period_recept_init(struct period_recept *pr_ptr, struct period_percept *pha
 	pr_ptr->instant_period    = 1.0 / pr_ptr->instant_frequency;
 }
 
+void period_recept_set_instant_period(struct period_recept *pr_ptr, double instant_period) {
+	pr_ptr->instant_period    = instant_period;
+	pr_ptr->instant_frequency = 1.0 / instant_period;
+}
+
 /* struct period_concept */
 void period_concept_state_init(struct period_concept_state *pcs_ptr, struct receptive_field *field_ptr) { 
 	exponential_smoother_d_init(&pcs_ptr->avg_instant_period_state, field_ptr->period);
 	delta_d_init(&pcs_ptr->instant_period_delta_state, 0, 0);
 	exponential_smoother_d_init(&pcs_ptr->instant_period_stddev_state, field_ptr->period);
+	pcs_ptr->response_stride = 1;
+}
+
+void period_concept_state_set_response_stride(struct period_concept_state *pcs_ptr, unsigned int response_stride) {
+	pcs_ptr->response_stride = response_stride;
 }
 
 void period_concept_init(struct period_concept *pc_ptr, struct period_concept_state *pcs_ptr, struct period_recept *recept_ptr) {
 	pc_ptr->recept_ptr = recept_ptr;
 
 	/* average instantaneous period */
-	pc_ptr->avg_instant_period = exponential_smoother_d_sample(&pcs_ptr->avg_instant_period_state, recept_ptr->instant_period, recept_ptr->field.period * recept_ptr->field.phase_factor);
+	pc_ptr->avg_instant_period = exponential_smoother_d_sample(&pcs_ptr->avg_instant_period_state, recept_ptr->instant_period, exponential_smoother_d_stride_factor(recept_ptr->field.period * recept_ptr->field.phase_factor, pcs_ptr->response_stride));
 	pc_ptr->avg_instant_period_offset = pc_ptr->avg_instant_period - recept_ptr->field.period;
 
 	/* deviation of average */
@@ -402,7 +741,7 @@ void period_concept_init(struct period_concept *pc_ptr, struct period_concept_st
 		pc_ptr->has_instant_period_delta = 1;
 	}
 	/* standard deviation of average (dis-convergence on an average instant period) */
-	pc_ptr->instant_period_stddev = exponential_smoother_d_sample(&pcs_ptr->instant_period_stddev_state, fabs(pc_ptr->instant_period_delta), fabs(recept_ptr->instant_period * recept_ptr->field.phase_factor));
+	pc_ptr->instant_period_stddev = exponential_smoother_d_sample(&pcs_ptr->instant_period_stddev_state, fabs(pc_ptr->instant_period_delta), exponential_smoother_d_stride_factor(fabs(recept_ptr->instant_period * recept_ptr->field.phase_factor), pcs_ptr->response_stride));
 }
 
 /* struct period sensor */
@@ -419,25 +758,84 @@ void period_sensor_init(struct period_sensor *ps_ptr) {
 	dynamic_time_smoothing_d_init(&ps_ptr->sensor_state, &ps_ptr->field, &ps_ptr->value, 0);
 	period_concept_state_init(&ps_ptr->concept_state, &ps_ptr->field);
 	ps_ptr->has_prior_percept = 0;
+	ps_ptr->has_capture_percept = 0;
+	ps_ptr->stride_period = 0.0;
+	ps_ptr->stride_r = 0.0;
+	ps_ptr->stride_r_factor = 1.0;
+	/* the concept of the field at rest, until the first response, which with a response stride is a stride away */
+	period_percept_init(&ps_ptr->percept, &ps_ptr->sensor_state, 0.0);
+	ps_ptr->prior_percept = ps_ptr->percept;
+	period_recept_init(&ps_ptr->recept, &ps_ptr->percept, &ps_ptr->prior_percept);
+	ps_ptr->concept.recept_ptr = &ps_ptr->recept;
+	ps_ptr->concept.avg_instant_period = ps_ptr->field.period;
+	ps_ptr->concept.avg_instant_period_offset = 0.0;
+	ps_ptr->concept.instant_period_delta = 0.0;
+	ps_ptr->concept.has_instant_period_delta = 0;
+	ps_ptr->concept.instant_period_stddev = ps_ptr->field.period;
 }
 
 void period_sensor_receive(struct period_sensor *ps_ptr) {
 	period_recept_init(&ps_ptr->recept, &ps_ptr->percept, &ps_ptr->prior_percept);
+	if (ps_ptr->concept_state.response_stride > 1) {
+		period_recept_set_instant_period(&ps_ptr->recept, ps_ptr->stride_period * exponential_smoother_d_stride_factor(ps_ptr->field.period * ps_ptr->field.phase_factor, ps_ptr->concept_state.response_stride));
+	}
 	period_concept_init(&ps_ptr->concept, &ps_ptr->concept_state, &ps_ptr->recept);
 }
 
-void period_sensor_sample(struct period_sensor *ps_ptr, double time, double value) {
+void period_sensor_accumulate(struct period_sensor *ps_ptr, double complex prior_cval) {
+	double complex cval = ps_ptr->value.cval;
+	double instant_period;
+
+	/* the recept and concept of the sample, as `period_recept_init()` over one sample and `period_concept_init()` */
+	instant_period = 1.0 / (1.0 / ps_ptr->field.period - rad2tau(carg(cval * conj(prior_cval))));
+	ps_ptr->stride_period += (instant_period - ps_ptr->stride_period) / (ps_ptr->field.period * ps_ptr->field.phase_factor);
+	ps_ptr->stride_r      += (cabs(cval)     - ps_ptr->stride_r)      / ps_ptr->stride_r_factor;
+}
+
+void period_sensor_restart_stride(struct period_sensor *ps_ptr, unsigned int response_phase) {
+	if (response_phase == 0) {
+		ps_ptr->stride_period = 0.0;
+		ps_ptr->stride_r      = 0.0;
+		return;
+	}
+	ps_ptr->stride_period = ps_ptr->concept.avg_instant_period / exponential_smoother_d_stride_factor(ps_ptr->field.period * ps_ptr->field.phase_factor, response_phase);
+	ps_ptr->stride_r      = cabs(ps_ptr->value.cval)           / exponential_smoother_d_stride_factor(ps_ptr->stride_r_factor, response_phase);
+}
+
+void period_sensor_resonate(struct period_sensor *ps_ptr, double time, double value) {
+	double complex prior_cval = ps_ptr->value.cval;
+
+	dynamic_time_smoothing_d_sample(&ps_ptr->sensor_state, time, value);
+	if (ps_ptr->concept_state.response_stride > 1) {
+		period_sensor_accumulate(ps_ptr, prior_cval);
+	}
+}
+
+void period_sensor_capture(struct period_sensor *ps_ptr, double time) {
+	period_percept_init(&ps_ptr->capture_percept, &ps_ptr->sensor_state, time);
+	ps_ptr->has_capture_percept = 1;
+}
+
+void period_sensor_perceive(struct period_sensor *ps_ptr, double time) {
+	if (ps_ptr->has_capture_percept) {
+		/* the captured percept becomes the prior */
+		ps_ptr->percept = ps_ptr->capture_percept;
+		ps_ptr->has_capture_percept = 0;
+	}
 	if (ps_ptr->has_prior_percept) {
 		ps_ptr->prior_percept = ps_ptr->percept;
 	}
-	dynamic_time_smoothing_d_sample(&ps_ptr->sensor_state, time, value);
 	period_percept_init(&ps_ptr->percept, &ps_ptr->sensor_state, time);
 	if ( ! ps_ptr->has_prior_percept) {
 		/* when no prior, make prior the same as current */
 		ps_ptr->prior_percept = ps_ptr->percept;
 		ps_ptr->has_prior_percept = 1;
 	}
+}
 
+void period_sensor_sample(struct period_sensor *ps_ptr, double time, double value) {
+	period_sensor_resonate(ps_ptr, time, value);
+	period_sensor_perceive(ps_ptr, time);
 	period_sensor_receive(ps_ptr);
 }
 
@@ -485,6 +883,34 @@ double lifecycle_sample(struct lifecycle *lc_ptr, double complex cval) {
 	return lc_ptr->lifecycle;
 }
 
+/* struct lifecycle_f */
+void lifecycle_f_init(struct lifecycle_f *lc_f_ptr, float max_r) {
+	lc_f_ptr->max_r = max_r;
+	lc_f_ptr->F = 0.0f;
+	lc_f_ptr->r = 0.0f;
+	lc_f_ptr->phi = 0.0f;
+	lc_f_ptr->cycle = 0;
+	lc_f_ptr->lifecycle = 0.0f;
+}
+float lifecycle_f_sample(struct lifecycle_f *lc_f_ptr, float complex cval) {
+	float prev_phi;
+
+	lc_f_ptr->cval = cval;
+	lc_f_ptr->F = crealf(cval) - cimagf(cval);
+	prev_phi = lc_f_ptr->phi;
+	lc_f_ptr->r   =          cabsf(lc_f_ptr->cval);
+	lc_f_ptr->phi = rad2tauf(cargf(lc_f_ptr->cval));
+	if (        lc_f_ptr->phi - prev_phi >  0.5f) {
+		lc_f_ptr->cycle--;
+	}  else if (lc_f_ptr->phi - prev_phi < -0.5f) {
+		lc_f_ptr->cycle++;
+	}
+
+	lc_f_ptr->lifecycle = lc_f_ptr->cycle + lc_f_ptr->phi;
+
+	return lc_f_ptr->lifecycle;
+}
+
 /* struct livecycle_derive (struct livecycle) */
 void lifecycle_derive_init(struct lifecycle_derive *lcd_ptr, double max_r, double response_factor) {
 	lifecycle_init(&lcd_ptr->lc, max_r);
@@ -550,7 +976,7 @@ double lifecycle_iter_sample(struct lifecycle_iter *lci_ptr, double value) {
 
 /* Period Scale-Space */
 unsigned int period_scale_space_sensor_monochord_max(struct period_scale_space_sensor *sss_ptr) {
-	return sizeof (sss_ptr->monochords) / sizeof (sss_ptr->monochords[0]);
+	return sss_ptr->monochord_capacity;
 }
 struct receptive_field *period_scale_space_sensor_get_receptive_field(struct period_scale_space_sensor *sss_ptr) {
 	return &sss_ptr->field;
@@ -579,6 +1005,36 @@ void period_scale_space_sensor_init(struct period_scale_space_sensor *sss_ptr) {
 	lifecycle_iter_init(  &sss_ptr->beat_lifecycle,   sss_ptr->field.period);
 
 	sss_ptr->monochord_count = 0;
+	sss_ptr->response_stride      = 1;
+	sss_ptr->next_response_stride = 0;
+	sss_ptr->response_phase       = 0;
+}
+
+static void period_scale_space_sensor_take_response_stride(struct period_scale_space_sensor *sss_ptr, unsigned int response_stride) {
+	int i;
+
+	sss_ptr->response_stride      = response_stride;
+	sss_ptr->next_response_stride = 0;
+	for (i = 0; i < 3; i++) {
+		period_concept_state_set_response_stride(&sss_ptr->period_sensors[i].concept_state, response_stride);
+		sss_ptr->period_sensors[i].stride_r_factor = sss_ptr->response_period;
+	}
+	sss_ptr->period_lifecycle.response_factor = exponential_smoother_d_stride_factor(sss_ptr->response_period, response_stride);
+}
+
+void period_scale_space_sensor_set_response_stride(struct period_scale_space_sensor *sss_ptr, unsigned int response_stride) {
+	if (response_stride < 1) {
+		response_stride = 1;
+	}
+	/*
+	 * within a stride, the averages since the last response are the old stride's, so the next response still takes them
+	 * over the old stride and the new one starts from there
+	 */
+	if (sss_ptr->response_phase > 0) {
+		sss_ptr->next_response_stride = response_stride != sss_ptr->response_stride ? response_stride : 0;
+		return;
+	}
+	period_scale_space_sensor_take_response_stride(sss_ptr, response_stride);
 }
 
 void period_scale_space_sensor_sample_sensor(struct period_scale_space_sensor *sss_ptr, double time, double value) {
@@ -594,24 +1050,116 @@ void period_scale_space_sensor_sample_monochords(struct period_scale_space_senso
 	}
 }
 
+/* the magnitude the period lifecycle takes of scale `i`: with a response stride, the average of every sample's since the last response */
+static double period_scale_space_sensor_lifecycle_r(struct period_scale_space_sensor *sss_ptr, int i) {
+	struct period_sensor *ps_ptr = &sss_ptr->period_sensors[i];
+
+	if (sss_ptr->response_stride > 1) {
+		return ps_ptr->stride_r * sss_ptr->period_lifecycle.response_factor;
+	}
+	return receptive_value_get_r(&ps_ptr->percept.value);
+}
+
 void period_scale_space_sensor_sample_lifecycle(struct period_scale_space_sensor *sss_ptr) {
 	lifecycle_derive_sample_avg(&sss_ptr->period_lifecycle,
-		sss_ptr->period_sensors[0].percept.value.r, 
-		sss_ptr->period_sensors[1].percept.value.r, 
-		sss_ptr->period_sensors[2].percept.value.r);
+		period_scale_space_sensor_lifecycle_r(sss_ptr, 0),
+		period_scale_space_sensor_lifecycle_r(sss_ptr, 1),
+		period_scale_space_sensor_lifecycle_r(sss_ptr, 2));
 	lifecycle_iter_sample(&sss_ptr->beat_lifecycle, sss_ptr->period_lifecycle.lc.lifecycle);
 }
 
+/* start the averages of the next stride, over the stride set since the last response if there is one */
+static void period_scale_space_sensor_restart_stride(struct period_scale_space_sensor *sss_ptr) {
+	int i;
+
+	sss_ptr->response_phase = 0;
+	for (i = 0; i < 3; i++) {
+		period_sensor_restart_stride(&sss_ptr->period_sensors[i], 0);
+	}
+	if (sss_ptr->next_response_stride > 0) {
+		period_scale_space_sensor_take_response_stride(sss_ptr, sss_ptr->next_response_stride);
+	}
+}
+
+void period_scale_space_sensor_sample_strided(struct period_scale_space_sensor *sss_ptr, double time, double value) {
+	int i;
+	int j;
+
+	for (i = 0; i < 3; i++) {
+		period_sensor_resonate(&sss_ptr->period_sensors[i], time, value);
+	}
+
+	sss_ptr->response_phase++;
+	if (sss_ptr->response_phase == sss_ptr->response_stride - 1) {
+		for (i = 0; i < 3; i++) {
+			period_sensor_capture(&sss_ptr->period_sensors[i], time);
+		}
+		RECEPT_PROFILE_BEGIN(capture_begin);
+		for (j = 0; j < sss_ptr->monochord_count; j++) {
+			period_scale_space_sensor_superimpose_monochord_captures_on(sss_ptr->monochords[j].source_sss_ptr, sss_ptr, &sss_ptr->monochords[j].monochord);
+		}
+		RECEPT_PROFILE_END_WITHIN_LOCAL(capture_begin, RECEPT_PROFILE_MONOCHORDS, RECEPT_PROFILE_SENSOR);
+	}
+	if (sss_ptr->response_phase < sss_ptr->response_stride) {
+		return;
+	}
+
+	for (i = 0; i < 3; i++) {
+		period_sensor_perceive(&sss_ptr->period_sensors[i], time);
+	}
+	RECEPT_PROFILE_BEGIN(percept_begin);
+	for (j = 0; j < sss_ptr->monochord_count; j++) {
+		period_scale_space_sensor_superimpose_monochord_percepts_on(sss_ptr->monochords[j].source_sss_ptr, sss_ptr, &sss_ptr->monochords[j].monochord);
+	}
+	RECEPT_PROFILE_END_WITHIN_LOCAL(percept_begin, RECEPT_PROFILE_MONOCHORDS, RECEPT_PROFILE_SENSOR);
+	for (i = 0; i < 3; i++) {
+		period_sensor_receive(&sss_ptr->period_sensors[i]);
+	}
+	RECEPT_PROFILE_BEGIN(lifecycle_begin);
+	period_scale_space_sensor_sample_lifecycle(sss_ptr);
+	RECEPT_PROFILE_END_WITHIN_LOCAL(lifecycle_begin, RECEPT_PROFILE_LIFECYCLE, RECEPT_PROFILE_SENSOR);
+	period_scale_space_sensor_restart_stride(sss_ptr);
+}
+
 void period_scale_space_sensor_values(struct period_scale_space_sensor *sss_ptr, struct scale_space_value *ss_value) {
 	ss_value->concept_ptr          = &sss_ptr->period_sensors[0].concept;
 	ss_value->period_lifecycle_ptr = &sss_ptr->period_lifecycle.lc;
 	ss_value->beat_lifecycle_ptr   = &sss_ptr->beat_lifecycle.lc;
 }
 
-void period_scale_space_sensor_sample(struct period_scale_space_sensor *sss_ptr, struct scale_space_value *ss_value, double time, double value) {
-	period_scale_space_sensor_sample_sensor(sss_ptr, time, value);
+/* the monochords and lifecycle of an unstrided sample, timed apart from the sensor stage they are called in */
+static void period_scale_space_sensor_sample_stages(struct period_scale_space_sensor *sss_ptr) {
+	RECEPT_PROFILE_BEGIN(monochords_begin);
 	period_scale_space_sensor_sample_monochords(sss_ptr);
+	RECEPT_PROFILE_END_WITHIN_LOCAL(monochords_begin, RECEPT_PROFILE_MONOCHORDS, RECEPT_PROFILE_SENSOR);
+	RECEPT_PROFILE_BEGIN(lifecycle_begin);
 	period_scale_space_sensor_sample_lifecycle(sss_ptr);
+	RECEPT_PROFILE_END_WITHIN_LOCAL(lifecycle_begin, RECEPT_PROFILE_LIFECYCLE, RECEPT_PROFILE_SENSOR);
+}
+
+void period_scale_space_sensor_sample(struct period_scale_space_sensor *sss_ptr, struct scale_space_value *ss_value, double time, double value) {
+	if (sss_ptr->response_stride > 1) {
+		period_scale_space_sensor_sample_strided(sss_ptr, time, value);
+	} else {
+		period_scale_space_sensor_sample_sensor(sss_ptr, time, value);
+		period_scale_space_sensor_sample_stages(sss_ptr);
+	}
+	period_scale_space_sensor_values(sss_ptr, ss_value);
+}
+
+void period_scale_space_sensor_sample_block(struct period_scale_space_sensor *sss_ptr, struct scale_space_value *ss_value, double time, const double *samples, size_t n) {
+	size_t i;
+
+	if (sss_ptr->response_stride > 1) {
+		for (i = 0; i < n; i++) {
+			period_scale_space_sensor_sample_strided(sss_ptr, time + i, samples[i]);
+		}
+	} else {
+		for (i = 0; i < n; i++) {
+			period_scale_space_sensor_sample_sensor(sss_ptr, time + i, samples[i]);
+			period_scale_space_sensor_sample_stages(sss_ptr);
+		}
+	}
 	period_scale_space_sensor_values(sss_ptr, ss_value);
 }
 
@@ -619,11 +1167,21 @@ void period_scale_space_sensor_init_monochord(struct period_scale_space_sensor *
 	monochord_init(mc_ptr, sss_ptr->field.period, target_sss_ptr->field.period, monochord_ratio);
 }
 
-void period_scale_space_sensor_superimpose_monochord_on(struct period_scale_space_sensor *sss_ptr, struct period_scale_space_sensor *target_sss_ptr, struct monochord *mc_ptr) {
+void period_scale_space_sensor_superimpose_monochord_captures_on(struct period_scale_space_sensor *sss_ptr, struct period_scale_space_sensor *target_sss_ptr, struct monochord *mc_ptr) {
+	period_percept_superimpose_from_percept(&sss_ptr->period_sensors[0].capture_percept, &target_sss_ptr->period_sensors[0].capture_percept, mc_ptr);
+	period_percept_superimpose_from_percept(&sss_ptr->period_sensors[1].capture_percept, &target_sss_ptr->period_sensors[1].capture_percept, mc_ptr);
+	period_percept_superimpose_from_percept(&sss_ptr->period_sensors[2].capture_percept, &target_sss_ptr->period_sensors[2].capture_percept, mc_ptr);
+}
+
+void period_scale_space_sensor_superimpose_monochord_percepts_on(struct period_scale_space_sensor *sss_ptr, struct period_scale_space_sensor *target_sss_ptr, struct monochord *mc_ptr) {
 	period_percept_superimpose_from_percept(&sss_ptr->period_sensors[0].percept, &target_sss_ptr->period_sensors[0].percept, mc_ptr);
 	period_percept_superimpose_from_percept(&sss_ptr->period_sensors[1].percept, &target_sss_ptr->period_sensors[1].percept, mc_ptr);
 	period_percept_superimpose_from_percept(&sss_ptr->period_sensors[2].percept, &target_sss_ptr->period_sensors[2].percept, mc_ptr);
-	
+}
+
+void period_scale_space_sensor_superimpose_monochord_on(struct period_scale_space_sensor *sss_ptr, struct period_scale_space_sensor *target_sss_ptr, struct monochord *mc_ptr) {
+	period_scale_space_sensor_superimpose_monochord_percepts_on(sss_ptr, target_sss_ptr, mc_ptr);
+
 	period_sensor_receive(&target_sss_ptr->period_sensors[0]);
 	period_sensor_receive(&target_sss_ptr->period_sensors[1]);
 	period_sensor_receive(&target_sss_ptr->period_sensors[2]);
@@ -642,6 +1200,122 @@ int period_scale_space_sensor_add_monochord(struct period_scale_space_sensor *ss
 }
 
 /* Sensor Arrays */
+
+#define PERIOD_ARRAY_ALIGN 64
+#define PERIOD_ARRAY_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+static size_t period_array_align(size_t size) {
+	return (size + PERIOD_ARRAY_ALIGN - 1) / PERIOD_ARRAY_ALIGN * PERIOD_ARRAY_ALIGN;
+}
+
+/* the arena: the struct, the entries, each entry's monochords, then the monochord matrix, each on a PERIOD_ARRAY_ALIGN boundary */
+static void *period_array_arena_alloc(size_t size, int flags, int *mapped_ptr) {
+	void *arena;
+	int rc;
+
+	*mapped_ptr = 0;
+	if ((flags & PERIOD_ARRAY_HUGE_PAGES) && size >= PERIOD_ARRAY_HUGE_PAGE_SIZE) {
+#ifdef MAP_HUGETLB
+		arena = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (arena != MAP_FAILED) {
+			*mapped_ptr = 1;
+			return arena;
+		}
+#endif
+		/* no reserved huge pages: align to them, so that transparent ones may back the arena */
+		rc = posix_memalign(&arena, PERIOD_ARRAY_HUGE_PAGE_SIZE, size);
+		if (rc != 0) {
+			errno = rc;
+			return NULL;
+		}
+#ifdef MADV_HUGEPAGE
+		(void) madvise(arena, size, MADV_HUGEPAGE);
+#endif
+		memset(arena, 0, size);
+		return arena;
+	}
+
+	rc = posix_memalign(&arena, PERIOD_ARRAY_ALIGN, size);
+	if (rc != 0) {
+		errno = rc;
+		return NULL;
+	}
+	memset(arena, 0, size);
+
+	return arena;
+}
+
+struct period_array *period_array_create(unsigned int capacity, unsigned int monochord_capacity, int flags) {
+	struct period_array *pa_ptr;
+	struct monochord_entry *monochords;
+	size_t entries_offset;
+	size_t monochords_offset;
+	size_t matrix_offset;
+	size_t size;
+	size_t nonzero;
+	void *arena;
+	int mapped;
+	unsigned int i;
+
+	entries_offset    = period_array_align(sizeof (*pa_ptr));
+	monochords_offset = entries_offset + period_array_align((size_t) capacity * sizeof (*pa_ptr->scale_space_entries));
+	nonzero           = (size_t) capacity * monochord_capacity;
+	matrix_offset     = monochords_offset + period_array_align(nonzero * sizeof (*monochords));
+	size              = matrix_offset;
+	size             += period_array_align(((size_t) capacity + 1) * sizeof (*pa_ptr->monochord_matrix.row_begin));
+	size             += period_array_align(nonzero * sizeof (*pa_ptr->monochord_matrix.source));
+	size             += period_array_align(nonzero * sizeof (*pa_ptr->monochord_matrix.value));
+	size             += period_array_align((size_t) capacity * 3 * sizeof (*pa_ptr->monochord_matrix.sums));
+	if (flags & PERIOD_ARRAY_HUGE_PAGES) {
+		size = (size + PERIOD_ARRAY_HUGE_PAGE_SIZE - 1) / PERIOD_ARRAY_HUGE_PAGE_SIZE * PERIOD_ARRAY_HUGE_PAGE_SIZE;
+	}
+
+	arena = period_array_arena_alloc(size, flags, &mapped);
+	if (arena == NULL) {
+		return NULL;
+	}
+
+	pa_ptr = arena;
+	pa_ptr->scale_space_entries = (struct scale_space_entry *) ((char *) arena + entries_offset);
+	pa_ptr->scale_space_sensor_count = 0;
+	pa_ptr->scale_space_sensor_capacity = capacity;
+	pa_ptr->monochord_capacity = monochord_capacity;
+	pa_ptr->scale_space_sensor_shed = 0;
+	pa_ptr->monochords_shed = 0;
+	pa_ptr->arena = arena;
+	pa_ptr->arena_size = size;
+	pa_ptr->arena_mapped = mapped;
+
+	monochords = (struct monochord_entry *) ((char *) arena + monochords_offset);
+	for (i = 0; i < capacity; i++) {
+		pa_ptr->scale_space_entries[i].sensor.monochords = monochord_capacity > 0 ? &monochords[(size_t) i * monochord_capacity] : NULL;
+		pa_ptr->scale_space_entries[i].sensor.monochord_capacity = monochord_capacity;
+	}
+
+	pa_ptr->monochord_matrix.row_begin = (unsigned int *) ((char *) arena + matrix_offset);
+	matrix_offset += period_array_align(((size_t) capacity + 1) * sizeof (*pa_ptr->monochord_matrix.row_begin));
+	pa_ptr->monochord_matrix.source = (unsigned int *) ((char *) arena + matrix_offset);
+	matrix_offset += period_array_align(nonzero * sizeof (*pa_ptr->monochord_matrix.source));
+	pa_ptr->monochord_matrix.value = (double complex *) ((char *) arena + matrix_offset);
+	matrix_offset += period_array_align(nonzero * sizeof (*pa_ptr->monochord_matrix.value));
+	pa_ptr->monochord_matrix.sums = (double complex *) ((char *) arena + matrix_offset);
+	pa_ptr->monochord_matrix.count = 0;
+	pa_ptr->monochord_matrix.compiled = 1;
+
+	return pa_ptr;
+}
+
+void period_array_destroy(struct period_array *pa_ptr) {
+	if (pa_ptr == NULL) {
+		return;
+	}
+	if (pa_ptr->arena_mapped) {
+		(void) munmap(pa_ptr->arena, pa_ptr->arena_size);
+	} else {
+		free(pa_ptr->arena);
+	}
+}
+
 struct receptive_field *period_array_get_receptive_field(struct period_array *pa_ptr) {
 	return &pa_ptr->field;
 }
@@ -653,15 +1327,42 @@ void period_array_init(struct period_array *pa_ptr, double response_period, doub
 	/* self.period_bandwidth = 1.0 / ((2.0 ** (1.0 / self.octave_bandwidth)) - 1) */
 	pa_ptr->period_bandwidth = 1.0 / (pow(2.0, 1.0 / pa_ptr->octave_bandwidth) - 1);
 	pa_ptr->scale_space_sensor_count = 0;
+	pa_ptr->response_stride = 1;
 }
 
-unsigned int period_array_period_sensor_max(struct period_array *pa_ptr) {
-	return sizeof (pa_ptr->scale_space_entries) / sizeof (pa_ptr->scale_space_entries[0]);
-}
-unsigned int period_array_period_sensor_count(struct period_array *pa_ptr) {
-	return pa_ptr->scale_space_sensor_count;
-}
-struct scale_space_entry *period_array_get_entries(struct period_array *pa_ptr) {
+static int period_array_has_monochords(struct period_array *pa_ptr) {
+	int i;
+
+	for (i = 0; i < pa_ptr->scale_space_sensor_count; i++) {
+		if (pa_ptr->scale_space_entries[i].sensor.monochord_count > 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* the stride the sensors respond on: monochords superimpose their sources on every sample, which no average over a stride stands in for */
+static unsigned int period_array_sensor_response_stride(struct period_array *pa_ptr) {
+	return period_array_has_monochords(pa_ptr) ? 1 : pa_ptr->response_stride;
+}
+
+void period_array_set_response_stride(struct period_array *pa_ptr, unsigned int response_stride) {
+	int i;
+
+	pa_ptr->response_stride = response_stride;
+	response_stride = period_array_sensor_response_stride(pa_ptr);
+	for (i = 0; i < pa_ptr->scale_space_sensor_count; i++) {
+		period_scale_space_sensor_set_response_stride(&pa_ptr->scale_space_entries[i].sensor, response_stride);
+	}
+}
+
+unsigned int period_array_period_sensor_max(struct period_array *pa_ptr) {
+	return pa_ptr->scale_space_sensor_capacity;
+}
+unsigned int period_array_period_sensor_count(struct period_array *pa_ptr) {
+	return pa_ptr->scale_space_sensor_count;
+}
+struct scale_space_entry *period_array_get_entries(struct period_array *pa_ptr) {
 	return pa_ptr->scale_space_entries;
 }
 int period_array_add_period_sensor(struct period_array *pa_ptr, double period, double bandwidth_factor) {
@@ -681,6 +1382,9 @@ int period_array_add_period_sensor(struct period_array *pa_ptr, double period, d
 	period_scale_space_sensor_set_response_period(sss_ptr, pa_ptr->response_period);
 	period_scale_space_sensor_set_scale_factor(   sss_ptr, pa_ptr->scale_factor);
 	period_scale_space_sensor_init(sss_ptr);
+	period_scale_space_sensor_set_response_stride(sss_ptr, period_array_sensor_response_stride(pa_ptr));
+	/* the values are those at rest until the sensor's first response */
+	period_scale_space_sensor_values(sss_ptr, &pa_ptr->scale_space_entries[pa_ptr->scale_space_sensor_count].value);
 
 	return pa_ptr->scale_space_sensor_count++;
 }
@@ -700,21 +1404,208 @@ int period_array_populate(struct period_array *pa_ptr, double octaves, double ba
 }
 
 int period_array_add_monochord(struct period_array *pa_ptr, int source_sss_descriptor, int target_sss_descriptor, double monochord_ratio) {
-	return period_scale_space_sensor_add_monochord(&pa_ptr->scale_space_entries[target_sss_descriptor].sensor, &pa_ptr->scale_space_entries[source_sss_descriptor].sensor, monochord_ratio);
+	int rc;
+
+	pa_ptr->monochord_matrix.compiled = 0;
+	rc = period_scale_space_sensor_add_monochord(&pa_ptr->scale_space_entries[target_sss_descriptor].sensor, &pa_ptr->scale_space_entries[source_sss_descriptor].sensor, monochord_ratio);
+	if (pa_ptr->response_stride > 1) {
+		/* the first monochord takes the sensors off their stride */
+		period_array_set_response_stride(pa_ptr, pa_ptr->response_stride);
+	}
+	return rc;
+}
+
+unsigned int period_array_compile_monochords(struct period_array *pa_ptr) {
+	struct period_monochord_matrix *mm_ptr = &pa_ptr->monochord_matrix;
+	struct period_scale_space_sensor *sss_ptr;
+	unsigned int source;
+	double complex value;
+	unsigned int t;
+	unsigned int j;
+	unsigned int k;
+
+	if (mm_ptr->compiled) {
+		return mm_ptr->count;
+	}
+
+	mm_ptr->count = 0;
+	for (t = 0; t < pa_ptr->scale_space_sensor_count; t++) {
+		sss_ptr = &pa_ptr->scale_space_entries[t].sensor;
+		mm_ptr->row_begin[t] = mm_ptr->count;
+
+		for (j = 0; j < sss_ptr->monochord_count; j++) {
+			source = (struct scale_space_entry *) ((char *) sss_ptr->monochords[j].source_sss_ptr - offsetof(struct scale_space_entry, sensor)) - pa_ptr->scale_space_entries;
+			value  = sss_ptr->monochords[j].monochord.value;
+
+			/* insert in order of source, so that the gathers of a row walk forward */
+			for (k = mm_ptr->count; k > mm_ptr->row_begin[t] && mm_ptr->source[k - 1] > source; k--) {
+				mm_ptr->source[k] = mm_ptr->source[k - 1];
+				mm_ptr->value[k]  = mm_ptr->value[k - 1];
+			}
+			mm_ptr->source[k] = source;
+			mm_ptr->value[k]  = value;
+			mm_ptr->count++;
+		}
+	}
+	mm_ptr->row_begin[pa_ptr->scale_space_sensor_count] = mm_ptr->count;
+	mm_ptr->compiled = 1;
+
+	return mm_ptr->count;
+}
+
+/* whether sensor `t` takes part in the superposition of `stage` */
+#define PERIOD_ARRAY_SUPERIMPOSE_ALL     0
+#define PERIOD_ARRAY_SUPERIMPOSE_CAPTURE 1
+#define PERIOD_ARRAY_SUPERIMPOSE_PERCEPT 2
+static int period_array_superimposes(struct period_scale_space_sensor *sss_ptr, int stage) {
+	switch (stage) {
+		case PERIOD_ARRAY_SUPERIMPOSE_CAPTURE:
+			return sss_ptr->response_phase == sss_ptr->response_stride - 1;
+		case PERIOD_ARRAY_SUPERIMPOSE_PERCEPT:
+			return sss_ptr->response_phase >= sss_ptr->response_stride;
+		default:
+			return 1;
+	}
+}
+
+/* add the rotated percepts (or captures) of each row's sources to the row's, all read before any is added to */
+static void period_array_superimpose(struct period_array *pa_ptr, int stage) {
+	struct period_monochord_matrix *mm_ptr = &pa_ptr->monochord_matrix;
+	struct period_scale_space_sensor *sss_ptr;
+	struct period_percept *pp_ptr;
+	double complex *sums;
+	unsigned int t;
+	unsigned int k;
+	int i;
+
+	if (pa_ptr->monochords_shed) {
+		return;
+	}
+
+	for (t = pa_ptr->scale_space_sensor_shed; t < pa_ptr->scale_space_sensor_count; t++) {
+		if (mm_ptr->row_begin[t] == mm_ptr->row_begin[t + 1] || ! period_array_superimposes(&pa_ptr->scale_space_entries[t].sensor, stage)) {
+			continue;
+		}
+		sums = &mm_ptr->sums[t * 3];
+		for (i = 0; i < 3; i++) {
+			sums[i] = 0.0;
+		}
+		for (k = mm_ptr->row_begin[t]; k < mm_ptr->row_begin[t + 1]; k++) {
+			sss_ptr = &pa_ptr->scale_space_entries[mm_ptr->source[k]].sensor;
+			for (i = 0; i < 3; i++) {
+				pp_ptr = stage == PERIOD_ARRAY_SUPERIMPOSE_CAPTURE ? &sss_ptr->period_sensors[i].capture_percept : &sss_ptr->period_sensors[i].percept;
+				sums[i] += pp_ptr->value.cval * mm_ptr->value[k];
+			}
+		}
+	}
+
+	for (t = pa_ptr->scale_space_sensor_shed; t < pa_ptr->scale_space_sensor_count; t++) {
+		sss_ptr = &pa_ptr->scale_space_entries[t].sensor;
+		if (mm_ptr->row_begin[t] == mm_ptr->row_begin[t + 1] || ! period_array_superimposes(sss_ptr, stage)) {
+			continue;
+		}
+		for (i = 0; i < 3; i++) {
+			pp_ptr = stage == PERIOD_ARRAY_SUPERIMPOSE_CAPTURE ? &sss_ptr->period_sensors[i].capture_percept : &sss_ptr->period_sensors[i].percept;
+			receptive_value_set_cval(&pp_ptr->value, pp_ptr->value.cval + mm_ptr->sums[t * 3 + i]);
+		}
+	}
+}
+
+/* `period_scale_space_sensor_sample_strided()` of every sensor, a stage at a time, superimposing the monochords between */
+static void period_array_sample_superimposed(struct period_array *pa_ptr, double time, double value) {
+	struct period_scale_space_sensor *sss_ptr;
+	int s;
+	int i;
+
+	for (s = pa_ptr->scale_space_sensor_shed; s < pa_ptr->scale_space_sensor_count; s++) {
+		sss_ptr = &pa_ptr->scale_space_entries[s].sensor;
+		for (i = 0; i < 3; i++) {
+			period_sensor_resonate(&sss_ptr->period_sensors[i], time, value);
+		}
+		sss_ptr->response_phase++;
+		if (sss_ptr->response_phase == sss_ptr->response_stride - 1) {
+			for (i = 0; i < 3; i++) {
+				period_sensor_capture(&sss_ptr->period_sensors[i], time);
+			}
+		}
+	}
+	RECEPT_PROFILE_BEGIN(capture_begin);
+	period_array_superimpose(pa_ptr, PERIOD_ARRAY_SUPERIMPOSE_CAPTURE);
+	RECEPT_PROFILE_END_WITHIN_LOCAL(capture_begin, RECEPT_PROFILE_MONOCHORDS, RECEPT_PROFILE_SENSOR);
+
+	for (s = pa_ptr->scale_space_sensor_shed; s < pa_ptr->scale_space_sensor_count; s++) {
+		sss_ptr = &pa_ptr->scale_space_entries[s].sensor;
+		if (sss_ptr->response_phase >= sss_ptr->response_stride) {
+			for (i = 0; i < 3; i++) {
+				period_sensor_perceive(&sss_ptr->period_sensors[i], time);
+			}
+		}
+	}
+	RECEPT_PROFILE_BEGIN(percept_begin);
+	period_array_superimpose(pa_ptr, PERIOD_ARRAY_SUPERIMPOSE_PERCEPT);
+	RECEPT_PROFILE_END_WITHIN_LOCAL(percept_begin, RECEPT_PROFILE_MONOCHORDS, RECEPT_PROFILE_SENSOR);
+
+	for (s = pa_ptr->scale_space_sensor_shed; s < pa_ptr->scale_space_sensor_count; s++) {
+		sss_ptr = &pa_ptr->scale_space_entries[s].sensor;
+		if (sss_ptr->response_phase >= sss_ptr->response_stride) {
+			for (i = 0; i < 3; i++) {
+				period_sensor_receive(&sss_ptr->period_sensors[i]);
+			}
+			RECEPT_PROFILE_BEGIN(lifecycle_begin);
+			period_scale_space_sensor_sample_lifecycle(sss_ptr);
+			RECEPT_PROFILE_END_WITHIN_LOCAL(lifecycle_begin, RECEPT_PROFILE_LIFECYCLE, RECEPT_PROFILE_SENSOR);
+			period_scale_space_sensor_restart_stride(sss_ptr);
+		}
+		period_scale_space_sensor_values(sss_ptr, &pa_ptr->scale_space_entries[s].value);
+	}
+}
+
+/* `period_array_sample()`, counting into the thread's own counters, for `period_array_sample_block()` to add once */
+static void period_array_sample_local(struct period_array *pa_ptr, double time, double value) {
+	int i;
+
+	RECEPT_PROFILE_BEGIN(sensor_begin);
+	if (period_array_compile_monochords(pa_ptr) > 0) {
+		period_array_sample_superimposed(pa_ptr, time, value);
+	} else {
+		for (i = pa_ptr->scale_space_sensor_shed; i < pa_ptr->scale_space_sensor_count; i++) {
+			period_scale_space_sensor_sample(&pa_ptr->scale_space_entries[i].sensor, &pa_ptr->scale_space_entries[i].value, time, value);
+		}
+	}
+	RECEPT_PROFILE_END_LOCAL(sensor_begin, RECEPT_PROFILE_SENSOR);
 }
 
 void period_array_sample(struct period_array *pa_ptr, double time, double value) {
+	period_array_sample_local(pa_ptr, time, value);
+	RECEPT_PROFILE_FLUSH();
+}
+
+/*
+ * Sensors are independent unless joined by monochords, so each sensor may run the whole block while its state is hot.
+ * Monochords read the percepts of other sensors at the same time step, so fall back to time-major order when present.
+ */
+void period_array_sample_block(struct period_array *pa_ptr, double time, const double *samples, size_t n) {
 	int i;
+	size_t j;
 
-	for (i = 0; i < pa_ptr->scale_space_sensor_count; i++) {
-		period_scale_space_sensor_sample(&pa_ptr->scale_space_entries[i].sensor, &pa_ptr->scale_space_entries[i].value, time, value);
+	if (period_array_compile_monochords(pa_ptr) == 0) {
+		RECEPT_PROFILE_BEGIN(sensor_begin);
+		for (i = pa_ptr->scale_space_sensor_shed; i < pa_ptr->scale_space_sensor_count; i++) {
+			period_scale_space_sensor_sample_block(&pa_ptr->scale_space_entries[i].sensor, &pa_ptr->scale_space_entries[i].value, time, samples, n);
+		}
+		RECEPT_PROFILE_END_LOCAL(sensor_begin, RECEPT_PROFILE_SENSOR);
+	} else {
+		for (j = 0; j < n; j++) {
+			period_array_sample_local(pa_ptr, time + j, samples[j]);
+		}
 	}
+	RECEPT_PROFILE_FLUSH();
 }
 
 void period_array_sample_sensor(struct period_array *pa_ptr, double time, double value) {
 	int i;
 
-	for (i = 0; i < pa_ptr->scale_space_sensor_count; i++) {
+	for (i = pa_ptr->scale_space_sensor_shed; i < pa_ptr->scale_space_sensor_count; i++) {
 		period_scale_space_sensor_sample_sensor(&pa_ptr->scale_space_entries[i].sensor, time, value);
 	}
 }
@@ -722,17 +1613,73 @@ void period_array_sample_sensor(struct period_array *pa_ptr, double time, double
 void period_array_sample_lifecycle(struct period_array *pa_ptr) {
 	int i;
 
-	for (i = 0; i < pa_ptr->scale_space_sensor_count; i++) {
+	for (i = pa_ptr->scale_space_sensor_shed; i < pa_ptr->scale_space_sensor_count; i++) {
 		period_scale_space_sensor_sample_lifecycle(&pa_ptr->scale_space_entries[i].sensor);
 	}
 }
 
 void period_array_sample_monochords(struct period_array *pa_ptr) {
+	struct period_monochord_matrix *mm_ptr = &pa_ptr->monochord_matrix;
+	unsigned int t;
 	int i;
 
-	for (i = 0; i < pa_ptr->scale_space_sensor_count; i++) {
-		period_scale_space_sensor_sample_monochords(&pa_ptr->scale_space_entries[i].sensor);
+	if (period_array_compile_monochords(pa_ptr) == 0 || pa_ptr->monochords_shed) {
+		return;
+	}
+
+	period_array_superimpose(pa_ptr, PERIOD_ARRAY_SUPERIMPOSE_ALL);
+	for (t = pa_ptr->scale_space_sensor_shed; t < pa_ptr->scale_space_sensor_count; t++) {
+		if (mm_ptr->row_begin[t] < mm_ptr->row_begin[t + 1]) {
+			for (i = 0; i < 3; i++) {
+				period_sensor_receive(&pa_ptr->scale_space_entries[t].sensor.period_sensors[i]);
+			}
+		}
+	}
+}
+
+void period_array_shed_sensors(struct period_array *pa_ptr, unsigned int count) {
+	struct period_scale_space_sensor *sampling_ptr;
+	unsigned int shed;
+	unsigned int held;
+
+	shed = count < pa_ptr->scale_space_sensor_count ? count : pa_ptr->scale_space_sensor_count;
+	held = pa_ptr->scale_space_sensor_shed;
+	if (shed < held) {
+		/* in step with the first sensor that kept sampling, or among themselves when none did */
+		sampling_ptr = &pa_ptr->scale_space_entries[held < pa_ptr->scale_space_sensor_count ? held : shed].sensor;
+		period_array_resume_sensors(pa_ptr, shed, held, sampling_ptr->response_stride, sampling_ptr->next_response_stride, sampling_ptr->response_phase);
 	}
+	pa_ptr->scale_space_sensor_shed = shed;
+}
+
+void period_array_resume_sensors(struct period_array *pa_ptr, unsigned int sensor_begin, unsigned int sensor_end, unsigned int response_stride, unsigned int next_response_stride, unsigned int response_phase) {
+	struct period_scale_space_sensor *sss_ptr;
+	unsigned int s;
+	int i;
+
+	if (period_array_has_monochords(pa_ptr)) {
+		response_stride      = 1;
+		next_response_stride = 0;
+	}
+	for (s = sensor_begin; s < sensor_end && s < pa_ptr->scale_space_sensor_count; s++) {
+		sss_ptr = &pa_ptr->scale_space_entries[s].sensor;
+		/* a held sensor never responded, so it missed any stride the others took since */
+		if (sss_ptr->response_stride != response_stride) {
+			period_scale_space_sensor_take_response_stride(sss_ptr, response_stride);
+		}
+		sss_ptr->next_response_stride = next_response_stride;
+		sss_ptr->response_phase       = response_phase;
+		for (i = 0; i < 3; i++) {
+			/* the first percept is its own prior, rather than one from before the sensor was held, and the averages start from the held resonator */
+			sss_ptr->period_sensors[i].has_prior_percept   = 0;
+			sss_ptr->period_sensors[i].has_capture_percept = 0;
+			period_sensor_restart_stride(&sss_ptr->period_sensors[i], response_phase);
+		}
+	}
+}
+
+void period_array_shed_monochords(struct period_array *pa_ptr, int shed) {
+	pa_ptr->monochords_shed = shed;
 }
 
 void period_array_values(struct period_array *pa_ptr) {
@@ -743,6 +1690,602 @@ void period_array_values(struct period_array *pa_ptr) {
 	}
 }
 
+/* snapshots */
+
+#define PERIOD_ARRAY_SNAPSHOT_MAGIC "RCPTSNAP"
+#define PERIOD_ARRAY_SNAPSHOT_VERSION 3 /* of the layout below: bump on any change to it */
+#define PERIOD_ARRAY_SNAPSHOT_BYTE_ORDER 0x01020304
+
+/*
+ * The header, then the state of each sensor in order, field by field, in the host's byte order: ints as int32, unsigned ints
+ * as uint32, complex values as their real then imaginary parts. Pointers, and what the array's owner configures (strides,
+ * response factors, load shedding), are not part of it.
+ */
+struct period_array_snapshot_header {
+	char     magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t sensor_count;
+	uint64_t payload_size;
+	uint64_t checksum; /* FNV-1a of the payload */
+	double   time;
+};
+#define PERIOD_ARRAY_SNAPSHOT_HEADER_SIZE (8 + 3 * 4 + 3 * 8)
+
+/* writing (or only counting, without data), checking a snapshot's shape against the array's, or reading its state into the array */
+#define PERIOD_ARRAY_SERIAL_WRITE 0
+#define PERIOD_ARRAY_SERIAL_CHECK 1
+#define PERIOD_ARRAY_SERIAL_READ  2
+
+struct period_array_serial {
+	int            mode;
+	unsigned char *data;
+	size_t         size;
+	size_t         offset;
+	int            mismatch; /* a shape field differs from the array's, or the data ran out */
+};
+
+static void period_array_serial_init(struct period_array_serial *ser_ptr, int mode, void *data, size_t size) {
+	ser_ptr->mode     = mode;
+	ser_ptr->data     = data;
+	ser_ptr->size     = size;
+	ser_ptr->offset   = 0;
+	ser_ptr->mismatch = 0;
+}
+
+/* a field of `size` bytes: a shape field must match on a check, and is left as it is on a read */
+static void period_array_serial_bytes(struct period_array_serial *ser_ptr, void *field_ptr, size_t size, int shape) {
+	if (ser_ptr->data != NULL && ser_ptr->offset + size > ser_ptr->size) {
+		ser_ptr->mismatch = 1;
+	} else if (ser_ptr->data != NULL) {
+		switch (ser_ptr->mode) {
+			case PERIOD_ARRAY_SERIAL_WRITE:
+				memcpy(ser_ptr->data + ser_ptr->offset, field_ptr, size);
+				break;
+			case PERIOD_ARRAY_SERIAL_CHECK:
+				if (shape && memcmp(ser_ptr->data + ser_ptr->offset, field_ptr, size) != 0) {
+					ser_ptr->mismatch = 1;
+				}
+				break;
+			case PERIOD_ARRAY_SERIAL_READ:
+				if ( ! shape) {
+					memcpy(field_ptr, ser_ptr->data + ser_ptr->offset, size);
+				}
+				break;
+		}
+	}
+	ser_ptr->offset += size;
+}
+
+static void period_array_serial_d(struct period_array_serial *ser_ptr, double *v_ptr) {
+	period_array_serial_bytes(ser_ptr, v_ptr, sizeof (*v_ptr), 0);
+}
+
+static void period_array_serial_dc(struct period_array_serial *ser_ptr, double complex *v_ptr) {
+	period_array_serial_bytes(ser_ptr, v_ptr, sizeof (*v_ptr), 0);
+}
+
+static void period_array_serial_int(struct period_array_serial *ser_ptr, int *v_ptr) {
+	int32_t v = *v_ptr;
+
+	period_array_serial_bytes(ser_ptr, &v, sizeof (v), 0);
+	*v_ptr = v;
+}
+
+static void period_array_serial_uint(struct period_array_serial *ser_ptr, unsigned int *v_ptr, int shape) {
+	uint32_t v = *v_ptr;
+
+	period_array_serial_bytes(ser_ptr, &v, sizeof (v), shape);
+	*v_ptr = v;
+}
+
+static void period_array_serial_header(struct period_array_serial *ser_ptr, struct period_array_snapshot_header *header_ptr) {
+	period_array_serial_bytes(ser_ptr, header_ptr->magic,         sizeof (header_ptr->magic),        0);
+	period_array_serial_bytes(ser_ptr, &header_ptr->version,      sizeof (header_ptr->version),      0);
+	period_array_serial_bytes(ser_ptr, &header_ptr->byte_order,   sizeof (header_ptr->byte_order),   0);
+	period_array_serial_bytes(ser_ptr, &header_ptr->sensor_count, sizeof (header_ptr->sensor_count), 0);
+	period_array_serial_bytes(ser_ptr, &header_ptr->payload_size, sizeof (header_ptr->payload_size), 0);
+	period_array_serial_bytes(ser_ptr, &header_ptr->checksum,     sizeof (header_ptr->checksum),     0);
+	period_array_serial_bytes(ser_ptr, &header_ptr->time,         sizeof (header_ptr->time),         0);
+}
+
+static void period_array_serial_field(struct period_array_serial *ser_ptr, struct receptive_field *field_ptr) {
+	period_array_serial_d(ser_ptr, &field_ptr->period);
+	period_array_serial_d(ser_ptr, &field_ptr->phase);
+	period_array_serial_d(ser_ptr, &field_ptr->period_factor);
+	period_array_serial_d(ser_ptr, &field_ptr->phase_factor);
+	period_array_serial_d(ser_ptr, &field_ptr->glissando);
+}
+
+static void period_array_serial_value(struct period_array_serial *ser_ptr, struct receptive_value *rv_ptr) {
+	period_array_serial_d(  ser_ptr, &rv_ptr->timestamp);
+	period_array_serial_dc( ser_ptr, &rv_ptr->cval);
+	period_array_serial_d(  ser_ptr, &rv_ptr->r);
+	period_array_serial_d(  ser_ptr, &rv_ptr->phi);
+	period_array_serial_int(ser_ptr, &rv_ptr->has_r);
+	period_array_serial_int(ser_ptr, &rv_ptr->has_phi);
+}
+
+static void period_array_serial_percept(struct period_array_serial *ser_ptr, struct period_percept *pp_ptr) {
+	period_array_serial_d(    ser_ptr, &pp_ptr->timestamp);
+	period_array_serial_field(ser_ptr, &pp_ptr->field);
+	period_array_serial_value(ser_ptr, &pp_ptr->value);
+}
+
+static void period_array_serial_sensor(struct period_array_serial *ser_ptr, struct period_sensor *ps_ptr) {
+	/* the smoother */
+	period_array_serial_field(ser_ptr, &ps_ptr->field);
+	period_array_serial_value(ser_ptr, &ps_ptr->value);
+	period_array_serial_dc(   ser_ptr, &ps_ptr->sensor_state.ts.v.v);
+	period_array_serial_d(    ser_ptr, &ps_ptr->sensor_state.period_state.v);
+	period_array_serial_d(    ser_ptr, &ps_ptr->sensor_state.glissando_state.v);
+
+	/* the percept, and its history */
+	period_array_serial_percept(ser_ptr, &ps_ptr->percept);
+	period_array_serial_int(    ser_ptr, &ps_ptr->has_prior_percept);
+	period_array_serial_percept(ser_ptr, &ps_ptr->prior_percept);
+	period_array_serial_int(    ser_ptr, &ps_ptr->has_capture_percept);
+	period_array_serial_percept(ser_ptr, &ps_ptr->capture_percept);
+
+	/* the recept */
+	period_array_serial_field(ser_ptr, &ps_ptr->recept.field);
+	period_array_serial_d(    ser_ptr, &ps_ptr->recept.frequency);
+	period_array_serial_d(    ser_ptr, &ps_ptr->recept.instant_period);
+	period_array_serial_d(    ser_ptr, &ps_ptr->recept.instant_frequency);
+	period_array_serial_value(ser_ptr, &ps_ptr->recept.value);
+	period_array_serial_d(    ser_ptr, &ps_ptr->recept.duration);
+
+	/* the concept, and its state */
+	period_array_serial_d(  ser_ptr, &ps_ptr->concept.avg_instant_period);
+	period_array_serial_d(  ser_ptr, &ps_ptr->concept.avg_instant_period_offset);
+	period_array_serial_int(ser_ptr, &ps_ptr->concept.has_instant_period_delta);
+	period_array_serial_d(  ser_ptr, &ps_ptr->concept.instant_period_delta);
+	period_array_serial_d(  ser_ptr, &ps_ptr->concept.instant_period_stddev);
+	period_array_serial_d(  ser_ptr, &ps_ptr->concept_state.avg_instant_period_state.v);
+	period_array_serial_int(ser_ptr, &ps_ptr->concept_state.instant_period_delta_state.has_prior);
+	period_array_serial_d(  ser_ptr, &ps_ptr->concept_state.instant_period_delta_state.prior_sequence);
+	period_array_serial_d(  ser_ptr, &ps_ptr->concept_state.instant_period_stddev_state.v);
+
+	/* the averages since the last response */
+	period_array_serial_d(ser_ptr, &ps_ptr->stride_period);
+	period_array_serial_d(ser_ptr, &ps_ptr->stride_r);
+}
+
+/* the counters included: `cycle` and `lifecycle` carry on from where they were */
+static void period_array_serial_lifecycle(struct period_array_serial *ser_ptr, struct lifecycle *lc_ptr) {
+	period_array_serial_d(  ser_ptr, &lc_ptr->max_r);
+	period_array_serial_d(  ser_ptr, &lc_ptr->F);
+	period_array_serial_d(  ser_ptr, &lc_ptr->r);
+	period_array_serial_d(  ser_ptr, &lc_ptr->phi);
+	period_array_serial_int(ser_ptr, &lc_ptr->cycle);
+	period_array_serial_d(  ser_ptr, &lc_ptr->lifecycle);
+	period_array_serial_dc( ser_ptr, &lc_ptr->cval);
+}
+
+static void period_array_serial_delta(struct period_array_serial *ser_ptr, struct delta_d *delta_ptr) {
+	period_array_serial_int(ser_ptr, &delta_ptr->has_prior);
+	period_array_serial_d(  ser_ptr, &delta_ptr->prior_sequence);
+}
+
+static void period_array_serial_scale_space_sensor(struct period_array_serial *ser_ptr, struct period_array *pa_ptr, struct period_scale_space_sensor *sss_ptr) {
+	struct monochord_entry *me_ptr;
+	struct monochord *mc_ptr;
+	unsigned int source;
+	unsigned int m;
+	int i;
+
+	/* the shape, which a snapshot must share with the array it restores into */
+	period_array_serial_bytes(ser_ptr, &sss_ptr->field.period, sizeof (sss_ptr->field.period), 1);
+	period_array_serial_bytes(ser_ptr, &sss_ptr->scale_factor, sizeof (sss_ptr->scale_factor), 1);
+	period_array_serial_uint( ser_ptr, &sss_ptr->monochord_count, 1);
+
+	period_array_serial_uint(ser_ptr, &sss_ptr->response_phase, 0);
+	for (i = 0; i < 3; i++) {
+		period_array_serial_sensor(ser_ptr, &sss_ptr->period_sensors[i]);
+	}
+
+	period_array_serial_lifecycle(ser_ptr, &sss_ptr->period_lifecycle.lc);
+	period_array_serial_d(        ser_ptr, &sss_ptr->period_lifecycle.d_avg_state.v);
+	period_array_serial_d(        ser_ptr, &sss_ptr->period_lifecycle.dd_avg_state.v);
+	period_array_serial_d(        ser_ptr, &sss_ptr->period_lifecycle.d);
+	period_array_serial_d(        ser_ptr, &sss_ptr->period_lifecycle.dd);
+	period_array_serial_dc(       ser_ptr, &sss_ptr->period_lifecycle.cval);
+	period_array_serial_d(        ser_ptr, &sss_ptr->period_lifecycle.d_avg);
+	period_array_serial_d(        ser_ptr, &sss_ptr->period_lifecycle.dd_avg);
+	period_array_serial_dc(       ser_ptr, &sss_ptr->period_lifecycle.cval_avg);
+
+	period_array_serial_lifecycle(ser_ptr, &sss_ptr->beat_lifecycle.lc);
+	period_array_serial_delta(    ser_ptr, &sss_ptr->beat_lifecycle.d_state);
+	period_array_serial_delta(    ser_ptr, &sss_ptr->beat_lifecycle.dd_state);
+	period_array_serial_d(        ser_ptr, &sss_ptr->beat_lifecycle.d);
+	period_array_serial_d(        ser_ptr, &sss_ptr->beat_lifecycle.dd);
+	period_array_serial_dc(       ser_ptr, &sss_ptr->beat_lifecycle.cval);
+
+	/* the monochords, by the index of their source (the shape of the matrix), and their rotations */
+	for (m = 0; m < sss_ptr->monochord_count && ! ser_ptr->mismatch; m++) {
+		me_ptr = &sss_ptr->monochords[m];
+		mc_ptr = &me_ptr->monochord;
+		source = (struct scale_space_entry *) ((char *) me_ptr->source_sss_ptr - offsetof(struct scale_space_entry, sensor)) - pa_ptr->scale_space_entries;
+		period_array_serial_uint( ser_ptr, &source, 1);
+		period_array_serial_bytes(ser_ptr, &mc_ptr->source_period, sizeof (mc_ptr->source_period), 1);
+		period_array_serial_bytes(ser_ptr, &mc_ptr->target_period, sizeof (mc_ptr->target_period), 1);
+		period_array_serial_bytes(ser_ptr, &mc_ptr->ratio,         sizeof (mc_ptr->ratio),         1);
+		period_array_serial_d(    ser_ptr, &mc_ptr->period);
+		period_array_serial_d(    ser_ptr, &mc_ptr->offset);
+		period_array_serial_d(    ser_ptr, &mc_ptr->phi_offset);
+		period_array_serial_dc(   ser_ptr, &mc_ptr->value);
+	}
+}
+
+static void period_array_serial_array(struct period_array_serial *ser_ptr, struct period_array *pa_ptr) {
+	unsigned int e;
+
+	for (e = 0; e < pa_ptr->scale_space_sensor_count && ! ser_ptr->mismatch; e++) {
+		period_array_serial_scale_space_sensor(ser_ptr, pa_ptr, &pa_ptr->scale_space_entries[e].sensor);
+	}
+}
+
+/* bytes of the array's state, following the header */
+static size_t period_array_payload_size(struct period_array *pa_ptr) {
+	struct period_array_serial ser;
+
+	period_array_serial_init(&ser, PERIOD_ARRAY_SERIAL_WRITE, NULL, 0);
+	period_array_serial_array(&ser, pa_ptr);
+
+	return ser.offset;
+}
+
+static uint64_t period_array_checksum(const void *data, size_t size) {
+	const unsigned char *p = data;
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		hash = (hash ^ p[i]) * 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+static void period_array_snapshot_header_init(struct period_array_snapshot_header *header_ptr, struct period_array *pa_ptr, size_t payload_size, double time) {
+	memset(header_ptr, 0, sizeof (*header_ptr));
+	memcpy(header_ptr->magic, PERIOD_ARRAY_SNAPSHOT_MAGIC, sizeof (header_ptr->magic));
+	header_ptr->version      = PERIOD_ARRAY_SNAPSHOT_VERSION;
+	header_ptr->byte_order   = PERIOD_ARRAY_SNAPSHOT_BYTE_ORDER;
+	header_ptr->sensor_count = pa_ptr->scale_space_sensor_count;
+	header_ptr->payload_size = payload_size;
+	header_ptr->time         = time;
+}
+
+/* the array's state into `payload`, of `size` bytes, failing with ENOBUFS when it holds more */
+static int period_array_payload_write(struct period_array *pa_ptr, void *payload, size_t size) {
+	struct period_array_serial ser;
+
+	period_array_serial_init(&ser, PERIOD_ARRAY_SERIAL_WRITE, payload, size);
+	period_array_serial_array(&ser, pa_ptr);
+	if (ser.mismatch || ser.offset != size) {
+		errno = ENOBUFS;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int period_array_write_all(int fd, const void *data, size_t size) {
+	const char *p = data;
+	ssize_t written;
+
+	while (size > 0) {
+		written = write(fd, p, size);
+		if (written == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		p    += written;
+		size -= written;
+	}
+
+	return 0;
+}
+
+/* read `size` bytes, returning how many there were before the end of the file */
+static ssize_t period_array_read_all(int fd, void *data, size_t size) {
+	char *p = data;
+	size_t total = 0;
+	ssize_t received;
+
+	while (total < size) {
+		received = read(fd, p + total, size - total);
+		if (received == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		if (received == 0) {
+			break;
+		}
+		total += received;
+	}
+
+	return total;
+}
+
+/* write the snapshot to a temporary file, synced, then rename it over `path`, so that `path` is always a whole snapshot */
+static int period_array_snapshot_write(const char *path, struct period_array_snapshot_header *header_ptr, const void *payload) {
+	unsigned char header[PERIOD_ARRAY_SNAPSHOT_HEADER_SIZE];
+	struct period_array_serial ser;
+	char *tmp_path;
+	int error = 0;
+	int fd;
+
+	header_ptr->checksum = period_array_checksum(payload, header_ptr->payload_size);
+	period_array_serial_init(&ser, PERIOD_ARRAY_SERIAL_WRITE, header, sizeof (header));
+	period_array_serial_header(&ser, header_ptr);
+
+	tmp_path = malloc(strlen(path) + sizeof (".tmp"));
+	if (tmp_path == NULL) {
+		return -1;
+	}
+	strcpy(tmp_path, path);
+	strcat(tmp_path, ".tmp");
+
+	fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd == -1) {
+		free(tmp_path);
+		return -1;
+	}
+	if (period_array_write_all(fd, header, sizeof (header)) == -1 || period_array_write_all(fd, payload, header_ptr->payload_size) == -1 ||
+		fsync(fd) == -1) {
+		error = errno;
+	}
+	if (close(fd) == -1 && error == 0) {
+		error = errno;
+	}
+	if (error == 0 && rename(tmp_path, path) == -1) {
+		error = errno;
+	}
+	if (error != 0) {
+		unlink(tmp_path);
+	}
+	free(tmp_path);
+
+	if (error != 0) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+int period_array_snapshot(struct period_array *pa_ptr, const char *path, double time) {
+	struct period_array_snapshot_header header;
+	void *payload;
+	size_t size;
+	int rc;
+
+	size = period_array_payload_size(pa_ptr);
+	payload = malloc(size);
+	if (payload == NULL) {
+		return -1;
+	}
+	period_array_snapshot_header_init(&header, pa_ptr, size, time);
+	rc = period_array_payload_write(pa_ptr, payload, size);
+	if (rc == 0) {
+		rc = period_array_snapshot_write(path, &header, payload);
+	}
+	free(payload);
+
+	return rc;
+}
+
+int period_array_restore(struct period_array *pa_ptr, const char *path, double *time_ptr) {
+	unsigned char header_data[PERIOD_ARRAY_SNAPSHOT_HEADER_SIZE];
+	struct period_array_snapshot_header header;
+	struct period_array_serial ser;
+	struct period_scale_space_sensor *sss_ptr;
+	unsigned char *payload;
+	size_t size;
+	ssize_t received;
+	unsigned int e;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		return -1;
+	}
+	received = period_array_read_all(fd, header_data, sizeof (header_data));
+	if (received == -1) {
+		close(fd);
+		return -1;
+	}
+	period_array_serial_init(&ser, PERIOD_ARRAY_SERIAL_READ, header_data, received);
+	period_array_serial_header(&ser, &header);
+	if (ser.mismatch || memcmp(header.magic, PERIOD_ARRAY_SNAPSHOT_MAGIC, sizeof (header.magic)) != 0) {
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
+	/* of another layout or host, or of an array of another shape */
+	size = period_array_payload_size(pa_ptr);
+	if (header.version != PERIOD_ARRAY_SNAPSHOT_VERSION || header.byte_order != PERIOD_ARRAY_SNAPSHOT_BYTE_ORDER ||
+		header.sensor_count != pa_ptr->scale_space_sensor_count || header.payload_size != size) {
+		close(fd);
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	/* read it aside, and check it whole, so that a bad snapshot leaves the array as it was */
+	payload = malloc(size);
+	if (payload == NULL) {
+		close(fd);
+		return -1;
+	}
+	received = period_array_read_all(fd, payload, size);
+	close(fd);
+	if (received != (ssize_t) size || period_array_checksum(payload, size) != header.checksum) {
+		free(payload);
+		errno = EINVAL;
+		return -1;
+	}
+	period_array_serial_init(&ser, PERIOD_ARRAY_SERIAL_CHECK, payload, size);
+	period_array_serial_array(&ser, pa_ptr);
+	if (ser.mismatch) {
+		free(payload);
+		errno = ENOTSUP;
+		return -1;
+	}
+
+	period_array_serial_init(&ser, PERIOD_ARRAY_SERIAL_READ, payload, size);
+	period_array_serial_array(&ser, pa_ptr);
+	free(payload);
+
+	/* the strides are the array's, not the snapshot's: the phase is taken on to the array's, as a new stride takes it */
+	for (e = 0; e < pa_ptr->scale_space_sensor_count; e++) {
+		sss_ptr = &pa_ptr->scale_space_entries[e].sensor;
+		sss_ptr->response_phase %= sss_ptr->response_stride;
+	}
+	/* the rotations are compiled again from the restored monochords */
+	pa_ptr->monochord_matrix.compiled = 0;
+
+	if (time_ptr != NULL) {
+		*time_ptr = header.time;
+	}
+
+	return 0;
+}
+
+/* struct period_array_checkpoint */
+
+static void *period_array_checkpoint_writer(void *arg) {
+	struct period_array_checkpoint *cp_ptr = arg;
+	int rc;
+
+	pthread_mutex_lock(&cp_ptr->mutex);
+	for (;;) {
+		while ( ! cp_ptr->pending && ! cp_ptr->closing) {
+			pthread_cond_wait(&cp_ptr->cond, &cp_ptr->mutex);
+		}
+		if ( ! cp_ptr->pending) {
+			break;
+		}
+		pthread_mutex_unlock(&cp_ptr->mutex);
+
+		rc = period_array_snapshot_write(cp_ptr->path, (struct period_array_snapshot_header *) cp_ptr->copy, cp_ptr->copy + sizeof (struct period_array_snapshot_header));
+
+		pthread_mutex_lock(&cp_ptr->mutex);
+		cp_ptr->error = rc == -1 ? errno : 0;
+		cp_ptr->pending = 0;
+	}
+	pthread_mutex_unlock(&cp_ptr->mutex);
+
+	return NULL;
+}
+
+int period_array_checkpoint_init(struct period_array_checkpoint *cp_ptr, struct period_array *pa_ptr, const char *path, double interval) {
+	int rc;
+
+	cp_ptr->path = strdup(path);
+	cp_ptr->copy_size = sizeof (struct period_array_snapshot_header) + period_array_payload_size(pa_ptr);
+	cp_ptr->copy = malloc(cp_ptr->copy_size);
+	if (cp_ptr->path == NULL || cp_ptr->copy == NULL) {
+		free(cp_ptr->path);
+		free(cp_ptr->copy);
+		errno = ENOMEM;
+		return -1;
+	}
+	cp_ptr->interval  = interval;
+	cp_ptr->next_time = -1.0;
+	cp_ptr->pending   = 0;
+	cp_ptr->closing   = 0;
+	cp_ptr->error     = 0;
+	cp_ptr->skipped   = 0;
+
+	pthread_mutex_init(&cp_ptr->mutex, NULL);
+	pthread_cond_init(&cp_ptr->cond, NULL);
+	rc = pthread_create(&cp_ptr->thread, NULL, period_array_checkpoint_writer, cp_ptr);
+	if (rc != 0) {
+		pthread_cond_destroy(&cp_ptr->cond);
+		pthread_mutex_destroy(&cp_ptr->mutex);
+		free(cp_ptr->path);
+		free(cp_ptr->copy);
+		errno = rc;
+		return -1;
+	}
+
+	return 0;
+}
+
+int period_array_checkpoint_sample(struct period_array_checkpoint *cp_ptr, struct period_array *pa_ptr, double time) {
+	unsigned char *copy;
+	size_t size;
+	int busy;
+
+	if (cp_ptr->next_time < 0.0) {
+		cp_ptr->next_time = time + cp_ptr->interval;
+	}
+	if (time < cp_ptr->next_time) {
+		return 0;
+	}
+
+	pthread_mutex_lock(&cp_ptr->mutex);
+	busy = cp_ptr->pending;
+	pthread_mutex_unlock(&cp_ptr->mutex);
+	if (busy) {
+		/* the sampling thread never waits on the disk: it stays due, for the next call */
+		cp_ptr->skipped++;
+		return 0;
+	}
+
+	/* a copy of the state, to be checksummed and written on the writer's time */
+	size = cp_ptr->copy_size - sizeof (struct period_array_snapshot_header);
+	if (period_array_payload_write(pa_ptr, cp_ptr->copy + sizeof (struct period_array_snapshot_header), size) == -1) {
+		/* the array's monochords have changed since: size the copy to them */
+		size = period_array_payload_size(pa_ptr);
+		copy = realloc(cp_ptr->copy, sizeof (struct period_array_snapshot_header) + size);
+		if (copy == NULL) {
+			return -1;
+		}
+		cp_ptr->copy = copy;
+		cp_ptr->copy_size = sizeof (struct period_array_snapshot_header) + size;
+		period_array_payload_write(pa_ptr, cp_ptr->copy + sizeof (struct period_array_snapshot_header), size);
+	}
+	period_array_snapshot_header_init((struct period_array_snapshot_header *) cp_ptr->copy, pa_ptr, size, time);
+	cp_ptr->next_time = time + cp_ptr->interval;
+
+	pthread_mutex_lock(&cp_ptr->mutex);
+	cp_ptr->pending = 1;
+	pthread_cond_signal(&cp_ptr->cond);
+	pthread_mutex_unlock(&cp_ptr->mutex);
+
+	return 1;
+}
+
+int period_array_checkpoint_deinit(struct period_array_checkpoint *cp_ptr) {
+	int error;
+
+	pthread_mutex_lock(&cp_ptr->mutex);
+	cp_ptr->closing = 1;
+	pthread_cond_signal(&cp_ptr->cond);
+	pthread_mutex_unlock(&cp_ptr->mutex);
+	pthread_join(cp_ptr->thread, NULL);
+	error = cp_ptr->error;
+
+	pthread_cond_destroy(&cp_ptr->cond);
+	pthread_mutex_destroy(&cp_ptr->mutex);
+	free(cp_ptr->path);
+	free(cp_ptr->copy);
+
+	if (error != 0) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
 int midi_note(double sample_rate, double period, double A4, double *n_ptr) {
 	static double n_A4 = 69;
 	double Hz;
@@ -797,24 +2340,242 @@ int note(double sample_rate, double period, double A4, int *octave_ptr, char **n
 	return 0;
 }
 
+
+/* struct recept_profile */
+
+#ifdef RECEPT_PROFILE
+_Atomic uint64_t recept_profile_ticks[RECEPT_PROFILE_STAGE_COUNT];
+_Thread_local uint64_t recept_profile_local_ticks[RECEPT_PROFILE_STAGE_COUNT];
+
+void recept_profile_flush(void) {
+	unsigned int stage;
+
+	for (stage = 0; stage < RECEPT_PROFILE_STAGE_COUNT; stage++) {
+		if (recept_profile_local_ticks[stage] != 0) {
+			atomic_fetch_add_explicit(&recept_profile_ticks[stage], recept_profile_local_ticks[stage], memory_order_relaxed);
+			recept_profile_local_ticks[stage] = 0;
+		}
+	}
+}
+#endif
+
+static const char *recept_profile_stage_names[RECEPT_PROFILE_STAGE_COUNT] = {
+	"read",
+	"decimate",
+	"sensor",
+	"monochords",
+	"lifecycle",
+	"draw",
+};
+
+const char *recept_profile_stage_name(unsigned int stage) {
+	return stage < RECEPT_PROFILE_STAGE_COUNT ? recept_profile_stage_names[stage] : NULL;
+}
+
+static double recept_profile_clock(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void recept_profile_init(struct recept_profile *profile_ptr, double frame_rate) {
+	profile_ptr->frame_rate  = frame_rate;
+	profile_ptr->frame_count = 0;
+	profile_ptr->frame_time  = 0.0;
+	profile_ptr->lag         = 0.0;
+	profile_ptr->leak        = 0.0;
+}
+
+void recept_profile_frame(struct recept_profile *profile_ptr, double sample_time) {
+	double now;
+	double lag;
+#ifdef RECEPT_PROFILE
+	uint64_t now_ticks;
+	uint64_t ticks;
+	double ticks_per_second;
+	double frame_seconds;
+	unsigned int stage;
+#endif
+
+	now = recept_profile_clock();
+#ifdef RECEPT_PROFILE
+	now_ticks = recept_profile_now();
+	/* the sensors sampled on this thread since their last block */
+	recept_profile_flush();
+#endif
+	if (profile_ptr->frame_count == 0) {
+		/* the wall clock starts with the samples of the first frame */
+		profile_ptr->start_time = now - sample_time;
+#ifdef RECEPT_PROFILE
+		profile_ptr->start_ticks      = now_ticks;
+		profile_ptr->start_ticks_time = sample_time;
+		for (stage = 0; stage < RECEPT_PROFILE_STAGE_COUNT; stage++) {
+			profile_ptr->stage_ticks[stage] = atomic_load_explicit(&recept_profile_ticks[stage], memory_order_relaxed);
+			profile_ptr->share[stage] = 0.0;
+		}
+		profile_ptr->other = 0.0;
+#endif
+	}
+	now -= profile_ptr->start_time;
+
+	/* as in recept.py, the leak is smoothed over a second of frames */
+	lag = now - sample_time;
+	if (profile_ptr->frame_count > 0) {
+		profile_ptr->leak += (lag - profile_ptr->lag - profile_ptr->leak) / profile_ptr->frame_rate;
+	}
+	profile_ptr->lag = lag;
+
+#ifdef RECEPT_PROFILE
+	frame_seconds = now - profile_ptr->frame_time;
+	if (profile_ptr->frame_count > 0 && frame_seconds > 0.0) {
+		/* ticks of the TSC are timed against the monotonic clock over the whole run */
+		ticks_per_second = (now_ticks - profile_ptr->start_ticks) / (now - profile_ptr->start_ticks_time);
+		profile_ptr->other = 1.0;
+		for (stage = 0; stage < RECEPT_PROFILE_STAGE_COUNT; stage++) {
+			ticks = atomic_load_explicit(&recept_profile_ticks[stage], memory_order_relaxed);
+			profile_ptr->share[stage] = (int64_t) (ticks - profile_ptr->stage_ticks[stage]) / ticks_per_second / frame_seconds;
+			profile_ptr->stage_ticks[stage] = ticks;
+			profile_ptr->other -= profile_ptr->share[stage];
+		}
+	}
+#endif
+	profile_ptr->frame_time = now;
+	profile_ptr->frame_count++;
+}
+
+int recept_profile_in_sync(struct recept_profile *profile_ptr) {
+	return fabs(profile_ptr->leak) < RECEPT_PROFILE_SYNC;
+}
+
+/* struct recept_shed */
+
+void recept_shed_init(struct recept_shed *shed_ptr) {
+	unsigned int action;
+
+	for (action = 0; action < RECEPT_SHED_ACTION_COUNT; action++) {
+		shed_ptr->limit[action] = 0;
+		shed_ptr->steps[action] = 0;
+	}
+	shed_ptr->lag_floor = 0.0;
+	shed_ptr->step_time = 0.0;
+	shed_ptr->restored  = 0;
+	shed_ptr->recover   = RECEPT_SHED_RECOVER;
+	shed_ptr->frame     = 0;
+}
+
+void recept_shed_set_limit(struct recept_shed *shed_ptr, unsigned int action, unsigned int steps) {
+	shed_ptr->limit[action] = steps;
+}
+
+int recept_shed_update(struct recept_shed *shed_ptr, struct recept_profile *profile_ptr) {
+	double behind;
+	int action;
+
+	if (profile_ptr->frame_count <= 1 || profile_ptr->lag < shed_ptr->lag_floor) {
+		shed_ptr->lag_floor = profile_ptr->lag;
+	}
+	if (profile_ptr->frame_time - shed_ptr->step_time < RECEPT_SHED_HOLD) {
+		return -1;
+	}
+	behind = profile_ptr->lag - shed_ptr->lag_floor;
+
+	/* falling behind, and not catching up */
+	if (behind > RECEPT_SHED_BEHIND && profile_ptr->leak > -RECEPT_PROFILE_SYNC) {
+		for (action = 0; action < RECEPT_SHED_ACTION_COUNT; action++) {
+			if (shed_ptr->steps[action] < shed_ptr->limit[action]) {
+				shed_ptr->steps[action]++;
+				shed_ptr->step_time = profile_ptr->frame_time;
+				if (shed_ptr->restored && shed_ptr->recover < RECEPT_SHED_RECOVER_MAX) {
+					shed_ptr->recover *= 2;
+				}
+				shed_ptr->restored = 0;
+				return action;
+			}
+		}
+		return -1;
+	}
+
+	/* caught up, and keeping up */
+	if (behind < RECEPT_SHED_BEHIND / 2 && recept_profile_in_sync(profile_ptr) && profile_ptr->frame_time - shed_ptr->step_time >= shed_ptr->recover) {
+		for (action = RECEPT_SHED_ACTION_COUNT - 1; action >= 0; action--) {
+			if (shed_ptr->steps[action] > 0) {
+				shed_ptr->steps[action]--;
+				shed_ptr->step_time = profile_ptr->frame_time;
+				shed_ptr->restored = 1;
+				return action;
+			}
+		}
+	}
+
+	return -1;
+}
+
+int recept_shed_draw(struct recept_shed *shed_ptr) {
+	return (shed_ptr->frame++ & ((1u << shed_ptr->steps[RECEPT_SHED_FRAMES]) - 1)) == 0;
+}
+
+void recept_shed_describe(struct recept_shed *shed_ptr, char *buf, size_t size) {
+	size_t n;
+
+	if (size == 0) {
+		return;
+	}
+	buf[0] = '\0';
+	n = 0;
+	if (shed_ptr->steps[RECEPT_SHED_FRAMES] > 0 && n < size) {
+		n += snprintf(&buf[n], size - n, "ui/%u ", 1u << shed_ptr->steps[RECEPT_SHED_FRAMES]);
+	}
+	if (shed_ptr->steps[RECEPT_SHED_RESPONSES] > 0 && n < size) {
+		n += snprintf(&buf[n], size - n, "r*%u ", 1u << shed_ptr->steps[RECEPT_SHED_RESPONSES]);
+	}
+	if (shed_ptr->steps[RECEPT_SHED_MONOCHORDS] > 0 && n < size) {
+		n += snprintf(&buf[n], size - n, "mc ");
+	}
+	if (shed_ptr->steps[RECEPT_SHED_SENSORS] > 0 && n < size) {
+		n += snprintf(&buf[n], size - n, "-%uoct ", shed_ptr->steps[RECEPT_SHED_SENSORS]);
+	}
+	if (n == 0) {
+		snprintf(buf, size, "none");
+	} else if (n <= size) {
+		buf[n - 1] = '\0';
+	}
+}
+
 #ifdef RECEPT_TEST
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 
 #include "bar.h"
+#include "bank.h"
+#include "bank_pool.h"
+#include "multirate.h"
 #include "sampler_ui.h"
 
 int main(int argc, char *argv[]) {
 	int rc;
 
 	struct sampler_ui sampler_ui;
+	struct recept_profile profile;
+	struct recept_shed shed;
+	int shed_action;
+	unsigned int shed_octaves;
+	char shed_text[32];
 	int row;
 	int rows;
 	int columns;
-	double sample_value;
 	double sample_time;
 	int    sample_count;
+	ssize_t slice_count;
+	size_t  slice;
+	int    channel_count;
+	int    display_channel;
+	double *block; /* frames of channel_count samples */
+	size_t block_size;
+	size_t block_count;
+	double block_time;
 	wchar_t *rowbuf;
 	union bar_u *c1_rows;
 	union bar_u *c2_rows;
@@ -822,15 +2583,40 @@ int main(int argc, char *argv[]) {
 	union bar_u *c4_rows;
 	union bar_u *phase_rows;
 	struct receptive_field *field_ptr;
-	struct period_array array;
+	struct period_array *array_ptr;
+	int array_flags;
+	struct period_bank bank;
+	int bank_mode;
+	const char *bank_kernel;
+	struct period_bank_pool bank_pool;
+	int bank_threads;
+	int response_decimation;
+	struct period_octave_array octave_array;
+	int multirate;
 	struct scale_space_entry *scale_space_entries;
 	struct scale_space_entry *entry_ptr;
+	struct scale_space_entry **row_entries; /* the sensor of each row, across the octaves in multirate */
+	double *row_sample_rates;
+	int row_count;
 	double cycle_area;
 	int field_count;
 	int octave_bandwidth;
 	double octave_count;
 	double period_response_Hz;
 	int starting_note;
+	const char *snapshot_path;
+	double checkpoint_seconds;
+	int shedding;
+	double capture_seconds;
+	char snapshot_file[4096];
+	double snapshot_time;
+	double time_offset; /* of a warm restart */
+	struct period_array *snapshot_arrays[PERIOD_OCTAVE_MAX];
+	struct period_bank *snapshot_banks[PERIOD_OCTAVE_MAX];
+	struct period_array_checkpoint checkpoints[PERIOD_OCTAVE_MAX];
+	unsigned int snapshot_count;
+	unsigned int snapshot;
+	int restored;
 
 	rc = sampler_ui_getopts(&sampler_ui, argc, argv);
 	if (rc == -1) {
@@ -874,34 +2660,229 @@ int main(int argc, char *argv[]) {
 		perror("calloc");
 		return -1;
 	}
+	channel_count = sampler_ui_get_sample_channels(&sampler_ui);
+	block_size = sampler_ui_get_sample_rate(&sampler_ui) / sampler_ui_get_fps(&sampler_ui);
+	recept_profile_init(&profile, sampler_ui_get_fps(&sampler_ui));
+	block = calloc(block_size * channel_count, sizeof (*block));
+	if (block == NULL) {
+		perror("calloc");
+		return -1;
+	}
 
 	/* BEGIN CONFIG */
 	period_response_Hz = 60.0; /* averages results at this rate, for smoothing */
 	field_count = 24; /* number of receptor fields */
 	octave_bandwidth = 12; /* how many receptor fields per octave */
 	starting_note = -9 -12; /* where 0 is A=440 */
+	bank_mode = 1; /* run the sensors in a structure-of-arrays bank, storing back to the array only to draw */
+	bank_kernel = NULL; /* "scalar", "sse2", "avx2", "avx512", their single-precision "sse2_f", "avx2_f", "avx512_f", or NULL for the fastest double kernel */
+	bank_threads = 1; /* threads sampling the bank's sensor blocks, this one included, or 0 for one per CPU */
+	response_decimation = 1; /* evaluate the percepts once per response period, averaging every sample into the concepts and lifecycles, see receptlib.h */
+	multirate = 0; /* run each octave of sensors at its lowest sample rate, through a half-band decimation ladder: only sensors whose skirts its filters pass leave the input rate, some 15 Hz and below, see multirate.h */
+	array_flags = 0; /* PERIOD_ARRAY_HUGE_PAGES backs large arrays by huge pages */
+	display_channel = 0; /* the channel drawn, of interleaved input with -n channels */
+	snapshot_path = NULL; /* resume from the sensors' snapshot here, if any, and checkpoint them to it (a file per octave in multirate) */
+	checkpoint_seconds = 10.0; /* between checkpoints */
+	shedding = 1; /* when falling behind the input, skip frames, respond less often, drop monochords, then hold the highest sensors still, see profile.h */
+	capture_seconds = 4.0; /* of input held between a thread reading it and the sensors, so that a slow frame does not stall the input, or 0 to read it inline */
 	/* END CONFIG */
 
+	if (capture_seconds > 0) {
+		rc = filesampler_start_capture(sampler_ui_get_sampler(&sampler_ui), capture_seconds * sampler_ui_get_sample_rate(&sampler_ui));
+		if (rc == -1) {
+			perror("filesampler_start_capture");
+		}
+	}
+
+	if (channel_count > 1) {
+		/* the channels share one bank at the input rate, a sensor per channel in each vector */
+		multirate = 0;
+		bank_mode = 1;
+		/* a snapshot holds the array's sensors, which are one channel's: restored, it would copy that channel into all */
+		if (snapshot_path != NULL) {
+			fprintf(stderr, "snapshots are of one channel, neither restoring nor checkpointing %d channels\n", channel_count);
+			snapshot_path = NULL;
+		}
+	}
+	if (display_channel >= channel_count) {
+		display_channel = channel_count - 1;
+	}
+
 	/* constants */
 	octave_count = ((double) field_count) / octave_bandwidth; /* derived from config */
 	cycle_area = 1.0 / (1.0 - exp(-1.0)); /* the area under the curve of the exponential distribution, part of power calibration */
 	
-	field_ptr = period_array_get_receptive_field(&array);
+	if (bank_mode) {
+		rc = period_bank_pool_init(&bank_pool, bank_threads);
+		if (rc == -1) {
+			perror("period_bank_pool_init");
+			return -1;
+		}
+	}
+	if (multirate) {
+		field_ptr = period_octave_array_get_receptive_field(&octave_array);
+	} else {
+		array_ptr = period_array_create(field_count + 1, 0, array_flags);
+		if (array_ptr == NULL) {
+			perror("period_array_create");
+			return -1;
+		}
+		field_ptr = period_array_get_receptive_field(array_ptr);
+	}
 	field_ptr->period = sampler_ui_get_sample_rate(&sampler_ui) / (440 * pow(2, (((double) starting_note)/12)) );
 	field_ptr->phase = 0.0;
 	field_ptr->phase_factor = cycle_area;
-	period_array_init(&array, sampler_ui_get_sample_rate(&sampler_ui) / period_response_Hz, octave_bandwidth, cycle_area);
-	rc = period_array_populate(&array, octave_count, 1.0);
-	scale_space_entries = period_array_get_entries(&array);
+	if (multirate) {
+		period_octave_array_init(&octave_array, sampler_ui_get_sample_rate(&sampler_ui) / period_response_Hz, octave_bandwidth, cycle_area, PERIOD_OCTAVE_MIN_PERIOD, field_count + 1, array_flags);
+		rc = period_octave_array_populate(&octave_array, octave_count, 1.0);
+		if (rc == -1) {
+			perror("period_octave_array_populate");
+			return -1;
+		}
+		if (response_decimation) {
+			period_octave_array_set_response_stride(&octave_array, (unsigned int) octave_array.response_period);
+		}
+		if (bank_mode) {
+			rc = period_octave_array_init_banks(&octave_array, bank_kernel);
+			if (rc == -1) {
+				perror("period_octave_array_init_banks");
+				return -1;
+			}
+			period_octave_array_set_pool(&octave_array, &bank_pool);
+		}
+	} else {
+		period_array_init(array_ptr, sampler_ui_get_sample_rate(&sampler_ui) / period_response_Hz, octave_bandwidth, cycle_area);
+		rc = period_array_populate(array_ptr, octave_count, 1.0);
+		if (response_decimation) {
+			period_array_set_response_stride(array_ptr, (unsigned int) array_ptr->response_period);
+		}
+		if (bank_mode) {
+			rc = period_bank_init_channels(&bank, array_ptr, channel_count);
+			if (rc == -1) {
+				perror("period_bank_init_channels");
+				return -1;
+			}
+			rc = period_bank_set_kernel(&bank, bank_kernel);
+			if (rc == -1) {
+				perror("period_bank_set_kernel");
+				return -1;
+			}
+		}
+	}
+
+	/* shed load when the sensors fall behind the input, rather than let the input overflow */
+	recept_shed_init(&shed);
+	if (shedding) {
+		shed_octaves = 0;
+		if (multirate) {
+			unsigned int o;
+
+			for (o = 0; o < period_octave_array_octave_count(&octave_array); o++) {
+				shed_octaves += octave_array.octaves[o].pa_ptr != NULL;
+			}
+		} else {
+			shed_octaves = (period_array_period_sensor_count(array_ptr) + octave_bandwidth - 1) / octave_bandwidth;
+			recept_shed_set_limit(&shed, RECEPT_SHED_MONOCHORDS, period_array_compile_monochords(array_ptr) > 0);
+		}
+		recept_shed_set_limit(&shed, RECEPT_SHED_FRAMES, 2);
+		recept_shed_set_limit(&shed, RECEPT_SHED_RESPONSES, 2);
+		recept_shed_set_limit(&shed, RECEPT_SHED_SENSORS, shed_octaves > 0 ? shed_octaves - 1 : 0);
+	}
+
+	/* warm restart: restore the sensors as last checkpointed, and carry on at the time they left off */
+	time_offset = 0.0;
+	snapshot_count = 0;
+	restored = 0;
+	if (snapshot_path != NULL) {
+		if (multirate) {
+			unsigned int o;
+
+			for (o = 0; o < period_octave_array_octave_count(&octave_array); o++) {
+				if (octave_array.octaves[o].pa_ptr == NULL) {
+					continue;
+				}
+				snapshot_arrays[snapshot_count] = octave_array.octaves[o].pa_ptr;
+				snapshot_banks[snapshot_count]  = octave_array.octaves[o].bank_ptr;
+				snapshot_count++;
+			}
+		} else {
+			snapshot_arrays[0] = array_ptr;
+			snapshot_banks[0]  = bank_mode ? &bank : NULL;
+			snapshot_count = 1;
+		}
+		for (snapshot = 0; snapshot < snapshot_count; snapshot++) {
+			if (multirate) {
+				snprintf(snapshot_file, sizeof (snapshot_file), "%s.%u", snapshot_path, snapshot);
+			} else {
+				snprintf(snapshot_file, sizeof (snapshot_file), "%s", snapshot_path);
+			}
+			rc = period_array_restore(snapshot_arrays[snapshot], snapshot_file, &snapshot_time);
+			if (rc == 0) {
+				if (snapshot_banks[snapshot] != NULL) {
+					period_bank_load(snapshot_banks[snapshot]);
+				}
+				time_offset = snapshot_time - 1; /* sample counts start at 1 */
+				restored = 1;
+			} else if (errno != ENOENT) {
+				perror("period_array_restore");
+				return -1;
+			}
+			rc = period_array_checkpoint_init(&checkpoints[snapshot], snapshot_arrays[snapshot], snapshot_file, checkpoint_seconds * sampler_ui_get_sample_rate(&sampler_ui));
+			if (rc == -1) {
+				perror("period_array_checkpoint_init");
+				return -1;
+			}
+		}
+		if (multirate && restored) {
+			/* the snapshots hold the octaves, not the ladder feeding them */
+			fprintf(stderr, "restored octaves with empty decimators: the input fades in over %u samples\n", period_octave_array_latency(&octave_array));
+		}
+	}
+
+	/* rows in order of period, which the octaves keep, up to the screen's */
+	row_entries = calloc(rows, sizeof (*row_entries));
+	if (row_entries == NULL) {
+		perror("calloc");
+		return -1;
+	}
+	row_sample_rates = calloc(rows, sizeof (*row_sample_rates));
+	if (row_sample_rates == NULL) {
+		perror("calloc");
+		return -1;
+	}
+	row_count = 0;
+	if (multirate) {
+		struct period_array *pa_ptr;
+		unsigned int decimation;
+		unsigned int o;
+		int i;
+
+		for (o = 0; o < period_octave_array_octave_count(&octave_array); o++) {
+			pa_ptr = period_octave_array_get_octave(&octave_array, o, &decimation);
+			if (pa_ptr == NULL) {
+				continue;
+			}
+			scale_space_entries = period_array_get_entries(pa_ptr);
+			for (i = 0; i < period_array_period_sensor_count(pa_ptr) && row_count < rows - 1; i++) {
+				row_entries[row_count] = &scale_space_entries[i];
+				row_sample_rates[row_count] = sampler_ui_get_sample_rate(&sampler_ui) / decimation;
+				row_count++;
+			}
+		}
+	} else {
+		scale_space_entries = period_array_get_entries(array_ptr);
+		for (row_count = 0; row_count < period_array_period_sensor_count(array_ptr) && row_count < rows - 1; row_count++) {
+			row_entries[row_count] = &scale_space_entries[row_count];
+			row_sample_rates[row_count] = sampler_ui_get_sample_rate(&sampler_ui);
+		}
+	}
 	screen_nprintf(sampler_ui_get_screen(&sampler_ui), 0,                           0, 20, '\0', L"%ls", L"-\u03C4/2 Tonal Phase \u03C4/2");
 	screen_nprintf(sampler_ui_get_screen(&sampler_ui), 20,                          0, 22, '\0', L"%s", " Sensor <note> Sensed ");
 	screen_nprintf(sampler_ui_get_screen(&sampler_ui), 20 + 11 + 11,                0, 20, '\0', L"%s", "| Receptor Model    ");
 	screen_nprintf(sampler_ui_get_screen(&sampler_ui), 20 + 11 + 11 + 20,           0, 20, '\0', L"%s", "   log(Entropy+1)   ");
 	screen_nprintf(sampler_ui_get_screen(&sampler_ui), 20 + 11 + 11 + 20 + 20,      0, 20, '\0', L"%s", "  - log(Energy+1)   ");
 	screen_nprintf(sampler_ui_get_screen(&sampler_ui), 20 + 11 + 11 + 20 + 20 + 20, 0, 20, '\0', L"%s", " log(Free Energy+1) ");
-	for (row = 0; row < period_array_period_sensor_count(&array); row++) {
-		entry_ptr = &scale_space_entries[row];
-
+	for (row = 0; row < row_count; row++) {
 		screen_nprintf(sampler_ui_get_screen(&sampler_ui),      0, row + 1, 1, '\0', L"%ls", L"\u03D5");
 		rowbuf = screen_pos(sampler_ui_get_screen(&sampler_ui), 1, row + 1);
 		bar_init_buf(&phase_rows[row], bar_signed, bar_linear, rowbuf, 19);
@@ -923,27 +2904,92 @@ int main(int argc, char *argv[]) {
 
 	}
 	for (;;) {
+		RECEPT_PROFILE_BEGIN(read_begin);
+		block_count = 0;
 		do {
-			rc = filesampler_demand_next(sampler_ui_get_sampler(&sampler_ui), &sample_value);
-			if (rc == -1) {
-				perror("sampler_ui_demand_next");
-				return -1;
-			}
-			sample_time  = filesampler_get_sample_time( sampler_ui_get_sampler(&sampler_ui));
-			sample_count = filesampler_get_sample_count(sampler_ui_get_sampler(&sampler_ui));
-		} while (rc == 0);
+			/* as many frames as are ready, up to the block or the next draw */
+			do {
+				sample_count = filesampler_get_sample_count(sampler_ui_get_sampler(&sampler_ui));
+				slice_count = filesampler_demand_block(sampler_ui_get_sampler(&sampler_ui), &block[block_count * channel_count], block_size - block_count);
+				if (slice_count == -1) {
+					perror("filesampler_demand_block");
+					return -1;
+				}
+			} while (slice_count == 0);
+			sample_time = filesampler_get_sample_time(sampler_ui_get_sampler(&sampler_ui));
 
-		period_array_sample(&array, (double) sample_count, sample_value * 10000);
+			if (block_count == 0) {
+				block_time = time_offset + sample_count + 1;
+			}
+			for (slice = 0; slice < slice_count * channel_count; slice++) {
+				block[block_count * channel_count + slice] *= 10000;
+			}
+			block_count += slice_count;
+		} while (block_count < block_size && ! filesampler_check_draw(sampler_ui_get_sampler(&sampler_ui)));
+		RECEPT_PROFILE_END(read_begin, RECEPT_PROFILE_READ);
+
+		if (multirate) {
+			period_octave_array_sample_block(&octave_array, block_time, block, block_count);
+		} else if (bank_mode) {
+			period_bank_pool_sample_block(&bank_pool, &bank, block_time, block, block_count);
+		} else {
+			period_array_sample_block(array_ptr, block_time, block, block_count);
+		}
 
 		if (filesampler_check_draw(sampler_ui_get_sampler(&sampler_ui))) {
 			int octave;
 			char *note_name;
 			double cents;
+			unsigned int stage;
 
+			RECEPT_PROFILE_BEGIN(draw_begin);
 			filesampler_mark_draw(sampler_ui_get_sampler(&sampler_ui));
 
-			for (row = 0; row < period_array_period_sensor_count(&array); row++) {
-				entry_ptr = &scale_space_entries[row];
+			/* whether the sensors keep up with the input, shedding load if not */
+			recept_profile_frame(&profile, sample_time);
+			shed_action = recept_shed_update(&shed, &profile);
+			if (shed_action == RECEPT_SHED_RESPONSES) {
+				unsigned int response_stride;
+
+				/* each sensor takes it from its next response, so its concepts and lifecycles still average every sample */
+				response_stride = (response_decimation ? (unsigned int) (sampler_ui_get_sample_rate(&sampler_ui) / period_response_Hz) : 1) << shed.steps[RECEPT_SHED_RESPONSES];
+				if (multirate) {
+					period_octave_array_set_response_stride(&octave_array, response_stride);
+				} else if (bank_mode) {
+					period_bank_set_response_stride(&bank, response_stride);
+				} else {
+					period_array_set_response_stride(array_ptr, response_stride);
+				}
+			} else if (shed_action == RECEPT_SHED_MONOCHORDS) {
+				if (bank_mode) {
+					period_bank_shed_monochords(&bank, shed.steps[RECEPT_SHED_MONOCHORDS]);
+				} else {
+					period_array_shed_monochords(array_ptr, shed.steps[RECEPT_SHED_MONOCHORDS]);
+				}
+			} else if (shed_action == RECEPT_SHED_SENSORS) {
+				if (multirate) {
+					period_octave_array_shed_octaves(&octave_array, shed.steps[RECEPT_SHED_SENSORS]);
+				} else if (bank_mode) {
+					period_bank_shed_sensors(&bank, shed.steps[RECEPT_SHED_SENSORS] * octave_bandwidth);
+				} else {
+					period_array_shed_sensors(array_ptr, shed.steps[RECEPT_SHED_SENSORS] * octave_bandwidth);
+				}
+			}
+			if (multirate) {
+				period_octave_array_store(&octave_array);
+			} else if (bank_mode) {
+				period_bank_store_channel(&bank, display_channel);
+			}
+			for (snapshot = 0; snapshot < snapshot_count; snapshot++) {
+				period_array_checkpoint_sample(&checkpoints[snapshot], snapshot_arrays[snapshot], block_time + block_count);
+			}
+			if ( ! recept_shed_draw(&shed)) {
+				RECEPT_PROFILE_END(draw_begin, RECEPT_PROFILE_DRAW);
+				continue;
+			}
+
+			for (row = 0; row < row_count; row++) {
+				entry_ptr = row_entries[row];
 				int rc;
 				struct period_concept *concept_ptr;
 				struct lifecycle *lc_ptr;
@@ -954,23 +3000,23 @@ int main(int argc, char *argv[]) {
 				// pc      = cabs(CMPLX(cimag(lc_ptr->cval) < 0.0  ? -cimag(lc_ptr->cval) : 0.0, lc_ptr->F < 0.0 ? lc_ptr->F : 0.0));
 				pc      = cimag(lc_ptr->cval) < 0.0 ? cabs(CMPLX(cimag(lc_ptr->cval), lc_ptr->F)) : 0;
 
-				rc = note(sampler_ui_get_sample_rate(&sampler_ui), concept_ptr->recept_ptr->field.period, 440.0, &octave, &note_name, &cents);
+				rc = note(row_sample_rates[row], concept_ptr->recept_ptr->field.period, 440.0, &octave, &note_name, &cents);
 				if (rc == 0) {
 					screen_nprintf(sampler_ui_get_screen(&sampler_ui), 20, row + 1, 11, '\0', NOTE_FMT, octave, note_name, cents);
 				}
 				if (pc == 0.0) {
 					screen_nprintf(sampler_ui_get_screen(&sampler_ui), 20 + 11, row + 1, 11, '\0', L"%ls", L"           ");
 				} else {
-					rc = note(sampler_ui_get_sample_rate(&sampler_ui), concept_ptr->avg_instant_period, 440.0, &octave, &note_name, &cents);
+					rc = note(row_sample_rates[row], concept_ptr->avg_instant_period, 440.0, &octave, &note_name, &cents);
 					if (rc == 0) {
 						screen_nprintf(sampler_ui_get_screen(&sampler_ui), 20 + 11, row + 1, 11, '\0', NOTE_FMT, octave, note_name, cents);
 					}
 				}
 				bar_set(&phase_rows[row], lc_ptr->phi, 0.5); /* Phase */
 				/*
-				bar_set(&c1_rows[row],   entry_ptr->sensor.period_sensors[0].percept.value.r, concept_ptr->recept_ptr->field.period);
-				bar_set(&c2_rows[row],   entry_ptr->sensor.period_sensors[1].percept.value.r, concept_ptr->recept_ptr->field.period);
-				bar_set(&c3_rows[row],   entry_ptr->sensor.period_sensors[2].percept.value.r, concept_ptr->recept_ptr->field.period);
+				bar_set(&c1_rows[row],   receptive_value_get_r(&entry_ptr->sensor.period_sensors[0].percept.value), concept_ptr->recept_ptr->field.period);
+				bar_set(&c2_rows[row],   receptive_value_get_r(&entry_ptr->sensor.period_sensors[1].percept.value), concept_ptr->recept_ptr->field.period);
+				bar_set(&c3_rows[row],   receptive_value_get_r(&entry_ptr->sensor.period_sensors[2].percept.value), concept_ptr->recept_ptr->field.period);
 				*/
 				bar_set(&c1_rows[row],   pc * 100,              lc_ptr->max_r * 10000); /*      Force */
 				bar_set(&c2_rows[row],   creal(lc_ptr->cval),   lc_ptr->max_r);         /*      Entropy */
@@ -983,7 +3029,30 @@ int main(int argc, char *argv[]) {
 				screen_nprintf(sampler_ui_get_screen(&sampler_ui), columns - 20, 0, 20, '\0', L"Nyquist: " NOTE_FMT, octave, note_name, cents);
 			}
 			screen_nprintf(sampler_ui_get_screen(&sampler_ui), columns - 20, 1, 20, '\0', L"time: %f", sample_time);
+
+			/* whether the sensors keep up with the input, what is shed to, and where the time goes */
+			screen_nprintf(sampler_ui_get_screen(&sampler_ui), columns - 20, 2, 20, '\0', L"lag:%+9.3fs %-4s", profile.lag, recept_profile_in_sync(&profile) ? "good" : "bad");
+			screen_nprintf(sampler_ui_get_screen(&sampler_ui), columns - 20, 3, 20, '\0', L"leak:%+9.5f", profile.leak);
+			recept_shed_describe(&shed, shed_text, sizeof (shed_text));
+			screen_nprintf(sampler_ui_get_screen(&sampler_ui), columns - 20, 4, 20, '\0', L"shed: %-14s", shed_text);
+			if (filesampler_capture_capacity(sampler_ui_get_sampler(&sampler_ui)) > 0) {
+				screen_nprintf(sampler_ui_get_screen(&sampler_ui), columns - 20, 5, 20, '\0', L"ring:%5.1f%% drop %-4zu",
+						100.0 * filesampler_capture_occupancy(sampler_ui_get_sampler(&sampler_ui)) / filesampler_capture_capacity(sampler_ui_get_sampler(&sampler_ui)),
+						filesampler_capture_overruns(sampler_ui_get_sampler(&sampler_ui)));
+			}
+			row = 6;
+#ifdef RECEPT_PROFILE
+			for (stage = 0; stage < RECEPT_PROFILE_STAGE_COUNT && row < rows; stage++, row++) {
+				screen_nprintf(sampler_ui_get_screen(&sampler_ui), columns - 20, row, 20, '\0', L"%-10s %6.2f%%", recept_profile_stage_name(stage), profile.share[stage] * 100);
+			}
+			if (row < rows) {
+				screen_nprintf(sampler_ui_get_screen(&sampler_ui), columns - 20, row, 20, '\0', L"%-10s %6.2f%%", "other", profile.other * 100);
+			}
+#else
+			(void) stage;
+#endif
 			screen_draw(sampler_ui_get_screen(&sampler_ui));
+			RECEPT_PROFILE_END(draw_begin, RECEPT_PROFILE_DRAW);
 		}
 	}
 
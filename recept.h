@@ -1,6 +1,8 @@
 #ifndef RECEPT_H
 #define RECEPT_H
 
+#include <pthread.h>
+
 #include "receptlib.h"
 
 struct exponential_smoother_d {
@@ -9,6 +11,12 @@ struct exponential_smoother_d {
 struct exponential_smoother_dc {
 	double complex v;
 };
+struct exponential_smoother_f {
+	float v;
+};
+struct exponential_smoother_fc {
+	float complex v;
+};
 
 struct exponential_smoothing_d {
 	struct exponential_smoother_d v;
@@ -18,6 +26,14 @@ struct exponential_smoothing_dc {
 	struct exponential_smoother_dc v;
 	double w;
 };
+struct exponential_smoothing_f {
+	struct exponential_smoother_f v;
+	float w;
+};
+struct exponential_smoothing_fc {
+	struct exponential_smoother_fc v;
+	float w;
+};
 
 struct delta_d {
 	int has_prior;
@@ -27,6 +43,14 @@ struct delta_dc {
 	int has_prior;
 	double complex prior_sequence;
 };
+struct delta_f {
+	int has_prior;
+	float prior_sequence;
+};
+struct delta_fc {
+	int has_prior;
+	float complex prior_sequence;
+};
 
 struct distribution_d {
 	struct exponential_smoother_d ave;
@@ -36,6 +60,14 @@ struct distribution_dc {
 	struct exponential_smoother_dc ave;
 	struct exponential_smoother_dc dev;
 };
+struct distribution_f {
+	struct exponential_smoother_f ave;
+	struct exponential_smoother_f dev;
+};
+struct distribution_fc {
+	struct exponential_smoother_fc ave;
+	struct exponential_smoother_fc dev;
+};
 
 struct weighted_distribution_d {
 	struct distribution_d dist;
@@ -45,6 +77,14 @@ struct weighted_distribution_dc {
 	struct distribution_dc dist;
 	double w;
 };
+struct weighted_distribution_f {
+	struct distribution_f dist;
+	float w;
+};
+struct weighted_distribution_fc {
+	struct distribution_fc dist;
+	float w;
+};
 
 struct apex_d {
 	struct delta_d delta;
@@ -54,12 +94,25 @@ struct apex_dc {
 	struct delta_dc delta;
 	int prior_is_positive;
 };
+struct apex_f {
+	struct delta_f delta;
+	int prior_is_positive;
+};
+struct apex_fc {
+	struct delta_fc delta;
+	int prior_is_positive;
+};
 
 struct dynamic_window_d {
 	double td;
 	struct delta_d s;
 	struct exponential_smoothing_d ed;
 };
+struct dynamic_window_f {
+	float td;
+	struct delta_d s;
+	struct exponential_smoothing_f ed;
+};
 
 struct smooth_duration_d {
 	struct dynamic_window_d dw;
@@ -69,6 +122,14 @@ struct smooth_duration_dc {
 	struct dynamic_window_d dw;
 	struct exponential_smoother_dc v;
 };
+struct smooth_duration_f {
+	struct dynamic_window_f dw;
+	struct exponential_smoother_f v;
+};
+struct smooth_duration_fc {
+	struct dynamic_window_f dw;
+	struct exponential_smoother_fc v;
+};
 
 struct smooth_duration_distribution_d {
 	struct dynamic_window_d dw;
@@ -78,12 +139,25 @@ struct smooth_duration_distribution_dc {
 	struct dynamic_window_d dw;
 	struct distribution_dc v;
 };
+struct smooth_duration_distribution_f {
+	struct dynamic_window_f dw;
+	struct distribution_f v;
+};
+struct smooth_duration_distribution_fc {
+	struct dynamic_window_f dw;
+	struct distribution_fc v;
+};
 
 struct time_smoothing_d {
 	struct receptive_field *field_ptr;
 	struct receptive_value *value_ptr;
 	struct exponential_smoother_dc v;
 };
+struct time_smoothing_f {
+	struct receptive_field   *field_ptr;
+	struct receptive_value_f *value_ptr;
+	struct exponential_smoother_fc v;
+};
 
 struct dynamic_time_smoothing_d {
 	struct time_smoothing_d ts;
@@ -106,6 +180,7 @@ struct period_concept_state {
 	struct exponential_smoother_d avg_instant_period_state;
 	struct delta_d                instant_period_delta_state;
 	struct exponential_smoother_d instant_period_stddev_state;
+	unsigned int                  response_stride;
 };
 
 struct period_sensor {
@@ -116,6 +191,12 @@ struct period_sensor {
 	struct period_percept percept;
 	int                   has_prior_percept;
 	struct period_percept prior_percept;
+	int                   has_capture_percept;
+	struct period_percept capture_percept; /* the prior percept of the next strided response */
+	/* with a response stride, the averages of every sample since the last response, see `period_sensor_accumulate()` */
+	double stride_period;   /* the instant period, smoothed as the concept's average */
+	double stride_r;        /* the resonator's magnitude, smoothed as the period lifecycle, on `stride_r_factor` */
+	double stride_r_factor;
 	struct period_recept  recept;
 	struct period_concept concept;
 	struct period_concept_state concept_state;
@@ -147,20 +228,26 @@ struct lifecycle_iter {
 };
 
 struct period_scale_space_sensor;
+struct monochord_entry {
+	struct period_scale_space_sensor *source_sss_ptr;
+	struct monochord       monochord;
+};
+
 struct period_scale_space_sensor {
 	struct receptive_field field;
 	double response_period;
 	double scale_factor;
+	unsigned int response_stride;
+	unsigned int next_response_stride; /* set within a stride: taken at the next response, or 0 */
+	unsigned int response_phase; /* samples since the last response */
 
 	struct period_sensor period_sensors[3];
 
 	struct lifecycle_derive period_lifecycle;
 	struct lifecycle_iter   beat_lifecycle;
 
-	struct monochord_entry {
-		struct period_scale_space_sensor *source_sss_ptr;
-		struct monochord       monochord;
-	} monochords[256];
+	struct monochord_entry *monochords; /* `monochord_capacity` entries, owned by the array */
+	unsigned int     monochord_capacity;
 	unsigned int     monochord_count;
 };
 
@@ -168,6 +255,7 @@ struct period_array {
 	struct receptive_field field;
 	double response_period;
 	double scale_factor;
+	unsigned int response_stride;
 
 	double octave_bandwidth;
 	double period_bandwidth;
@@ -175,11 +263,45 @@ struct period_array {
 	struct scale_space_entry {
 		struct period_scale_space_sensor sensor;
 		struct scale_space_value         value;
-	} scale_space_entries[127];
+	} *scale_space_entries; /* `scale_space_sensor_capacity` entries, in the arena */
 
 	unsigned int scale_space_sensor_count;
+	unsigned int scale_space_sensor_capacity;
+	unsigned int monochord_capacity; /* per sensor */
+
+	/* load shed, see `period_array_shed_sensors()`: not part of a snapshot */
+	unsigned int scale_space_sensor_shed; /* the first sensors, held still */
+	int          monochords_shed;
+
+	/* the monochords of all entries, in compressed rows of target by source, see `period_array_compile_monochords()` */
+	struct period_monochord_matrix {
+		unsigned int   *row_begin; /* capacity + 1, the entries of row `t` are [row_begin[t], row_begin[t + 1]) */
+		unsigned int   *source;
+		double complex *value;     /* the monochord rotations */
+		double complex *sums;      /* 3 per row, one per scale */
+		unsigned int    count;
+		int             compiled;
+	} monochord_matrix;
+
+	/* holds this struct, its entries, and each entry's monochords */
+	void  *arena;
+	size_t arena_size;
+	int    arena_mapped; /* by mmap(), rather than posix_memalign() */
+};
 
-	
+struct period_array_checkpoint {
+	char  *path;
+	double interval;
+	double next_time;
+	unsigned char *copy; /* a snapshot header, then the array's state */
+	size_t copy_size;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t  cond;
+	int pending; /* the copy is being written */
+	int closing;
+	int error;   /* errno of the last write, or 0 */
+	unsigned int skipped; /* checkpoints put off while the writer was busy */
 };
 
 
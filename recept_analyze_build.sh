@@ -0,0 +1,3 @@
+#!/bin/sh
+cc -g -Ofast -Wall -DRECEPT_ANALYZE analyze.c recept.c bank.c sampler.c trace.c $@ -lm -pthread -o ./recept_analyze
+cc -g -Ofast -Wall -DRECEPT_TRACE trace.c recept.c bank.c $@ -lm -pthread -o ./recept_trace
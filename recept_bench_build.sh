@@ -0,0 +1,3 @@
+#!/bin/sh
+cc -g -Ofast -Wall -DRECEPT_BENCH bench.c recept.c bank.c bank_pool.c multirate.c $@ -lm -pthread -o ./recept_bench
+cc -g -Ofast -Wall -DRECEPT_ACCURACY accuracy.c bench.c recept.c bank.c bank_pool.c multirate.c $@ -lm -pthread -o ./recept_accuracy
@@ -1,4 +1,4 @@
 #!/bin/sh
-cc -g -Ofast -Wall -DRECEPT_TEST bar.c screen.c sampler.c sampler_ui.c recept.c $@ -o ./recept_test
+cc -g -Ofast -Wall -DRECEPT_TEST bar.c screen.c sampler.c sampler_ui.c recept.c bank.c bank_pool.c multirate.c $@ -pthread -o ./recept_test
 emcc  -O3 \
-             -Wall -DRECEPT_TEST bar.c screen.c sampler.c sampler_ui.c recept.c $@ -o ./recept_test.html
+             -Wall -DRECEPT_TEST bar.c screen.c sampler.c sampler_ui.c recept.c bank.c bank_pool.c multirate.c $@ -o ./recept_test.html
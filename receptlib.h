@@ -1,18 +1,42 @@
 #ifndef RECEPTLIB_H
 #define RECEPTLIB_H
 
+#include <stddef.h>
 #include <complex.h>
 
 double complex delta_dc(double complex cval, double complex prior_cval);
+float complex delta_fc(float complex cval, float complex prior_cval);
+
+/*
+ * Single precision: the `_f` (float) and `_fc` (float complex) families mirror `_d` and `_dc`, for twice the SIMD width
+ * and half the memory per sensor. Times, periods and phases stay double (`struct receptive_field`, timestamps and
+ * sequence values), as a float sample count stops resolving single samples after 2^24 (about 6 minutes at 44.1kHz).
+ *
+ * Precision loss grows with the window: a smoother moves by `(value - v) / factor` per sample, so each update keeps
+ * fewer of float's 24 bits as the factor grows. After 10 minutes at 44.1kHz, a time smoothing is off its double
+ * counterpart by about 1e-6 (relative) at a window of 80 samples, 2e-6 at 800 and 7e-6 at 8000. The long windows are
+ * the low-note sensors (window = period * period_factor). Anything derived from phase differences between samples,
+ * such as a recept's instant period, amplifies this, so keep low-note sensors in double when they track glissando.
+ */
 
 /* exponential smoothing (double) */
 struct exponential_smoother_d;
 void exponential_smoother_d_init(struct exponential_smoother_d *es_d_ptr, double initial_value);
 double exponential_smoother_d_sample(struct exponential_smoother_d *es_d_ptr, double value, double factor);
+/* the factor that smooths as much when sampled once every `stride` samples as `factor` does every sample */
+double exponential_smoother_d_stride_factor(double factor, unsigned int stride);
 /* exponential smoothing (double complex) */
 struct exponential_smoother_dc;
 void exponential_smoother_dc_init(struct exponential_smoother_dc *es_d_ptr, double complex initial_value);
 double complex exponential_smoother_dc_sample(struct exponential_smoother_dc *es_d_ptr, double complex value, double factor);
+/* exponential smoothing (float) */
+struct exponential_smoother_f;
+void exponential_smoother_f_init(struct exponential_smoother_f *es_f_ptr, float initial_value);
+float exponential_smoother_f_sample(struct exponential_smoother_f *es_f_ptr, float value, float factor);
+/* exponential smoothing (float complex) */
+struct exponential_smoother_fc;
+void exponential_smoother_fc_init(struct exponential_smoother_fc *es_fc_ptr, float complex initial_value);
+float complex exponential_smoother_fc_sample(struct exponential_smoother_fc *es_fc_ptr, float complex value, float factor);
 
 /* exponential smoothing (double) of a fixed window size */
 struct exponential_smoothing_d;
@@ -22,6 +46,14 @@ double exponential_smoothing_d_sample(struct exponential_smoothing_d *esg_d_ptr,
 struct exponential_smoothing_dc;
 void exponential_smoothing_dc_init(struct exponential_smoothing_dc *esg_dc_ptr, double window_size, double complex initial_value);
 double exponential_smoothing_dc_sample(struct exponential_smoothing_dc *esg_dc_ptr, double complex value);
+/* exponential smoothing (float) of a fixed window size */
+struct exponential_smoothing_f;
+void exponential_smoothing_f_init(struct exponential_smoothing_f *esg_f_ptr, float window_size, float initial_value);
+float exponential_smoothing_f_sample(struct exponential_smoothing_f *esg_f_ptr, float value);
+/* exponential smoothing (float complex) of a fixed window size */
+struct exponential_smoothing_fc;
+void exponential_smoothing_fc_init(struct exponential_smoothing_fc *esg_fc_ptr, float window_size, float complex initial_value);
+float complex exponential_smoothing_fc_sample(struct exponential_smoothing_fc *esg_fc_ptr, float complex value);
 
 /* derivative of a sequence of (double) */
 struct delta_d;
@@ -31,6 +63,14 @@ int delta_d_sample(struct delta_d *d_d_ptr, double sequence_value, double *delta
 struct delta_dc;
 void delta_dc_init(struct delta_dc *d_dc_ptr, int has_prior, double complex prior_sequence);
 int delta_dc_sample(struct delta_dc *d_dc_ptr, double complex sequence_value, double complex *delta_value_ptr);
+/* derivative of a sequence of (float) */
+struct delta_f;
+void delta_f_init(struct delta_f *d_f_ptr, int has_prior, float prior_sequence);
+int delta_f_sample(struct delta_f *d_f_ptr, float sequence_value, float *delta_value_ptr);
+/* derivative of a sequence of (float complex) */
+struct delta_fc;
+void delta_fc_init(struct delta_fc *d_fc_ptr, int has_prior, float complex prior_sequence);
+int delta_fc_sample(struct delta_fc *d_fc_ptr, float complex sequence_value, float complex *delta_value_ptr);
 
 /* Infinite Impulse Response (IIR) distribution, represented by exponentially smoothed average and deviation (double). */
 struct distribution_d;
@@ -40,6 +80,14 @@ void distribution_d_sample(struct distribution_d *dist_d_ptr, double value, doub
 struct distribution_dc;
 void distribution_dc_init(struct distribution_dc *dist_dc_ptr, double complex initial_value);
 void distribution_dc_sample(struct distribution_dc *dist_dc_ptr, double complex value, double factor, double complex *ave_ptr, double complex *dev_ptr);
+/* Infinite Impulse Response (IIR) distribution, represented by exponentially smoothed average and deviation (float). */
+struct distribution_f;
+void distribution_f_init(struct distribution_f *dist_f_ptr, float initial_value);
+void distribution_f_sample(struct distribution_f *dist_f_ptr, float value, float factor, float *ave_ptr, float *dev_ptr);
+/* Infinite Impulse Response (IIR) distribution, represented by exponentially smoothed average and deviation (float complex). */
+struct distribution_fc;
+void distribution_fc_init(struct distribution_fc *dist_fc_ptr, float complex initial_value);
+void distribution_fc_sample(struct distribution_fc *dist_fc_ptr, float complex value, float factor, float complex *ave_ptr, float complex *dev_ptr);
 
 /* Infinite Impulse Response (IIR) distribution, represented by exponentially smoothed average and deviation, (double) with pre-defined window size. */
 struct weighted_distribution_d;
@@ -49,6 +97,14 @@ void weighted_distribution_d_sample(struct weighted_distribution_d *wdist_d_ptr,
 struct weighted_distribution_dc;
 void weighted_distribution_dc_init(struct weighted_distribution_dc *wdist_dc_ptr, double complex initial_value, double window_size);
 void weighted_distribution_dc_sample(struct weighted_distribution_dc *wdist_dc_ptr, double complex value, double complex *ave_ptr, double complex *dev_ptr);
+/* Infinite Impulse Response (IIR) distribution, represented by exponentially smoothed average and deviation, (float) with pre-defined window size. */
+struct weighted_distribution_f;
+void weighted_distribution_f_init(struct weighted_distribution_f *wdist_f_ptr, float initial_value, float window_size);
+void weighted_distribution_f_sample(struct weighted_distribution_f *wdist_f_ptr, float value, float *ave_ptr, float *dev_ptr);
+/* Infinite Impulse Response (IIR) distribution, represented by exponentially smoothed average and deviation, (float complex) with pre-defined window size. */
+struct weighted_distribution_fc;
+void weighted_distribution_fc_init(struct weighted_distribution_fc *wdist_fc_ptr, float complex initial_value, float window_size);
+void weighted_distribution_fc_sample(struct weighted_distribution_fc *wdist_fc_ptr, float complex value, float complex *ave_ptr, float complex *dev_ptr);
 
 
 /* Returns the given (double) sample if it is changing direction. That is, return on the derivative changing sign. */
@@ -59,6 +115,14 @@ int apex_d_sample(struct apex_d *ax_d_ptr, double sequence_value, double *delta_
 struct apex_dc;
 void apex_dc_init(struct apex_dc *ax_dc_ptr, int has_prior, double complex prior_sequence);
 int apex_dc_sample(struct apex_dc *ax_dc_ptr, double complex sequence_value, double complex *delta_value_ptr);
+/* Returns the given (float) sample if it is changing direction. That is, return on the derivative changing sign. */
+struct apex_f;
+void apex_f_init(struct apex_f *ax_f_ptr, int has_prior, float prior_sequence);
+int apex_f_sample(struct apex_f *ax_f_ptr, float sequence_value, float *delta_value_ptr);
+/* Returns the given (float complex) sample if it is changing direction. That is, return on the derivative changing sign. */
+struct apex_fc;
+void apex_fc_init(struct apex_fc *ax_fc_ptr, int has_prior, float complex prior_sequence);
+int apex_fc_sample(struct apex_fc *ax_fc_ptr, float complex sequence_value, float complex *delta_value_ptr);
 
 /* Provide a dynamically-adjusted (double) window size for a particular duration, by a given time sequence. */
 struct dynamic_window_d;
@@ -66,6 +130,10 @@ struct dynamic_window_d;
 void dynamic_window_d_init(struct dynamic_window_d *dw_d_ptr, double target_duration, double window_size, int has_prior, double prior_value, double initial_duration);
 /* Provide the next sequence value, and get an updated time window targeting the initialized duration. */
 double dynamic_window_d_sample(struct dynamic_window_d *dw_d_ptr, double sequence_value);
+/* Provide a dynamically-adjusted (float) window size for a particular duration, by a given (double) time sequence. */
+struct dynamic_window_f;
+void dynamic_window_f_init(struct dynamic_window_f *dw_f_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration);
+float dynamic_window_f_sample(struct dynamic_window_f *dw_f_ptr, double sequence_value);
 
 /* a (double) expential smoother windowed by a (double) dynamic window */
 struct smooth_duration_d;
@@ -75,6 +143,14 @@ void smooth_duration_d_init(struct smooth_duration_d *sd_d_ptr, double target_du
 struct smooth_duration_dc;
 void smooth_duration_dc_init(struct smooth_duration_dc *sd_dc_ptr, double target_duration, double window_size, int has_prior, double prior_value, double initial_duration, double complex initial_value);
 
+/* a (float) expential smoother windowed by a (float) dynamic window */
+struct smooth_duration_f;
+void smooth_duration_f_init(struct smooth_duration_f *sd_f_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration, float initial_value);
+
+/* a (float complex) expential smoother windowed by a (float) dynamic window */
+struct smooth_duration_fc;
+void smooth_duration_fc_init(struct smooth_duration_fc *sd_fc_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration, float complex initial_value);
+
 /* a (double) expential smoothed distribition windowed by a (double) dynamic window */
 struct smooth_duration_distribution_d;
 void smooth_duration_distribution_d_init(struct smooth_duration_distribution_d *sdd_d_ptr, double target_duration, double window_size, int has_prior, double prior_value, double initial_duration, double initial_value);
@@ -83,6 +159,14 @@ void smooth_duration_distribution_d_sample(struct smooth_duration_distribution_d
 struct smooth_duration_distribution_dc;
 void smooth_duration_distribution_dc_init(struct smooth_duration_distribution_dc *sdd_dc_ptr, double target_duration, double window_size, int has_prior, double prior_value, double initial_duration, double complex initial_value);
 void smooth_duration_distribution_dc_sample(struct smooth_duration_distribution_dc *sdd_dc_ptr, double complex value, double sequence_value, double complex *ave_ptr, double complex *dev_ptr);
+/* a (float) expential smoothed distribition windowed by a (float) dynamic window */
+struct smooth_duration_distribution_f;
+void smooth_duration_distribution_f_init(struct smooth_duration_distribution_f *sdd_f_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration, float initial_value);
+void smooth_duration_distribution_f_sample(struct smooth_duration_distribution_f *sdd_f_ptr, float value, double sequence_value, float *ave_ptr, float *dev_ptr);
+/* a (float complex) expential smoothed distribition windowed by a (float) dynamic window */
+struct smooth_duration_distribution_fc;
+void smooth_duration_distribution_fc_init(struct smooth_duration_distribution_fc *sdd_fc_ptr, float target_duration, float window_size, int has_prior, double prior_value, float initial_duration, float complex initial_value);
+void smooth_duration_distribution_fc_sample(struct smooth_duration_distribution_fc *sdd_fc_ptr, float complex value, double sequence_value, float complex *ave_ptr, float complex *dev_ptr);
 
 /* Infinite Impulse Response cosine transform */
 
@@ -95,21 +179,53 @@ struct receptive_field {
 	double glissando;
 };
 
-/* percept's periodic value (Z-transform, frequency domain value, representing the state of the receptive field) */
+/*
+ * percept's periodic value (Z-transform, frequency domain value, representing the state of the receptive field)
+ *
+ * `cval` is the canonical state. `r` and `phi` are only current when `has_r`/`has_phi` say so:
+ * samplers set `cval` with `receptive_value_set_cval()`, or with `receptive_value_set_polar()` from a polar form, which
+ * stays current, and readers get the polar form on demand.
+ */
 struct receptive_value {
 	double timestamp;
 	double complex cval;
 	double r;
 	double phi;
+	int    has_r;
+	int    has_phi;
 };
 
 void receptive_value_init(struct receptive_value *rv_ptr, double complex cval);
+void receptive_value_set_cval(struct receptive_value *rv_ptr, double complex cval);
+double receptive_value_get_r(struct receptive_value *rv_ptr);
+double receptive_value_get_phi(struct receptive_value *rv_ptr);
 void receptive_value_polar(struct receptive_value *rv_ptr);
-void receptive_value_rect(struct receptive_value *rv_ptr);
+void receptive_value_set_polar(struct receptive_value *rv_ptr, double r, double phi);
+
+/* single-precision (float) receptive value, of a double receptive field */
+struct receptive_value_f {
+	double timestamp;
+	float complex cval;
+	float r;
+	float phi;
+	int   has_r;
+	int   has_phi;
+};
+
+void receptive_value_f_init(struct receptive_value_f *rv_f_ptr, float complex cval);
+void receptive_value_f_set_cval(struct receptive_value_f *rv_f_ptr, float complex cval);
+float receptive_value_f_get_r(struct receptive_value_f *rv_f_ptr);
+float receptive_value_f_get_phi(struct receptive_value_f *rv_f_ptr);
+void receptive_value_f_polar(struct receptive_value_f *rv_f_ptr);
+void receptive_value_f_set_polar(struct receptive_value_f *rv_f_ptr, float r, float phi);
 
 struct time_smoothing_d;
 void time_smoothing_d_init(struct time_smoothing_d *ts_d_ptr, struct receptive_field *field_ptr, struct receptive_value *value_ptr);
 void time_smoothing_d_sample(struct time_smoothing_d *ts_d_ptr, double time, double value);
+/* time smoothing in single precision (float), where only the phase within a period narrows to float */
+struct time_smoothing_f;
+void time_smoothing_f_init(struct time_smoothing_f *ts_f_ptr, struct receptive_field *field_ptr, struct receptive_value_f *value_ptr);
+void time_smoothing_f_sample(struct time_smoothing_f *ts_f_ptr, double time, float value);
 
 /* time smoothing, but with mutable period component, tracking period delta, or the "glissando receptor factor". */
 struct dynamic_time_smoothing_d;
@@ -152,11 +268,15 @@ struct period_recept {
 	double duration;
 };
 void period_recept_init(struct period_recept *pr_ptr, struct period_percept *phase, struct period_percept *prior_phase);
+/* take the instant period from elsewhere than the two percepts, as an average over a response stride */
+void period_recept_set_instant_period(struct period_recept *pr_ptr, double instant_period);
 
 /* Psychological Concept: Persistence of Periodic Value */
 /* IIR filter state (memory/persistence) */
 struct period_concept_state;
 void period_concept_state_init(struct period_concept_state *pcs_ptr, struct receptive_field *field_ptr);
+/* sample the concept once every `response_stride` samples, compensating its smoothing */
+void period_concept_state_set_response_stride(struct period_concept_state *pcs_ptr, unsigned int response_stride);
 /* representation of the concept */
 struct period_concept {
 	struct period_recept *recept_ptr;
@@ -178,6 +298,19 @@ struct receptive_value *period_sensor_get_receptive_value(struct period_sensor *
 struct period_concept *period_sensor_get_concept(struct period_sensor *ps_ptr);
 void period_sensor_init(struct period_sensor *ps_ptr);
 void period_sensor_receive(struct period_sensor *ps_ptr);
+/* period_sensor_sample() is period_sensor_resonate(), period_sensor_perceive() and period_sensor_receive() */
+void period_sensor_resonate(struct period_sensor *ps_ptr, double time, double value);
+void period_sensor_perceive(struct period_sensor *ps_ptr, double time);
+/* take the percept to be the prior of the next period_sensor_perceive(), on the sample before a strided response */
+void period_sensor_capture(struct period_sensor *ps_ptr, double time);
+/*
+ * With a response stride, period_sensor_resonate() adds the sample's instant period, from the phase advance since `prior_cval`,
+ * and the resonator's magnitude into averages over the samples since the last response, which the response takes in place of
+ * the percepts': the instant period smoothed as the concept's average, and the magnitude as the period lifecycle.
+ * Restarting them `response_phase` samples into a stride takes the sensor to have held its concept and magnitude since the last response.
+ */
+void period_sensor_accumulate(struct period_sensor *ps_ptr, double complex prior_cval);
+void period_sensor_restart_stride(struct period_sensor *ps_ptr, unsigned int response_phase);
 void period_sensor_sample(struct period_sensor *ps_ptr, double time, double value);
 void period_sensor_update_period(struct period_sensor *ps_ptr, double period);
 void period_sensor_update_phase(struct period_sensor *ps_ptr, double phase);
@@ -199,6 +332,21 @@ struct lifecycle;
 void lifecycle_init(struct lifecycle *lc_ptr, double max_r);
 double lifecycle_sample(struct lifecycle *lc_ptr, double complex cval);
 
+/* Complex Lifecycle/Frequency (float), where `lifecycle` resolves phase to 2^-(23 - log2(cycle)) of a cycle */
+struct lifecycle_f {
+	float max_r;
+	float F;
+	float r;
+	float phi;
+	int   cycle;
+	float lifecycle;
+
+	float complex cval;
+};
+
+void lifecycle_f_init(struct lifecycle_f *lc_f_ptr, float max_r);
+float lifecycle_f_sample(struct lifecycle_f *lc_f_ptr, float complex cval);
+
 struct lifecycle_derive;
 void lifecycle_derive_init(struct lifecycle_derive *lcd_ptr, double max_r, double response_factor);
 double lifecycle_derive_sample_direct(struct lifecycle_derive *lcd_ptr, double v1, double v2, double v3);
@@ -221,27 +369,113 @@ struct receptive_field *period_scale_space_sensor_get_receptive_field(struct per
 void period_scale_space_sensor_set_response_period(struct period_scale_space_sensor *sss_ptr, double response_period);
 void period_scale_space_sensor_set_scale_factor(struct period_scale_space_sensor *sss_ptr, double scale_factor);
 void period_scale_space_sensor_init(struct period_scale_space_sensor *sss_ptr);
+/*
+ * Response stride: with a stride N > 1, only the resonators advance every sample, and the percepts, recepts, concepts and lifecycles
+ * are evaluated once every N samples, N samples after the last response, with their smoothing compensated for the lower rate.
+ * Until the first response the sensor holds the concept of its field at rest.
+ * Set after `period_scale_space_sensor_init()`; set again within a stride, the new stride starts at the next response, which
+ * still takes the averages over the old one.
+ *
+ * The concepts and the period lifecycle are exact all the same: every sample's instant period and magnitude is averaged as
+ * they would be on a stride of 1 (see `period_sensor_accumulate()`), and the response takes the averages, so that a strided
+ * sensor's concepts and lifecycles match those of a stride of 1 on the same samples to rounding.
+ * Only the percepts and recepts themselves are those of the response's sample.
+ * Monochords superimpose their sources on every sample, which no average stands in for: an array with monochords responds on
+ * every sample, whatever its stride (see `period_array_set_response_stride()`).
+ */
+void period_scale_space_sensor_set_response_stride(struct period_scale_space_sensor *sss_ptr, unsigned int response_stride);
 void period_scale_space_sensor_sample_sensor(struct period_scale_space_sensor *sss_ptr, double time, double value);
 void period_scale_space_sensor_sample_monochords(struct period_scale_space_sensor *sss_ptr);
 void period_scale_space_sensor_sample_lifecycle(struct period_scale_space_sensor *sss_ptr);
+void period_scale_space_sensor_sample_strided(struct period_scale_space_sensor *sss_ptr, double time, double value);
 void period_scale_space_sensor_values(struct period_scale_space_sensor *sss_ptr, struct scale_space_value *ss_value);
 void period_scale_space_sensor_sample(struct period_scale_space_sensor *sss_ptr, struct scale_space_value *ss_value, double time, double value);
+/* sample a block of `n` samples, where `samples[i]` is at `time + i` */
+void period_scale_space_sensor_sample_block(struct period_scale_space_sensor *sss_ptr, struct scale_space_value *ss_value, double time, const double *samples, size_t n);
 void period_scale_space_sensor_init_monochord(struct period_scale_space_sensor *sss_ptr, struct monochord *mc_ptr, struct period_scale_space_sensor *target_sss_ptr, double monochord_ratio);
+void period_scale_space_sensor_superimpose_monochord_captures_on(struct period_scale_space_sensor *sss_ptr, struct period_scale_space_sensor *target_sss_ptr, struct monochord *mc_ptr);
+void period_scale_space_sensor_superimpose_monochord_percepts_on(struct period_scale_space_sensor *sss_ptr, struct period_scale_space_sensor *target_sss_ptr, struct monochord *mc_ptr);
 void period_scale_space_sensor_superimpose_monochord_on(struct period_scale_space_sensor *sss_ptr, struct period_scale_space_sensor *target_sss_ptr, struct monochord *mc_ptr);
 int  period_scale_space_sensor_add_monochord(struct period_scale_space_sensor *sss_ptr, struct period_scale_space_sensor *source_sss_ptr, double monochord_ratio);
 
 struct period_array;
+/* back the arena by huge pages: explicit ones (MAP_HUGETLB) where reserved, else transparent ones where enabled */
+#define PERIOD_ARRAY_HUGE_PAGES 0x1
+/*
+ * allocate an array for up to `capacity` sensors of up to `monochord_capacity` monochords each, in one aligned arena,
+ * returning NULL with errno set on failure; `period_array_init()` it next, and free it with `period_array_destroy()`
+ */
+struct period_array *period_array_create(unsigned int capacity, unsigned int monochord_capacity, int flags);
+void period_array_destroy(struct period_array *pa_ptr);
 struct receptive_field *period_array_get_receptive_field(struct period_array *pa_ptr);
 void period_array_init(struct period_array *pa_ptr, double response_period, double octave_bandwidth, double scale_factor);
+/*
+ * evaluate responses once every `response_stride` samples (see above), typically the response period, from each sensor's next
+ * response; 1 evaluates every sample, as do the sensors of an array with monochords
+ */
+void period_array_set_response_stride(struct period_array *pa_ptr, unsigned int response_stride);
 unsigned int period_array_period_sensor_max(struct period_array *pa_ptr);
 unsigned int period_array_period_sensor_count(struct period_array *pa_ptr);
 struct scale_space_entry *period_array_get_entries(struct period_array *pa_ptr);
 int period_array_add_period_sensor(struct period_array *pa_ptr, double period, double bandwidth_factor);
+/* add a sensor per 1 / octave_bandwidth octave, from `octaves` octaves below the field's period up to it */
+int period_array_populate(struct period_array *pa_ptr, double octaves, double bandwidth_factor);
 int period_array_add_monochord(struct period_array *pa_ptr, int source_sss_descriptor, int target_sss_descriptor, double monochord_ratio);
+/*
+ * Compile the monochords added to the array into one sparse matrix, each row's sources in ascending order, returning their count.
+ * Sampling compiles on demand.
+ *
+ * The array superimposes all monochords at once: each responding sensor perceives, adds the rotated percepts of its sources
+ * as perceived at that sample, before any superposition, and then receives once (unlike `period_scale_space_sensor_sample_monochords()`,
+ * which superimposes and receives per monochord, in sensor order). Captures superimpose the same way.
+ */
+unsigned int period_array_compile_monochords(struct period_array *pa_ptr);
 void period_array_sample(struct period_array *pa_ptr, double time, double value);
+/* sample a block of `n` samples, where `samples[i]` is at `time + i`, with results identical to calling `period_array_sample()` per sample */
+void period_array_sample_block(struct period_array *pa_ptr, double time, const double *samples, size_t n);
 void period_array_sample_sensor(struct period_array *pa_ptr, double time, double value);
 void period_array_sample_lifecycle(struct period_array *pa_ptr);
+/* superimpose the compiled monochords on the percepts of their targets, and receive those again */
 void period_array_sample_monochords(struct period_array *pa_ptr);
 void period_array_values(struct period_array *pa_ptr);
+/*
+ * Load shedding, each undone by shedding 0: hold the first `count` sensors still, the shortest periods as populated, keeping
+ * their last values, or sample without superimposing the monochords. A sensor taken up again resumes its resonators from where
+ * they were held, in step with the sensors that kept sampling, and its percepts start over, so that its first recept spans no
+ * more than a response; a held sensor's percepts still reach its monochords' targets as they were, so monochords are best shed first.
+ */
+void period_array_shed_sensors(struct period_array *pa_ptr, unsigned int count);
+void period_array_shed_monochords(struct period_array *pa_ptr, int shed);
+/*
+ * take sensors [sensor_begin, sensor_end), held by other means than shedding, up again as above, on `response_stride` with
+ * `next_response_stride` set since the last response (or 0), `response_phase` samples since it
+ */
+void period_array_resume_sensors(struct period_array *pa_ptr, unsigned int sensor_begin, unsigned int sensor_end, unsigned int response_stride, unsigned int next_response_stride, unsigned int response_phase);
+/*
+ * Snapshots: the complete state of an array, smoothers, percepts, concepts, lifecycles (cycle counters included) and monochords,
+ * written field by field in a layout of its own version, with its time, to resume sampling it warm. A snapshot restores into an
+ * array of the same sensors and monochords, keeping the array's strides, failing with ENOTSUP for another layout version, byte
+ * order or shape, and with EINVAL for a file that is not a whole snapshot.
+ * A bank stores into its array before a snapshot, and loads from it after a restore; the array holds one channel's sensors, so a
+ * bank of several channels cannot be snapshotted: restored, it would copy that channel into all, and `recept_test` neither
+ * restores nor checkpoints one, saying so.
+ * A multirate octave array snapshots each octave's array, but not its ladder: the half-band filters and the delays start empty
+ * after a restore, so that the octaves see the input fade in over `period_octave_array_latency()` samples, which `recept_test`
+ * warns of.
+ *
+ * `period_array_snapshot()` writes a temporary file and renames it over `path`, so that `path` always holds a whole snapshot.
+ */
+int period_array_snapshot(struct period_array *pa_ptr, const char *path, double time);
+int period_array_restore(struct period_array *pa_ptr, const char *path, double *time_ptr);
+/*
+ * Periodic checkpoints: `period_array_checkpoint_sample()`, called from the sampling thread, copies the array every `interval` of time,
+ * and a background thread writes the copy as `period_array_snapshot()` does. It returns 1 when it took a copy, and 0 when none is due,
+ * or when the last one is still being written, never waiting on the disk, and -1 when it had no memory to copy into.
+ */
+struct period_array_checkpoint;
+int period_array_checkpoint_init(struct period_array_checkpoint *cp_ptr, struct period_array *pa_ptr, const char *path, double interval);
+int period_array_checkpoint_sample(struct period_array_checkpoint *cp_ptr, struct period_array *pa_ptr, double time);
+/* finish writing the last checkpoint, returning -1 with the errno of the last failed write */
+int period_array_checkpoint_deinit(struct period_array_checkpoint *cp_ptr);
 
 #endif
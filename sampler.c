@@ -1,19 +1,84 @@
 #include "sampler.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <stdint.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
-/* beware of integer overflow in buffer allocation */
 int filesampler_init(struct filesampler *sampler_ptr, int fileno, size_t sample_rate, size_t bit_depth, size_t chunk_size) {
+	return filesampler_init_channels(sampler_ptr, fileno, sample_rate, bit_depth, 1, chunk_size);
+}
+
+/* map a regular file from its offset on, leaving it to be read otherwise */
+static void filesampler_map(struct filesampler *sampler_ptr) {
+	struct stat st;
+	void *map;
+
+	sampler_ptr->map = NULL;
+	sampler_ptr->map_size = 0;
+	sampler_ptr->map_end = 0;
+	sampler_ptr->map_cursor = 0;
+	sampler_ptr->data_offset = lseek(sampler_ptr->fileno, 0, SEEK_CUR);
+
+	if (sampler_ptr->data_offset == -1 || fstat(sampler_ptr->fileno, &st) == -1 || ! S_ISREG(st.st_mode) || st.st_size <= sampler_ptr->data_offset) {
+		return;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, sampler_ptr->fileno, 0);
+	if (map == MAP_FAILED) {
+		return;
+	}
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	sampler_ptr->map = map;
+	sampler_ptr->map_size = st.st_size;
+	sampler_ptr->map_end = st.st_size;
+	sampler_ptr->map_cursor = sampler_ptr->data_offset;
+}
+
+int filesampler_init_channels(struct filesampler *sampler_ptr, int fileno, size_t sample_rate, size_t bit_depth, size_t channel_count, size_t chunk_size) {
+	return filesampler_init_encoding(sampler_ptr, fileno, sample_rate, bit_depth, FILESAMPLER_PCM, channel_count, chunk_size);
+}
+
+int filesampler_encoding_valid(int encoding, size_t bit_depth) {
+	switch (encoding) {
+		case FILESAMPLER_PCM:
+			return bit_depth == 8 || bit_depth == 16 || bit_depth == 24 || bit_depth == 32;
+		case FILESAMPLER_FLOAT:
+			return bit_depth == 32 || bit_depth == 64;
+		case FILESAMPLER_PCM_UNSIGNED:
+		case FILESAMPLER_MULAW:
+		case FILESAMPLER_ALAW:
+			return bit_depth == 8;
+	}
+	return 0;
+}
+
+/* beware of integer overflow in buffer allocation */
+int filesampler_init_encoding(struct filesampler *sampler_ptr, int fileno, size_t sample_rate, size_t bit_depth, int encoding, size_t channel_count, size_t chunk_size) {
+	if (channel_count == 0 || ! filesampler_encoding_valid(encoding, bit_depth)) {
+		errno = EINVAL;
+		return -1;
+	}
+
 	sampler_ptr->fileno = fileno;
 	sampler_ptr->sample_rate = sample_rate;
 	sampler_ptr->sample_depth = bit_depth;
-	sampler_ptr->sample_range = ((size_t) 1) << (bit_depth - 1);
+	sampler_ptr->encoding = encoding;
+	/* the full scale of the samples as read: floats are at 1 already, and μ-law and A-law at 1 out of their tables */
+	if (encoding == FILESAMPLER_PCM || encoding == FILESAMPLER_PCM_UNSIGNED) {
+		sampler_ptr->sample_range = ((size_t) 1) << (bit_depth - 1);
+	} else {
+		sampler_ptr->sample_range = 1;
+	}
+	sampler_ptr->sample_scale = 1.0 / sampler_ptr->sample_range;
 	sampler_ptr->sample_size = bit_depth >> 3; /* bits to bytes */
+	sampler_ptr->channel_count = channel_count;
+	sampler_ptr->frame_size = sampler_ptr->sample_size * channel_count;
 	sampler_ptr->chunk_size = chunk_size;
 	
-	sampler_ptr->buf_size = sampler_ptr->sample_size * chunk_size;
+	sampler_ptr->buf_size = sampler_ptr->frame_size * chunk_size;
 	sampler_ptr->buf = malloc(sampler_ptr->buf_size);
 	if (sampler_ptr->buf == NULL) {
 		errno = ENOMEM;
@@ -23,16 +88,33 @@ int filesampler_init(struct filesampler *sampler_ptr, int fileno, size_t sample_
 	sampler_ptr->buf_produce_cursor = 0; /* posterior is buffered file data (produced to demand reader) */
 	sampler_ptr->buf_produced = 0;
 	sampler_ptr->chunk_drawn = 0;
+	sampler_ptr->capture_ptr = NULL;
+	sampler_ptr->data_size = SIZE_MAX;
+	sampler_ptr->data_left = SIZE_MAX;
 
 	sampler_ptr->hit_eof = 0;
 
+	filesampler_map(sampler_ptr);
+
 	return 0;
 }
 unsigned int filesampler_get_sample_size(struct filesampler *sampler_ptr) {
 	return sampler_ptr->sample_size;
 }
+unsigned int filesampler_get_channel_count(struct filesampler *sampler_ptr) {
+	return sampler_ptr->channel_count;
+}
+
+static void filesampler_stop_capture(struct filesampler *sampler_ptr);
 
 void filesampler_deinit(struct filesampler *sampler_ptr) {
+	if (sampler_ptr->capture_ptr != NULL) {
+		filesampler_stop_capture(sampler_ptr);
+	}
+	if (sampler_ptr->map != NULL) {
+		munmap((void *) sampler_ptr->map, sampler_ptr->map_size);
+		sampler_ptr->map = NULL;
+	}
 	if (sampler_ptr->buf != NULL) {
 		free(sampler_ptr->buf);
 		sampler_ptr->buf = NULL;
@@ -44,6 +126,13 @@ int filesampler_read(struct filesampler *sampler_ptr) {
 	ssize_t received;
 
 	available = sampler_ptr->buf_size - sampler_ptr->buf_consume_cursor;
+	if (available > 0 && (size_t) available > sampler_ptr->data_left) {
+		available = sampler_ptr->data_left;
+		if (available == 0) {
+			sampler_ptr->hit_eof = 1;
+			return 0;
+		}
+	}
 
 	if (available < 0) {
 		errno = EFAULT;
@@ -57,6 +146,9 @@ int filesampler_read(struct filesampler *sampler_ptr) {
 			return 0;
 		} else {
 			sampler_ptr->buf_consume_cursor += received;
+			if (sampler_ptr->data_left != SIZE_MAX) {
+				sampler_ptr->data_left -= received;
+			}
 		}
 	}
 
@@ -71,7 +163,13 @@ int filesampler_supply(struct filesampler *sampler_ptr) {
 	}
 
 	available = sampler_ptr->buf_consume_cursor - sampler_ptr->buf_produce_cursor;
-	if (available < sampler_ptr->sample_size) {
+	if (available < sampler_ptr->frame_size) {
+		if (sampler_ptr->buf_consume_cursor == sampler_ptr->buf_size) {
+			/* a read ended mid-frame at the end of the buffer: move the partial frame to the front */
+			memmove(sampler_ptr->buf, sampler_ptr->buf + sampler_ptr->buf_produce_cursor, available);
+			sampler_ptr->buf_produce_cursor = 0;
+			sampler_ptr->buf_consume_cursor = available;
+		}
 		return filesampler_read(sampler_ptr);
 	}
 
@@ -85,7 +183,7 @@ int filesampler_check_draw(struct filesampler *sampler_ptr) {
 	return sampler_ptr->chunk_drawn < sampler_ptr->buf_produced / sampler_ptr->buf_size;
 }
 size_t filesampler_get_sample_count(struct filesampler *sampler_ptr) {
-	return sampler_ptr->buf_produced / sampler_ptr->sample_size;
+	return sampler_ptr->buf_produced / sampler_ptr->frame_size;
 }
 double filesampler_get_sample_time(struct filesampler *sampler_ptr) {
 	double dsample;
@@ -94,14 +192,27 @@ double filesampler_get_sample_time(struct filesampler *sampler_ptr) {
 	return dsample / sampler_ptr->sample_rate;
 }
 
+static int filesampler_decode_block(struct filesampler *sampler_ptr, const char *p, double *samples, size_t count);
+
+static int filesampler_decode(struct filesampler *sampler_ptr, const char *p, double *sample_ptr) {
+	return filesampler_decode_block(sampler_ptr, p, sample_ptr, 1);
+}
+
 /*
  * iterator that returns the next byte
  */
 int filesampler_demand_next(struct filesampler *sampler_ptr, double *sample_ptr) {
-	double sample;
 	ssize_t received;
 	ssize_t available;
 
+	if (sampler_ptr->capture_ptr != NULL || sampler_ptr->map != NULL) {
+		if (sampler_ptr->channel_count != 1) {
+			errno = ENOTSUP;
+			return -1;
+		}
+		return filesampler_demand_block(sampler_ptr, sample_ptr, 1);
+	}
+
 	received = filesampler_supply(sampler_ptr);
 	if (received == -1) {
 		return -1;
@@ -110,24 +221,8 @@ int filesampler_demand_next(struct filesampler *sampler_ptr, double *sample_ptr)
 	available = sampler_ptr->buf_consume_cursor - sampler_ptr->buf_produce_cursor;
 
 	if (available >= sampler_ptr->sample_size) {
-		switch (sampler_ptr->sample_size) {
-			case 1:
-				sample = *((int8_t *) (sampler_ptr->buf + sampler_ptr->buf_produce_cursor));
-				sample /= sampler_ptr->sample_range;
-				*sample_ptr = sample;
-				break;
-			case 2:
-				sample = *((int16_t *) (sampler_ptr->buf + sampler_ptr->buf_produce_cursor));
-				sample /= sampler_ptr->sample_range;
-				*sample_ptr = sample;
-				break;
-			case 4:
-				sample = *((int32_t *) (sampler_ptr->buf + sampler_ptr->buf_produce_cursor));
-				sample /= sampler_ptr->sample_range;
-				*sample_ptr = sample;
-				break;
-			default:
-				return -1;
+		if (filesampler_decode(sampler_ptr, sampler_ptr->buf + sampler_ptr->buf_produce_cursor, sample_ptr) == -1) {
+			return -1;
 		}
 		sampler_ptr->buf_produce_cursor += sampler_ptr->sample_size;
 		sampler_ptr->buf_produced += sampler_ptr->sample_size;
@@ -138,6 +233,662 @@ int filesampler_demand_next(struct filesampler *sampler_ptr, double *sample_ptr)
 	return 0;
 }
 
+int filesampler_demand_frame(struct filesampler *sampler_ptr, double *frame) {
+	ssize_t received;
+	ssize_t available;
+	size_t c;
+
+	if (sampler_ptr->capture_ptr != NULL || sampler_ptr->map != NULL) {
+		return filesampler_demand_block(sampler_ptr, frame, 1);
+	}
+
+	received = filesampler_supply(sampler_ptr);
+	if (received == -1) {
+		return -1;
+	}
+
+	available = sampler_ptr->buf_consume_cursor - sampler_ptr->buf_produce_cursor;
+
+	if (available >= sampler_ptr->frame_size) {
+		for (c = 0; c < sampler_ptr->channel_count; c++) {
+			if (filesampler_decode(sampler_ptr, sampler_ptr->buf + sampler_ptr->buf_produce_cursor + c * sampler_ptr->sample_size, &frame[c]) == -1) {
+				return -1;
+			}
+		}
+		sampler_ptr->buf_produce_cursor += sampler_ptr->frame_size;
+		sampler_ptr->buf_produced += sampler_ptr->frame_size;
+
+		return 1;
+	}
+
+	return 0;
+}
+
+/* frames left in the current chunk, so that a block never crosses a draw */
+static size_t filesampler_chunk_left(struct filesampler *sampler_ptr) {
+	return sampler_ptr->chunk_size - (sampler_ptr->buf_produced % sampler_ptr->buf_size) / sampler_ptr->frame_size;
+}
+
+/* G.711 expansion to 16 bit linear */
+static int16_t filesampler_mulaw_linear(unsigned char code) {
+	int t;
+
+	code = ~code;
+	t = (((code & 0x0F) << 3) + 0x84) << ((code & 0x70) >> 4);
+
+	return (code & 0x80) ? 0x84 - t : t - 0x84;
+}
+static int16_t filesampler_alaw_linear(unsigned char code) {
+	int t;
+	int segment;
+
+	code ^= 0x55;
+	t = (code & 0x0F) << 4;
+	segment = (code & 0x70) >> 4;
+	if (segment == 0) {
+		t += 8;
+	} else {
+		t = (t + 0x108) << (segment - 1);
+	}
+
+	return (code & 0x80) ? t : -t;
+}
+
+static double filesampler_mulaw_table[256];
+static double filesampler_alaw_table[256];
+static pthread_once_t filesampler_law_once = PTHREAD_ONCE_INIT;
+
+static void filesampler_law_init(void) {
+	int code;
+
+	for (code = 0; code < 256; code++) {
+		filesampler_mulaw_table[code] = filesampler_mulaw_linear(code) / 32768.0;
+		filesampler_alaw_table[code]  = filesampler_alaw_linear(code)  / 32768.0;
+	}
+}
+static const double *filesampler_law_table(int encoding) {
+	pthread_once(&filesampler_law_once, filesampler_law_init);
+
+	return encoding == FILESAMPLER_MULAW ? filesampler_mulaw_table : filesampler_alaw_table;
+}
+
+/*
+ * Samples as stored, at any byte offset: a mapped file's data starts wherever its header ends (e.g. 58 bytes in
+ * for some WAVs), so the decode loads go through these rather than through pointers of the plain types.
+ */
+typedef int16_t filesampler_int16_u __attribute__((aligned(1), may_alias));
+typedef int32_t filesampler_int32_u __attribute__((aligned(1), may_alias));
+typedef float   filesampler_float_u __attribute__((aligned(1), may_alias));
+typedef double  filesampler_double_u __attribute__((aligned(1), may_alias));
+
+#define FILESAMPLER_DECODE_NAME filesampler_decode_block
+#define FILESAMPLER_DECODE_T    double
+#include "sampler_decode.h"
+#undef FILESAMPLER_DECODE_NAME
+#undef FILESAMPLER_DECODE_T
+
+#define FILESAMPLER_DECODE_NAME filesampler_decode_block_f
+#define FILESAMPLER_DECODE_T    float
+#include "sampler_decode.h"
+#undef FILESAMPLER_DECODE_NAME
+#undef FILESAMPLER_DECODE_T
+
+/* `frames` frames at `p` into `out`, doubles or floats, from frame `offset` of it */
+static int filesampler_decode_frames(struct filesampler *sampler_ptr, const char *p, void *out, int single, size_t offset, size_t frames) {
+	size_t channels = sampler_ptr->channel_count;
+
+	if (single) {
+		return filesampler_decode_block_f(sampler_ptr, p, (float *) out + offset * channels, frames * channels);
+	} else {
+		return filesampler_decode_block(sampler_ptr, p, (double *) out + offset * channels, frames * channels);
+	}
+}
+
+static ssize_t filesampler_capture_demand(struct filesampler *sampler_ptr, void *out, int single, size_t max);
+
+static ssize_t filesampler_demand_block_any(struct filesampler *sampler_ptr, void *out, int single, size_t max) {
+	ssize_t received;
+	size_t available;
+	size_t n;
+
+	if (max > filesampler_chunk_left(sampler_ptr)) {
+		max = filesampler_chunk_left(sampler_ptr);
+	}
+	if (sampler_ptr->capture_ptr != NULL) {
+		return filesampler_capture_demand(sampler_ptr, out, single, max);
+	}
+	if (sampler_ptr->map != NULL) {
+		/* straight from the map; a partial frame at the end is never completed */
+		available = (sampler_ptr->map_end - sampler_ptr->map_cursor) / sampler_ptr->frame_size;
+		if (available == 0) {
+			sampler_ptr->hit_eof = 1;
+			return 0;
+		}
+		n = available < max ? available : max;
+		if (filesampler_decode_frames(sampler_ptr, sampler_ptr->map + sampler_ptr->map_cursor, out, single, 0, n) == -1) {
+			return -1;
+		}
+		sampler_ptr->map_cursor += n * sampler_ptr->frame_size;
+		sampler_ptr->buf_produced += n * sampler_ptr->frame_size;
+
+		return n;
+	}
+
+	received = filesampler_supply(sampler_ptr);
+	if (received == -1) {
+		return -1;
+	}
+
+	/* every whole frame buffered, in one pass; a partial frame waits for the next read */
+	available = (sampler_ptr->buf_consume_cursor - sampler_ptr->buf_produce_cursor) / sampler_ptr->frame_size;
+	n = available < max ? available : max;
+	if (filesampler_decode_frames(sampler_ptr, sampler_ptr->buf + sampler_ptr->buf_produce_cursor, out, single, 0, n) == -1) {
+		return -1;
+	}
+	sampler_ptr->buf_produce_cursor += n * sampler_ptr->frame_size;
+	sampler_ptr->buf_produced += n * sampler_ptr->frame_size;
+
+	return n;
+}
+
+int filesampler_seek(struct filesampler *sampler_ptr, size_t frame) {
+	size_t offset = frame * sampler_ptr->frame_size;
+
+	if (sampler_ptr->capture_ptr != NULL) {
+		errno = EBUSY;
+		return -1;
+	}
+	if (sampler_ptr->map != NULL) {
+		if (offset > sampler_ptr->map_end - sampler_ptr->data_offset) {
+			errno = EINVAL;
+			return -1;
+		}
+		sampler_ptr->map_cursor = sampler_ptr->data_offset + offset;
+	} else {
+		if (lseek(sampler_ptr->fileno, sampler_ptr->data_offset + (off_t) offset, SEEK_SET) == -1) {
+			return -1;
+		}
+		sampler_ptr->buf_consume_cursor = 0;
+		sampler_ptr->buf_produce_cursor = 0;
+		sampler_ptr->data_left = sampler_ptr->data_size == SIZE_MAX ? SIZE_MAX : offset < sampler_ptr->data_size ? sampler_ptr->data_size - offset : 0;
+	}
+	sampler_ptr->buf_produced = offset;
+	sampler_ptr->chunk_drawn = offset / sampler_ptr->buf_size;
+	sampler_ptr->hit_eof = 0;
+
+	return 0;
+}
+
+int filesampler_set_data_size(struct filesampler *sampler_ptr, size_t size) {
+	if (sampler_ptr->capture_ptr != NULL || sampler_ptr->buf_produced != 0 || sampler_ptr->buf_consume_cursor != 0) {
+		errno = EBUSY;
+		return -1;
+	}
+	sampler_ptr->data_size = size;
+	sampler_ptr->data_left = size;
+	if (sampler_ptr->map != NULL && size < sampler_ptr->map_end - sampler_ptr->data_offset) {
+		sampler_ptr->map_end = sampler_ptr->data_offset + size;
+	}
+
+	return 0;
+}
+
+int filesampler_unread(struct filesampler *sampler_ptr, const void *bytes, size_t size) {
+	if (size == 0) {
+		return 0;
+	}
+	if (sampler_ptr->capture_ptr != NULL || sampler_ptr->buf_produced != 0 || sampler_ptr->buf_consume_cursor != 0) {
+		errno = EBUSY;
+		return -1;
+	}
+	if (sampler_ptr->map != NULL || size > sampler_ptr->buf_size) {
+		errno = EINVAL;
+		return -1;
+	}
+	/* read inline, ahead of the next read, and carried into a capture when one starts */
+	memcpy(sampler_ptr->buf, bytes, size);
+	sampler_ptr->buf_consume_cursor = size;
+
+	return 0;
+}
+
+ssize_t filesampler_demand_block(struct filesampler *sampler_ptr, double *frames, size_t max) {
+	return filesampler_demand_block_any(sampler_ptr, frames, 0, max);
+}
+ssize_t filesampler_demand_block_f(struct filesampler *sampler_ptr, float *frames, size_t max) {
+	return filesampler_demand_block_any(sampler_ptr, frames, 1, max);
+}
+
+int filesampler_parse_format(const char *text, size_t *bit_depth_ptr, int *encoding_ptr) {
+	if (strcmp(text, "8") == 0 || strcmp(text, "16") == 0 || strcmp(text, "24") == 0 || strcmp(text, "32") == 0) {
+		*bit_depth_ptr = strtoul(text, NULL, 10);
+		*encoding_ptr  = FILESAMPLER_PCM;
+	} else if (strcmp(text, "u8") == 0) {
+		*bit_depth_ptr = 8;
+		*encoding_ptr  = FILESAMPLER_PCM_UNSIGNED;
+	} else if (strcmp(text, "f32") == 0 || strcmp(text, "f64") == 0) {
+		*bit_depth_ptr = strtoul(text + 1, NULL, 10);
+		*encoding_ptr  = FILESAMPLER_FLOAT;
+	} else if (strcmp(text, "mulaw") == 0) {
+		*bit_depth_ptr = 8;
+		*encoding_ptr  = FILESAMPLER_MULAW;
+	} else if (strcmp(text, "alaw") == 0) {
+		*bit_depth_ptr = 8;
+		*encoding_ptr  = FILESAMPLER_ALAW;
+	} else {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* WAV */
+
+static uint16_t filesampler_le16(const unsigned char *p) {
+	return p[0] | (p[1] << 8);
+}
+static uint32_t filesampler_le32(const unsigned char *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+static uint64_t filesampler_le64(const unsigned char *p) {
+	return filesampler_le32(p) | ((uint64_t) filesampler_le32(p + 4) << 32);
+}
+
+/* read `size` bytes `offset` into a file, or the next of a stream, which may come in pieces, skipping from `*position_ptr` up to `offset` */
+static ssize_t filesampler_wav_read(int fileno, int stream, void *buf, size_t size, off_t offset, off_t *position_ptr) {
+	unsigned char skip[4096];
+	size_t want;
+	size_t taken;
+	ssize_t received;
+
+	if ( ! stream) {
+		return pread(fileno, buf, size, offset);
+	}
+	for (taken = 0; *position_ptr < offset || taken < size; ) {
+		if (*position_ptr < offset) {
+			want = offset - *position_ptr < (off_t) sizeof (skip) ? offset - *position_ptr : sizeof (skip);
+			received = read(fileno, skip, want);
+		} else {
+			received = read(fileno, (unsigned char *) buf + taken, size - taken);
+		}
+		if (received == -1 && errno == EINTR) {
+			continue;
+		}
+		if (received <= 0) {
+			return received == -1 ? -1 : (ssize_t) taken;
+		}
+		if (*position_ptr >= offset) {
+			taken += received;
+		}
+		*position_ptr += received;
+	}
+
+	return taken;
+}
+
+int filesampler_read_wav(int fileno, struct filesampler_wav *wav_ptr) {
+	unsigned char header[12];
+	unsigned char chunk[8];
+	unsigned char fmt[40];
+	unsigned char ds64[16];
+	struct stat st;
+	uint64_t ds64_data_size = 0;
+	uint64_t size;
+	uint16_t format;
+	off_t offset;
+	off_t position = 0;
+	ssize_t received;
+	int stream;
+	int rf64;
+	int has_fmt = 0;
+
+	wav_ptr->lead_size = 0;
+	if (fstat(fileno, &st) == -1 || ! (S_ISREG(st.st_mode) || S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode))) {
+		return 0;
+	}
+	/* a pipe cannot be read twice, so its header is read off it, leaving it at the first frame */
+	stream = ! S_ISREG(st.st_mode);
+	wav_ptr->streamed = stream;
+
+	received = filesampler_wav_read(fileno, stream, header, sizeof (header), 0, &position);
+	if (received == -1) {
+		return -1;
+	}
+	if (stream) {
+		/* not a WAV after all, its first bytes are the first of its samples */
+		memcpy(wav_ptr->lead, header, received);
+		wav_ptr->lead_size = received;
+	}
+	if (received != sizeof (header)) {
+		return 0;
+	}
+	rf64 = memcmp(header, "RF64", 4) == 0 || memcmp(header, "BW64", 4) == 0;
+	if (( ! rf64 && memcmp(header, "RIFF", 4) != 0) || memcmp(header + 8, "WAVE", 4) != 0) {
+		return 0;
+	}
+	wav_ptr->lead_size = 0;
+
+	for (offset = sizeof (header); ; offset += sizeof (chunk) + size + (size & 1)) {
+		if (filesampler_wav_read(fileno, stream, chunk, sizeof (chunk), offset, &position) != sizeof (chunk)) {
+			errno = EINVAL;
+			return -1;
+		}
+		size = filesampler_le32(chunk + 4);
+
+		if (memcmp(chunk, "ds64", 4) == 0) {
+			/* RF64's sizes past 4 GiB: of the RIFF, then of the data */
+			if (size < sizeof (ds64) || filesampler_wav_read(fileno, stream, ds64, sizeof (ds64), offset + sizeof (chunk), &position) != sizeof (ds64)) {
+				errno = EINVAL;
+				return -1;
+			}
+			ds64_data_size = filesampler_le64(ds64 + 8);
+		} else if (memcmp(chunk, "fmt ", 4) == 0) {
+			if (size < 16 || filesampler_wav_read(fileno, stream, fmt, size < sizeof (fmt) ? size : sizeof (fmt), offset + sizeof (chunk), &position) < 16) {
+				errno = EINVAL;
+				return -1;
+			}
+			format                 = filesampler_le16(fmt);
+			wav_ptr->channel_count = filesampler_le16(fmt + 2);
+			wav_ptr->sample_rate   = filesampler_le32(fmt + 4);
+			wav_ptr->bit_depth     = wav_ptr->channel_count > 0 ? filesampler_le16(fmt + 12) / wav_ptr->channel_count * 8 : 0; /* of the container */
+			if (format == 0xFFFE && size >= sizeof (fmt)) {
+				/* WAVE_FORMAT_EXTENSIBLE: the format leads its subformat's GUID */
+				format = filesampler_le16(fmt + 24);
+			}
+			switch (format) {
+				case 1:
+				case 0xFFFE:
+					wav_ptr->encoding = wav_ptr->bit_depth == 8 ? FILESAMPLER_PCM_UNSIGNED : FILESAMPLER_PCM;
+					break;
+				case 3:
+					wav_ptr->encoding = FILESAMPLER_FLOAT;
+					break;
+				case 6:
+					wav_ptr->encoding = FILESAMPLER_ALAW;
+					break;
+				case 7:
+					wav_ptr->encoding = FILESAMPLER_MULAW;
+					break;
+				default:
+					errno = ENOTSUP;
+					return -1;
+			}
+			if (wav_ptr->channel_count == 0 || wav_ptr->sample_rate == 0 || ! filesampler_encoding_valid(wav_ptr->encoding, wav_ptr->bit_depth)) {
+				errno = ENOTSUP;
+				return -1;
+			}
+			has_fmt = 1;
+		} else if (memcmp(chunk, "data", 4) == 0) {
+			if ( ! has_fmt) {
+				errno = EINVAL;
+				return -1;
+			}
+			if (rf64 && size == 0xFFFFFFFF) {
+				size = ds64_data_size;
+			}
+			wav_ptr->data_offset = offset + sizeof (chunk);
+			if (stream) {
+				/* up to the data, whatever the stream has left is the frames */
+				if (filesampler_wav_read(fileno, stream, NULL, 0, wav_ptr->data_offset, &position) == -1) {
+					return -1;
+				}
+				wav_ptr->data_size = size == 0 || size == 0xFFFFFFFF || size > SIZE_MAX ? SIZE_MAX : size;
+				return 1;
+			}
+			/* a recording cut short, or streamed with an unknown size (0 or 0xFFFFFFFF), ends with the file */
+			if (size == 0 || size == 0xFFFFFFFF || wav_ptr->data_offset + size > (uint64_t) st.st_size) {
+				size = st.st_size - wav_ptr->data_offset;
+			}
+			wav_ptr->data_size = size;
+			return 1;
+		}
+	}
+}
+
+/* capture */
+
+/* wake the other side if it waits on `flag`, or whatever it does when `always` */
+static void filesampler_capture_wake(struct filesampler_capture *capture_ptr, _Atomic int *flag, int always) {
+	if (always || atomic_load(flag)) {
+		pthread_mutex_lock(&capture_ptr->mutex);
+		pthread_cond_broadcast(&capture_ptr->cond);
+		pthread_mutex_unlock(&capture_ptr->mutex);
+	}
+}
+
+/* a cancelled wait returns holding the mutex */
+static void filesampler_capture_unlock(void *arg) {
+	struct filesampler_capture *capture_ptr = arg;
+
+	pthread_mutex_unlock(&capture_ptr->mutex);
+}
+
+static void *filesampler_capture_thread(void *arg) {
+	struct filesampler *sampler_ptr = arg;
+	struct filesampler_capture *capture_ptr = sampler_ptr->capture_ptr;
+	size_t frame_size = sampler_ptr->frame_size;
+	size_t mask = capture_ptr->capacity - 1;
+	ssize_t received;
+	size_t want;
+	size_t count;
+	size_t taken;
+	size_t first;
+	size_t head;
+	size_t tail;
+
+	for (;;) {
+		want = sampler_ptr->buf_size - capture_ptr->buf_fill;
+		if (want > sampler_ptr->data_left) {
+			want = sampler_ptr->data_left;
+		}
+		received = want > 0 ? read(sampler_ptr->fileno, capture_ptr->buf + capture_ptr->buf_fill, want) : 0;
+		if (received == -1 && errno == EINTR) {
+			continue;
+		}
+		if (received <= 0) {
+			capture_ptr->error = received == -1 ? errno : 0;
+			break;
+		}
+		capture_ptr->buf_fill += received;
+		if (sampler_ptr->data_left != SIZE_MAX) {
+			sampler_ptr->data_left -= received;
+		}
+		count = capture_ptr->buf_fill / frame_size;
+
+		head = atomic_load_explicit(&capture_ptr->head, memory_order_relaxed);
+		tail = atomic_load_explicit(&capture_ptr->tail, memory_order_acquire);
+		if (capture_ptr->lossless && capture_ptr->capacity - (head - tail) < count) {
+			pthread_mutex_lock(&capture_ptr->mutex);
+			pthread_cleanup_push(filesampler_capture_unlock, capture_ptr);
+			atomic_store(&capture_ptr->full, 1);
+			while (capture_ptr->capacity - (head - (tail = atomic_load(&capture_ptr->tail))) < count) {
+				pthread_cond_wait(&capture_ptr->cond, &capture_ptr->mutex);
+			}
+			atomic_store(&capture_ptr->full, 0);
+			pthread_cleanup_pop(1);
+		}
+
+		/* as many whole frames as there is room for, in up to two runs around the end of the ring, dropping the rest */
+		taken = capture_ptr->capacity - (head - tail);
+		if (taken > count) {
+			taken = count;
+		}
+		first = capture_ptr->capacity - (head & mask);
+		if (first > taken) {
+			first = taken;
+		}
+		memcpy(capture_ptr->ring + (head & mask) * frame_size, capture_ptr->buf, first * frame_size);
+		memcpy(capture_ptr->ring, capture_ptr->buf + first * frame_size, (taken - first) * frame_size);
+		if (taken < count) {
+			atomic_fetch_add_explicit(&capture_ptr->overruns, count - taken, memory_order_relaxed);
+		}
+		atomic_store(&capture_ptr->head, head + taken);
+		if (head + taken - tail > atomic_load_explicit(&capture_ptr->high_water, memory_order_relaxed)) {
+			atomic_store_explicit(&capture_ptr->high_water, head + taken - tail, memory_order_relaxed);
+		}
+		filesampler_capture_wake(capture_ptr, &capture_ptr->waiting, 0);
+
+		/* keep a partial frame for the next read */
+		capture_ptr->buf_fill -= count * frame_size;
+		memmove(capture_ptr->buf, capture_ptr->buf + count * frame_size, capture_ptr->buf_fill);
+	}
+
+	atomic_store(&capture_ptr->done, 1);
+	filesampler_capture_wake(capture_ptr, &capture_ptr->waiting, 1);
+
+	return NULL;
+}
+
+int filesampler_start_capture(struct filesampler *sampler_ptr, size_t frames) {
+	struct filesampler_capture *capture_ptr;
+	size_t capacity;
+	size_t pending;
+	struct stat st;
+	int rc;
+
+	if (sampler_ptr->capture_ptr != NULL) {
+		errno = EBUSY;
+		return -1;
+	}
+	if (sampler_ptr->map != NULL) {
+		/* the kernel reads ahead of the map already */
+		return 0;
+	}
+	if (frames < 2 * sampler_ptr->chunk_size) {
+		frames = 2 * sampler_ptr->chunk_size;
+	}
+	for (capacity = 1; capacity < frames; capacity <<= 1) {
+	}
+
+	capture_ptr = calloc(1, sizeof (*capture_ptr));
+	if (capture_ptr == NULL) {
+		return -1;
+	}
+	capture_ptr->capacity = capacity;
+	capture_ptr->ring = malloc(capacity * sampler_ptr->frame_size);
+	capture_ptr->buf  = malloc(sampler_ptr->buf_size);
+	if (capture_ptr->ring == NULL || capture_ptr->buf == NULL) {
+		free(capture_ptr->ring);
+		free(capture_ptr->buf);
+		free(capture_ptr);
+		errno = ENOMEM;
+		return -1;
+	}
+	atomic_init(&capture_ptr->head, 0);
+	atomic_init(&capture_ptr->tail, 0);
+	atomic_init(&capture_ptr->overruns, 0);
+	atomic_init(&capture_ptr->high_water, 0);
+	atomic_init(&capture_ptr->done, 0);
+	atomic_init(&capture_ptr->waiting, 0);
+	atomic_init(&capture_ptr->full, 0);
+	capture_ptr->error = 0;
+	capture_ptr->lossless = fstat(sampler_ptr->fileno, &st) == 0 && S_ISREG(st.st_mode);
+
+	/* what was read inline and not yet taken goes first */
+	pending = sampler_ptr->buf_consume_cursor - sampler_ptr->buf_produce_cursor;
+	memcpy(capture_ptr->buf, sampler_ptr->buf + sampler_ptr->buf_produce_cursor, pending);
+	capture_ptr->buf_fill = pending;
+	sampler_ptr->buf_consume_cursor = 0;
+	sampler_ptr->buf_produce_cursor = 0;
+
+	pthread_mutex_init(&capture_ptr->mutex, NULL);
+	pthread_cond_init(&capture_ptr->cond, NULL);
+	sampler_ptr->capture_ptr = capture_ptr;
+	rc = pthread_create(&capture_ptr->thread, NULL, filesampler_capture_thread, sampler_ptr);
+	if (rc != 0) {
+		sampler_ptr->capture_ptr = NULL;
+		memcpy(sampler_ptr->buf, capture_ptr->buf, pending);
+		sampler_ptr->buf_consume_cursor = pending;
+		pthread_cond_destroy(&capture_ptr->cond);
+		pthread_mutex_destroy(&capture_ptr->mutex);
+		free(capture_ptr->ring);
+		free(capture_ptr->buf);
+		free(capture_ptr);
+		errno = rc;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* the thread waits on the file, where it may be cancelled */
+static void filesampler_stop_capture(struct filesampler *sampler_ptr) {
+	struct filesampler_capture *capture_ptr = sampler_ptr->capture_ptr;
+
+	pthread_cancel(capture_ptr->thread);
+	pthread_join(capture_ptr->thread, NULL);
+	pthread_cond_destroy(&capture_ptr->cond);
+	pthread_mutex_destroy(&capture_ptr->mutex);
+	free(capture_ptr->ring);
+	free(capture_ptr->buf);
+	free(capture_ptr);
+	sampler_ptr->capture_ptr = NULL;
+}
+
+static ssize_t filesampler_capture_demand(struct filesampler *sampler_ptr, void *out, int single, size_t max) {
+	struct filesampler_capture *capture_ptr = sampler_ptr->capture_ptr;
+	size_t frame_size = sampler_ptr->frame_size;
+	size_t mask = capture_ptr->capacity - 1;
+	size_t head;
+	size_t tail;
+	size_t first;
+	size_t n;
+
+	tail = atomic_load_explicit(&capture_ptr->tail, memory_order_relaxed);
+	head = atomic_load_explicit(&capture_ptr->head, memory_order_acquire);
+	if (head == tail) {
+		pthread_mutex_lock(&capture_ptr->mutex);
+		atomic_store(&capture_ptr->waiting, 1);
+		while ((head = atomic_load(&capture_ptr->head)) == tail && ! atomic_load(&capture_ptr->done)) {
+			pthread_cond_wait(&capture_ptr->cond, &capture_ptr->mutex);
+		}
+		atomic_store(&capture_ptr->waiting, 0);
+		pthread_mutex_unlock(&capture_ptr->mutex);
+
+		if (head == tail) {
+			/* drained, and the thread is done */
+			sampler_ptr->hit_eof = 1;
+			if (capture_ptr->error != 0) {
+				errno = capture_ptr->error;
+				return -1;
+			}
+			return 0;
+		}
+	}
+
+	/* decoded straight out of the ring, in up to two runs around its end */
+	n = head - tail < max ? head - tail : max;
+	first = capture_ptr->capacity - (tail & mask);
+	if (first > n) {
+		first = n;
+	}
+	filesampler_decode_frames(sampler_ptr, capture_ptr->ring + (tail & mask) * frame_size, out, single, 0, first);
+	filesampler_decode_frames(sampler_ptr, capture_ptr->ring, out, single, first, n - first);
+	atomic_store(&capture_ptr->tail, tail + n);
+	filesampler_capture_wake(capture_ptr, &capture_ptr->full, 0);
+	sampler_ptr->buf_produced += n * frame_size;
+
+	return n;
+}
+
+size_t filesampler_capture_occupancy(struct filesampler *sampler_ptr) {
+	if (sampler_ptr->capture_ptr == NULL) {
+		return 0;
+	}
+	return atomic_load_explicit(&sampler_ptr->capture_ptr->head, memory_order_relaxed) - atomic_load_explicit(&sampler_ptr->capture_ptr->tail, memory_order_relaxed);
+}
+size_t filesampler_capture_high_water(struct filesampler *sampler_ptr) {
+	return sampler_ptr->capture_ptr != NULL ? atomic_load_explicit(&sampler_ptr->capture_ptr->high_water, memory_order_relaxed) : 0;
+}
+size_t filesampler_capture_overruns(struct filesampler *sampler_ptr) {
+	return sampler_ptr->capture_ptr != NULL ? atomic_load_explicit(&sampler_ptr->capture_ptr->overruns, memory_order_relaxed) : 0;
+}
+size_t filesampler_capture_capacity(struct filesampler *sampler_ptr) {
+	return sampler_ptr->capture_ptr != NULL ? sampler_ptr->capture_ptr->capacity : 0;
+}
+
+
 #ifdef OSC_TEST
 #include <stdio.h>
 #include <errno.h>
@@ -2,14 +2,62 @@
 #define SAMPLER_H
 
 #include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+/* of the samples in the file, all little-endian */
+enum filesampler_encoding {
+	FILESAMPLER_PCM,          /* signed integers of 8, 16, 24 (packed) or 32 bits */
+	FILESAMPLER_PCM_UNSIGNED, /* unsigned 8 bit integers, centered on 128, as in 8 bit WAV */
+	FILESAMPLER_FLOAT,        /* IEEE floats of 32 or 64 bits, at full scale at 1 */
+	FILESAMPLER_MULAW,        /* G.711 μ-law, 8 bits */
+	FILESAMPLER_ALAW          /* G.711 A-law, 8 bits */
+};
+
+/*
+ * Mapping: a regular file is mapped whole at init, from where the file's offset is on, and decoded straight from the map,
+ * read ahead by the kernel, without reads or copies. Then, it can also seek to any frame, and needs no capture thread.
+ * Where the map fails, the file is read as any other.
+ *
+ * Capture: a reader thread owns the file, reads it as it comes, and copies whole frames into a lock-free ring, of one
+ * producer and one consumer, which `filesampler_demand_block()` decodes whole slices of. A slow consumer then no longer
+ * holds up draining the input, and a read waiting on the input no longer holds up the consumer.
+ *
+ * When the ring is full, the thread drops the frames it read of live input, counting them as overruns, rather than
+ * leave them to back up into the writer (for a FIFO, into sox, which drops them anyway). A regular file is not live,
+ * so for one, the thread waits for room instead.
+ */
+struct filesampler_capture {
+	char   *ring;           /* `capacity` frames, as read */
+	size_t  capacity;       /* frames, a power of 2 */
+	_Atomic size_t head;    /* frames written, by the thread */
+	_Atomic size_t tail;    /* frames taken, by the consumer */
+	_Atomic size_t overruns;   /* frames dropped on a full ring */
+	_Atomic size_t high_water; /* the most frames held at once */
+	_Atomic int    done;    /* the thread hit the end of the file, or an error */
+	int            error;   /* errno of the error, or 0 at the end of the file */
+	_Atomic int    waiting; /* the consumer waits on `cond` for frames */
+	_Atomic int    full;    /* the thread waits on `cond` for room */
+	int            lossless; /* wait for room, rather than drop */
+	char   *buf;            /* bytes read, up to a partial frame kept for the next read */
+	size_t  buf_fill;
+	pthread_t       thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t  cond;
+};
 
 struct filesampler {
 	int fileno;
 	size_t sample_rate;
 	size_t sample_depth;
+	int    encoding; /* enum filesampler_encoding */
 	size_t sample_range;
+	double sample_scale; /* 1 / sample_range */
 	size_t sample_size;
-	size_t chunk_size;
+	size_t channel_count;
+	size_t frame_size; /* sample_size * channel_count: one sample of each channel, interleaved */
+	size_t chunk_size; /* in frames */
 	int hit_eof;
 	char *buf;
 	size_t buf_size;
@@ -17,17 +65,77 @@ struct filesampler {
 	size_t buf_consume_cursor;
 	size_t buf_produced;
 	size_t chunk_drawn;
+	struct filesampler_capture *capture_ptr; /* NULL reads inline */
+	const char *map;   /* a regular file, mapped whole, or NULL to read the file */
+	size_t map_size;
+	size_t map_end;    /* bytes into the map where the frames end */
+	size_t map_cursor; /* bytes into the map of the next frame */
+	off_t  data_offset; /* of the first frame in the file: where it was at init */
+	size_t data_size;  /* bytes of frames from there, or SIZE_MAX to the end of the file */
+	size_t data_left;  /* of them, not yet read */
+};
+
+/* the format of a RIFF WAVE, RF64 or BW64 file */
+struct filesampler_wav {
+	size_t sample_rate;
+	size_t bit_depth;     /* of each sample's container */
+	int    encoding;
+	size_t channel_count;
+	off_t  data_offset;   /* bytes into the file */
+	size_t data_size;     /* bytes, up to the end of the file, or SIZE_MAX to the end of a stream */
+	int    streamed;      /* read off a pipe, which is left at the first frame */
+	unsigned char lead[12]; /* of a pipe that is not a WAV, the bytes read to tell, for `filesampler_unread()` */
+	size_t lead_size;
 };
 
 unsigned int filesampler_get_sample_size(struct filesampler *sampler_ptr);
 int filesampler_init(struct filesampler *sampler_ptr, int fileno, size_t sample_rate, size_t bit_depth, size_t chunks_size);
+int filesampler_init_channels(struct filesampler *sampler_ptr, int fileno, size_t sample_rate, size_t bit_depth, size_t channel_count, size_t chunk_size);
+/* samples of `encoding` in `bit_depth` bits, or -1 with EINVAL for a depth the encoding does not come in */
+int filesampler_init_encoding(struct filesampler *sampler_ptr, int fileno, size_t sample_rate, size_t bit_depth, int encoding, size_t channel_count, size_t chunk_size);
+/* whether samples of `bit_depth` bits come in `encoding` */
+int filesampler_encoding_valid(int encoding, size_t bit_depth);
+/* end the frames `size` bytes into the file, as a WAV's data chunk ends before the chunks after it; before the first frame */
+int filesampler_set_data_size(struct filesampler *sampler_ptr, size_t size);
+/* take `size` bytes already read off a pipe, such as a `struct filesampler_wav` lead, as its first, up to a chunk of them; before the first frame */
+int filesampler_unread(struct filesampler *sampler_ptr, const void *bytes, size_t size);
+/* a format as given on the command line: "8", "16", "24" or "32" bit signed integers, "u8", "f32", "f64", "mulaw" or "alaw" */
+int filesampler_parse_format(const char *text, size_t *bit_depth_ptr, int *encoding_ptr);
+/*
+ * the format of the WAV file open on `fileno`, read without moving its offset: 1 when it is one, 0 when not, or -1 with
+ * ENOTSUP for a format not decoded, or EINVAL for a broken header. A pipe (or socket), which cannot be read twice, is read
+ * with plain reads up to its first frame, and one that is not a WAV keeps the bytes read in `lead`; a data size of 0 or
+ * 0xFFFFFFFF, as written by a recorder that cannot seek back, runs to the end of the file or stream.
+ */
+int filesampler_read_wav(int fileno, struct filesampler_wav *wav_ptr);
+unsigned int filesampler_get_channel_count(struct filesampler *sampler_ptr);
 void filesampler_deinit(struct filesampler *sampler_ptr);
 
 void filesampler_mark_draw(struct filesampler *sampler_ptr);
 int filesampler_check_draw(struct filesampler *sampler_ptr);
-size_t filesampler_get_sample_count(struct filesampler *sampler_ptr);
+size_t filesampler_get_sample_count(struct filesampler *sampler_ptr); /* in frames */
 double filesampler_get_sample_time(struct filesampler *sampler_ptr);
 
 int filesampler_demand_next(struct filesampler *sampler_ptr, double *sample_ptr);
+/* the next frame, one sample per channel into `frame`, returning 1, or 0 until one is available */
+int filesampler_demand_frame(struct filesampler *sampler_ptr, double *frame);
+/*
+ * up to `max` frames into `frames`, as many as are available, up to the end of the chunk, decoded in one pass: returns how many,
+ * or 0 until any are available, waiting for them when capturing, or -1 with errno set; at the end of a captured file, 0 with
+ * `hit_eof` set
+ */
+ssize_t filesampler_demand_block(  struct filesampler *sampler_ptr, double *frames, size_t max);
+ssize_t filesampler_demand_block_f(struct filesampler *sampler_ptr, float  *frames, size_t max);
+
+/* frames from the first, at `frame`, for a regular file, or -1 with errno set: ESPIPE for a FIFO, EBUSY when capturing */
+int filesampler_seek(struct filesampler *sampler_ptr, size_t frame);
+
+/* start a reader thread on the file, with a ring of at least `frames` frames; the file is read only by the thread after */
+int    filesampler_start_capture(struct filesampler *sampler_ptr, size_t frames);
+/* frames in the ring, waiting for the consumer, and frames dropped on a full ring, so far */
+size_t filesampler_capture_occupancy(struct filesampler *sampler_ptr);
+size_t filesampler_capture_high_water(struct filesampler *sampler_ptr);
+size_t filesampler_capture_overruns(struct filesampler *sampler_ptr);
+size_t filesampler_capture_capacity(struct filesampler *sampler_ptr);
 
 #endif
@@ -0,0 +1,93 @@
+/*
+ * Block decode template, included by sampler.c once per output type with
+ *
+ * FILESAMPLER_DECODE_NAME the function name
+ * FILESAMPLER_DECODE_T    the output sample type, double or float
+ *
+ * Decodes `count` samples at `p` into `samples`, scaled to full scale at 1. Each loop is a plain conversion and
+ * a multiply by the precomputed reciprocal of the range over contiguous samples, which the compiler vectorizes;
+ * `p` need not be aligned, so the wider samples are loaded through the unaligned types of sampler.c;
+ * the range is a power of 2, so the products are exactly the quotients. Packed 24 bit samples are shifted into the
+ * top of an int32 and scaled by 256 times less. μ-law and A-law look each byte up in a table of 256 decoded values.
+ */
+
+static int FILESAMPLER_DECODE_NAME(struct filesampler *sampler_ptr, const char *p, FILESAMPLER_DECODE_T *samples, size_t count) {
+	const FILESAMPLER_DECODE_T scale = sampler_ptr->sample_scale;
+	const unsigned char *u = (const unsigned char *) p;
+	const double *table;
+	size_t i;
+
+	switch (sampler_ptr->encoding) {
+		case FILESAMPLER_PCM:
+			switch (sampler_ptr->sample_size) {
+				case 1: {
+					const int8_t *s = (const int8_t *) p;
+
+					for (i = 0; i < count; i++) {
+						samples[i] = s[i] * scale;
+					}
+					return 0;
+				}
+				case 2: {
+					const filesampler_int16_u *s = (const filesampler_int16_u *) p;
+
+					for (i = 0; i < count; i++) {
+						samples[i] = s[i] * scale;
+					}
+					return 0;
+				}
+				case 3: {
+					const FILESAMPLER_DECODE_T scale24 = sampler_ptr->sample_scale / 256;
+
+					for (i = 0; i < count; i++) {
+						samples[i] = (int32_t) ((uint32_t) u[3 * i] << 8 | (uint32_t) u[3 * i + 1] << 16 | (uint32_t) u[3 * i + 2] << 24) * scale24;
+					}
+					return 0;
+				}
+				case 4: {
+					const filesampler_int32_u *s = (const filesampler_int32_u *) p;
+
+					for (i = 0; i < count; i++) {
+						samples[i] = s[i] * scale;
+					}
+					return 0;
+				}
+			}
+			break;
+		case FILESAMPLER_PCM_UNSIGNED:
+			for (i = 0; i < count; i++) {
+				samples[i] = ((int) u[i] - 128) * scale;
+			}
+			return 0;
+		case FILESAMPLER_FLOAT:
+			switch (sampler_ptr->sample_size) {
+				case 4: {
+					const filesampler_float_u *s = (const filesampler_float_u *) p;
+
+					for (i = 0; i < count; i++) {
+						samples[i] = s[i];
+					}
+					return 0;
+				}
+				case 8: {
+					const filesampler_double_u *s = (const filesampler_double_u *) p;
+
+					for (i = 0; i < count; i++) {
+						samples[i] = s[i];
+					}
+					return 0;
+				}
+			}
+			break;
+		case FILESAMPLER_MULAW:
+		case FILESAMPLER_ALAW:
+			table = filesampler_law_table(sampler_ptr->encoding);
+			for (i = 0; i < count; i++) {
+				samples[i] = table[u[i]];
+			}
+			return 0;
+	}
+
+	errno = EINVAL;
+	return -1;
+}
@@ -24,6 +24,12 @@ int sampler_ui_get_sample_rate(struct sampler_ui *sui_ptr) {
 int sampler_ui_get_sample_depth(struct sampler_ui *sui_ptr) {
 	return sui_ptr->sample_depth;
 }
+int sampler_ui_get_sample_encoding(struct sampler_ui *sui_ptr) {
+	return sui_ptr->sample_encoding;
+}
+int sampler_ui_get_sample_channels(struct sampler_ui *sui_ptr) {
+	return sui_ptr->sample_channels;
+}
 int sampler_ui_get_fd(struct sampler_ui *sui_ptr) {
 	return sui_ptr->fd;
 }
@@ -58,14 +64,33 @@ void sampler_ui_config(struct sampler_ui *sui_ptr, int columns, int rows, int fp
 	sui_ptr->fps = fps;
 	sui_ptr->sample_rate = sample_rate;
 	sui_ptr->sample_depth = sample_depth;
+	sui_ptr->sample_encoding = FILESAMPLER_PCM;
+	sui_ptr->sample_channels = 1;
 	sui_ptr->fd = fd;
 }
 
 int sampler_ui_init(struct sampler_ui *sui_ptr) {
+	struct filesampler_wav wav;
+	int is_wav;
 	int rc;
 
 	sui_ptr->frame = 0;
 
+	/* a WAV file's header takes precedence over the options */
+	is_wav = filesampler_read_wav(sui_ptr->fd, &wav);
+	if (is_wav == -1) {
+		return -1;
+	}
+	if (is_wav) {
+		sui_ptr->sample_rate     = wav.sample_rate;
+		sui_ptr->sample_depth    = wav.bit_depth;
+		sui_ptr->sample_encoding = wav.encoding;
+		sui_ptr->sample_channels = wav.channel_count;
+		if ( ! wav.streamed && lseek(sui_ptr->fd, wav.data_offset, SEEK_SET) == -1) {
+			return -1;
+		}
+	}
+
 	sui_ptr->mod = (int) (floor(((double) sui_ptr->sample_rate) / sui_ptr->fps));
 	sui_ptr->efps = ((double) sui_ptr->sample_rate) / sui_ptr->mod;
 
@@ -74,7 +99,16 @@ int sampler_ui_init(struct sampler_ui *sui_ptr) {
 		return -1;
 	}
 
-	rc = filesampler_init(&sui_ptr->sampler, sui_ptr->fd, sui_ptr->sample_rate, sui_ptr->sample_depth, sui_ptr->sample_rate / sui_ptr->fps);
+	rc = filesampler_init_encoding(&sui_ptr->sampler, sui_ptr->fd, sui_ptr->sample_rate, sui_ptr->sample_depth, sui_ptr->sample_encoding, sui_ptr->sample_channels, sui_ptr->sample_rate / sui_ptr->fps);
+	if (rc == -1) {
+		return -1;
+	}
+	if (is_wav) {
+		rc = filesampler_set_data_size(&sui_ptr->sampler, wav.data_size);
+	} else {
+		/* what was read off a pipe to tell */
+		rc = filesampler_unread(&sui_ptr->sampler, wav.lead, wav.lead_size);
+	}
 	if (rc == -1) {
 		return -1;
 	}
@@ -98,9 +132,11 @@ int sampler_ui_getopts(struct sampler_ui *sui_ptr, int argc, char *argv[]) {
 	/* defaults */
 	sui_ptr->sample_rate = 44100;
 	sui_ptr->sample_depth = 16;
+	sui_ptr->sample_encoding = FILESAMPLER_PCM;
+	sui_ptr->sample_channels = 1;
 	sui_ptr->fps = 60;
 
-	while ((c = getopt(argc, argv, "c:l:r:b:f:d:p:")) != -1) {
+	while ((c = getopt(argc, argv, "c:l:r:b:n:f:d:p:")) != -1) {
 		switch (c) {
 			case 'c':
 				rc = sscanf(optarg, "%i", &sui_ptr->columns);
@@ -124,9 +160,19 @@ int sampler_ui_getopts(struct sampler_ui *sui_ptr, int argc, char *argv[]) {
 					return -1;
 				}
 				break;
-			case 'b':
-				rc = sscanf(optarg, "%i", &sui_ptr->sample_depth);
-				if (rc != 1) {
+			case 'b': {
+				size_t bit_depth;
+
+				rc = filesampler_parse_format(optarg, &bit_depth, &sui_ptr->sample_encoding);
+				if (rc == -1) {
+					return -1;
+				}
+				sui_ptr->sample_depth = bit_depth;
+				break;
+			}
+			case 'n':
+				rc = sscanf(optarg, "%i", &sui_ptr->sample_channels);
+				if (rc != 1 || sui_ptr->sample_channels < 1) {
 					errno = EINVAL;
 					return -1;
 				}
@@ -11,6 +11,8 @@ struct sampler_ui {
 	int fps;
 	int sample_rate;
 	int sample_depth;
+	int sample_encoding; /* enum filesampler_encoding */
+	int sample_channels; /* interleaved */
 	int fd;
 
 	/* state */
@@ -31,6 +33,8 @@ int sampler_ui_get_rows(struct sampler_ui *sui_ptr);
 int sampler_ui_get_fps(struct sampler_ui *sui_ptr);
 int sampler_ui_get_sample_rate(struct sampler_ui *sui_ptr);
 int sampler_ui_get_sample_depth(struct sampler_ui *sui_ptr);
+int sampler_ui_get_sample_encoding(struct sampler_ui *sui_ptr);
+int sampler_ui_get_sample_channels(struct sampler_ui *sui_ptr);
 int sampler_ui_get_fd(struct sampler_ui *sui_ptr);
 
 double sampler_ui_get_efps(struct sampler_ui *sui_ptr);
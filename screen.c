@@ -6,33 +6,105 @@
 #include <errno.h>
 #include <unistd.h>
 #include <stdarg.h>
+#include <string.h>
 
-int screen_clear() {
-	int rc;
-	rc = fwprintf(stderr, L"%ls", ESCAPE_CLEAR);
-	if (rc == -1) {
-		return -1;
-	}
-	rc = fflush(stderr);
-	if (rc == -1) {
-		return -1;
+/* a cursor position costs up to this many bytes, "\033[row;columnH" */
+#define SCREEN_MOVE_MAX 16
+/* cells unchanged between two runs that are sent rather than moved over, as about what the move would cost */
+#define SCREEN_GAP_MAX 6
+
+/* all of `n` bytes to stderr */
+static int screen_write(const char *s, size_t n) {
+	ssize_t written;
+
+	while (n > 0) {
+		written = write(STDERR_FILENO, s, n);
+		if (written == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		s += written;
+		n -= written;
 	}
 
 	return 0;
 }
 
+int screen_clear() {
+	return screen_write("\033[2J", 4);
+}
+
+/* `c` as UTF-8 at `p`, returning its length */
+static size_t screen_utf8(char *p, wchar_t c) {
+	unsigned long u = c;
+
+	if (u < 0x80) {
+		p[0] = u;
+		return 1;
+	} else if (u < 0x800) {
+		p[0] = 0xC0 | (u >> 6);
+		p[1] = 0x80 | (u & 0x3F);
+		return 2;
+	} else if (u < 0x10000) {
+		if (u >= 0xD800 && u < 0xE000) {
+			p[0] = '?';
+			return 1;
+		}
+		p[0] = 0xE0 | (u >> 12);
+		p[1] = 0x80 | ((u >> 6) & 0x3F);
+		p[2] = 0x80 | (u & 0x3F);
+		return 3;
+	} else if (u < 0x110000) {
+		p[0] = 0xF0 | (u >> 18);
+		p[1] = 0x80 | ((u >> 12) & 0x3F);
+		p[2] = 0x80 | ((u >> 6) & 0x3F);
+		p[3] = 0x80 | (u & 0x3F);
+		return 4;
+	}
+	p[0] = '?';
+	return 1;
+}
+
 int screen_draw(struct screen *screen_ptr) {
-	int rc;
-	return fwprintf(stderr, L"%ls", screen_ptr->buf);
-	if (rc == -1) {
-		return -1;
+	const wchar_t *frame;
+	wchar_t *drawn;
+	char *out = screen_ptr->out;
+	size_t n = 0;
+	int row;
+	int column;
+	int end;
+	int gap;
+
+	for (row = 0; row < screen_ptr->rows; row++) {
+		frame = screen_pos(screen_ptr, 0, row);
+		drawn = &screen_ptr->drawn[row * screen_ptr->columns];
+		for (column = 0; column < screen_ptr->columns; column++) {
+			if (frame[column] == drawn[column]) {
+				continue;
+			}
+
+			/* a run of changed cells, through short gaps of unchanged ones */
+			for (end = column + 1, gap = 0; end < screen_ptr->columns && gap <= SCREEN_GAP_MAX; end++) {
+				gap = frame[end] == drawn[end] ? gap + 1 : 0;
+			}
+			end -= gap;
+
+			n += snprintf(out + n, SCREEN_MOVE_MAX, "\033[%d;%dH", row + 1, column + 1);
+			for (; column < end; column++) {
+				n += screen_utf8(out + n, frame[column]);
+				drawn[column] = frame[column];
+			}
+		}
 	}
-	rc = fflush(stderr);
-	if (rc == -1) {
-		return -1;
+	if (n == 0) {
+		return 0;
 	}
+	/* leave the cursor on the row below, as a full draw did */
+	n += snprintf(out + n, SCREEN_MOVE_MAX, "\033[%d;1H", screen_ptr->rows + 1);
 
-	return 0;
+	return screen_write(out, n);
 }
 
 wchar_t *screen_pos(struct screen *screen_ptr, int column, int row) {
@@ -86,7 +158,7 @@ void screen_blank(struct screen *screen_ptr) {
 			*screen_pos(screen_ptr, column, row) = L' ';
 		}
 	}
-	*screen_pos(screen_ptr, screen_ptr->columns + 1, screen_ptr->rows) = '\0';
+	*screen_pos(screen_ptr, 0, screen_ptr->rows) = '\0';
 }
 
 int screen_init(struct screen *screen_ptr, int columns, int rows) {
@@ -101,6 +173,21 @@ int screen_init(struct screen *screen_ptr, int columns, int rows) {
 		errno = ENOMEM;
 		return -1;
 	}
+	/* nothing is drawn yet: no cell matches */
+	screen_ptr->drawn = malloc(sizeof (wchar_t) * columns * rows);
+	screen_ptr->out_size = rows * (SCREEN_MOVE_MAX + columns * 4 + SCREEN_MOVE_MAX) + SCREEN_MOVE_MAX;
+	screen_ptr->out = malloc(screen_ptr->out_size);
+	if (screen_ptr->drawn == NULL || screen_ptr->out == NULL) {
+		free(screen_ptr->drawn);
+		free(screen_ptr->out);
+		free(screen_ptr->buf);
+		screen_ptr->buf = NULL;
+		errno = ENOMEM;
+		return -1;
+	}
+	for (int i = 0; i < columns * rows; i++) {
+		screen_ptr->drawn[i] = WEOF;
+	}
 
 	for (int i = 0; i < ESCAPE_RESET_LEN; i++) {
 		screen_ptr->buf[i] = ESCAPE_RESET[i];
@@ -115,8 +202,12 @@ int screen_init(struct screen *screen_ptr, int columns, int rows) {
 void screen_deinit(struct screen *screen_ptr) {
 	if (screen_ptr->buf != NULL) {
 		free(screen_ptr->buf);
+		free(screen_ptr->drawn);
+		free(screen_ptr->out);
 		screen_ptr->buf = NULL;
 		screen_ptr->frame = NULL;
+		screen_ptr->drawn = NULL;
+		screen_ptr->out = NULL;
 	}
 }
 
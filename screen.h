@@ -9,6 +9,11 @@
 #include <unistd.h>
 #include <wchar.h>
 
+/*
+ * The frame is drawn into as wide characters, one cell each. `screen_draw()` compares it with the frame as last drawn,
+ * and sends only the runs of cells that changed, each after a cursor position, encoded to UTF-8, in one write to stderr.
+ * Runs closer together than a cursor position costs are sent as one, unchanged cells and all.
+ */
 struct screen {
 	int columns;
 	int rows;
@@ -16,6 +21,9 @@ struct screen {
 	wchar_t *frame;
 	size_t screen_size;
 	size_t buf_size;
+	wchar_t *drawn; /* the frame as on the terminal, rows by columns */
+	char   *out;   /* of a draw */
+	size_t  out_size;
 };
 
 int screen_init(struct screen *screen_ptr, int columns, int rows);
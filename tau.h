@@ -22,9 +22,18 @@
 #define rad_rect1(rad)      CMPLX(cos(rad),         sin(rad))
 #define rad_rect( rad, mag) CMPLX(cos(rad) * (mag), sin(rad) * (mag))
 #define rect1(    tau)      rad_rect1(      tau2rad(tau))
-#define rect(     tau, mag) rad_rect((mag), tau2rad(tau))
+#define rect(     tau, mag) rad_rect(tau2rad(tau), (mag))
 
 #define rad_polar(cval) (cabs(cval),         carg(cval))
 #define polar(    cval) (cabs(cval), rad2tau(carg(cval)))
 
+/* single precision (float) */
+#define rad2tauf(rad) (fmodf(((rad) / (float) RADIAN_CYCLE) + 0.5f, 1.0f) - 0.5f)
+#define tau2radf(tau)       ((tau) * (float) RADIAN_CYCLE)
+
+#define rad_rect1f(rad)      CMPLXF(cosf(rad),         sinf(rad))
+#define rad_rectf( rad, mag) CMPLXF(cosf(rad) * (mag), sinf(rad) * (mag))
+#define rect1f(    tau)      rad_rect1f(      tau2radf(tau))
+#define rectf(     tau, mag) rad_rectf(tau2radf(tau), (mag))
+
 #endif
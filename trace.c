@@ -0,0 +1,710 @@
+#include "trace.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tau.h"
+#include "recept.h"
+#include "bank.h"
+
+#define RECEPT_TRACE_PAGE 4096
+#define RECEPT_TRACE_HALF_MAX 65504.0f
+
+static const char *recept_trace_column_names[RECEPT_TRACE_COLUMN_COUNT] = {
+	"r",
+	"percept_phi",
+	"avg_instant_period",
+	"F",
+	"phi",
+	"neg_entropy",
+	"neg_energy",
+	"beat_F",
+	"beat_phi",
+};
+
+static const char *recept_trace_encoding_names[RECEPT_TRACE_ENCODING_COUNT] = {
+	"f64",
+	"f32",
+	"f16",
+	"delta16",
+};
+
+static const size_t recept_trace_encoding_sizes[RECEPT_TRACE_ENCODING_COUNT] = {
+	sizeof (double),
+	sizeof (float),
+	sizeof (uint16_t),
+	sizeof (uint16_t),
+};
+
+const char *recept_trace_column_name(unsigned int column) {
+	return column < RECEPT_TRACE_COLUMN_COUNT ? recept_trace_column_names[column] : NULL;
+}
+const char *recept_trace_encoding_name(unsigned int encoding) {
+	return encoding < RECEPT_TRACE_ENCODING_COUNT ? recept_trace_encoding_names[encoding] : NULL;
+}
+int recept_trace_encoding_parse(const char *name) {
+	int e;
+
+	for (e = 0; e < RECEPT_TRACE_ENCODING_COUNT; e++) {
+		if (strcmp(name, recept_trace_encoding_names[e]) == 0) {
+			return e;
+		}
+	}
+
+	return -1;
+}
+
+static size_t recept_trace_align(size_t size, size_t align) {
+	return (size + align - 1) / align * align;
+}
+
+/* IEEE half precision, rounding to nearest even */
+static uint16_t recept_trace_half(float value) {
+	uint32_t x;
+	uint32_t sign;
+	uint32_t a;
+
+	memcpy(&x, &value, sizeof (x));
+	sign = (x >> 16) & 0x8000;
+	a    = x & 0x7fffffff;
+
+	if (a >= 0x7f800000) {
+		return sign | 0x7c00 | (a > 0x7f800000 ? 0x0200 : 0); /* inf, or a quiet NaN */
+	}
+	if (a >= 0x477ff000) {
+		return sign | 0x7c00; /* rounds past the largest half */
+	}
+	if (a < 0x38800000) {
+		/* subnormal: in units of 2^-24, where rounding up into 1024 makes the least normal */
+		memcpy(&value, &a, sizeof (value));
+		return sign | (uint16_t) rintf(value * 16777216.0f);
+	}
+	a -= (127 - 15) << 23;
+
+	return sign | ((a + 0x0fff + ((a >> 13) & 1)) >> 13);
+}
+static float recept_trace_unhalf(uint16_t half) {
+	uint32_t sign     = (uint32_t) (half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1f;
+	uint32_t mantissa = half & 0x03ff;
+	uint32_t x;
+	float value;
+
+	if (exponent == 0) {
+		value = ldexpf(mantissa, -24);
+		return sign ? -value : value;
+	}
+	if (exponent == 0x1f) {
+		x = sign | 0x7f800000 | (mantissa << 13);
+	} else {
+		x = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+	memcpy(&value, &x, sizeof (value));
+
+	return value;
+}
+
+void recept_trace_bank_frame(struct period_bank *bank_ptr, double *values) {
+	unsigned int sensor_count = period_bank_sensor_count(bank_ptr);
+	unsigned int s;
+	unsigned int l;
+
+	for (s = 0; s < sensor_count; s++) {
+		l = s * PERIOD_BANK_SCALES;
+		values[RECEPT_TRACE_R                  * sensor_count + s] = bank_ptr->percept_r[l];
+		values[RECEPT_TRACE_PERCEPT_PHI        * sensor_count + s] = rad2tau(atan2(bank_ptr->percept_im[l], bank_ptr->percept_re[l]));
+		values[RECEPT_TRACE_AVG_INSTANT_PERIOD * sensor_count + s] = bank_ptr->avg_instant_period[l];
+		values[RECEPT_TRACE_F                  * sensor_count + s] = bank_ptr->period_lifecycle.F[s];
+		values[RECEPT_TRACE_PHI                * sensor_count + s] = bank_ptr->period_lifecycle.phi[s];
+		values[RECEPT_TRACE_NEG_ENTROPY        * sensor_count + s] = bank_ptr->period_lifecycle.cval_re[s];
+		values[RECEPT_TRACE_NEG_ENERGY         * sensor_count + s] = bank_ptr->period_lifecycle.cval_im[s];
+		values[RECEPT_TRACE_BEAT_F             * sensor_count + s] = bank_ptr->beat_lifecycle.F[s];
+		values[RECEPT_TRACE_BEAT_PHI           * sensor_count + s] = bank_ptr->beat_lifecycle.phi[s];
+	}
+}
+
+/* struct recept_trace */
+
+/* encode the staged values of one sensor's column */
+static void recept_trace_encode(int encoding, const double *values, unsigned int n, unsigned char *column, unsigned int sensor, unsigned int sensor_count, unsigned int block_frames) {
+	unsigned char *data;
+	uint16_t half;
+	float key;
+	float decoded;
+	unsigned int k;
+
+	switch (encoding) {
+		case RECEPT_TRACE_F64:
+			memcpy(column + (size_t) sensor * block_frames * sizeof (double), values, n * sizeof (double));
+			break;
+		case RECEPT_TRACE_F32:
+			data = column + (size_t) sensor * block_frames * sizeof (float);
+			for (k = 0; k < n; k++) {
+				key = values[k];
+				memcpy(data + k * sizeof (float), &key, sizeof (float));
+			}
+			break;
+		case RECEPT_TRACE_F16:
+			data = column + (size_t) sensor * block_frames * sizeof (uint16_t);
+			for (k = 0; k < n; k++) {
+				half = recept_trace_half(values[k]);
+				memcpy(data + k * sizeof (uint16_t), &half, sizeof (uint16_t));
+			}
+			break;
+		case RECEPT_TRACE_DELTA16:
+			key = values[0];
+			memcpy(column + sensor * sizeof (float), &key, sizeof (float));
+			data = column + recept_trace_align(sensor_count * sizeof (float), RECEPT_TRACE_ALIGN) + (size_t) sensor * block_frames * sizeof (uint16_t);
+			decoded = key;
+			for (k = 0; k < n; k++) {
+				/* against the decoded value, which the reader adds up to, clamped for the jumps a half cannot take in one */
+				key = (float) values[k] - decoded;
+				half = recept_trace_half(fmaxf(-RECEPT_TRACE_HALF_MAX, fminf(RECEPT_TRACE_HALF_MAX, key)));
+				decoded += recept_trace_unhalf(half);
+				memcpy(data + k * sizeof (uint16_t), &half, sizeof (uint16_t));
+			}
+			break;
+	}
+}
+
+static int recept_trace_write_block(struct recept_trace *trace_ptr, unsigned int slot) {
+	struct recept_trace_header *header_ptr = &trace_ptr->header;
+	struct recept_trace_block block;
+	const double *staged = trace_ptr->staging + slot * trace_ptr->staging_size;
+	unsigned int n = trace_ptr->queue_frame_count[slot];
+	unsigned int B = header_ptr->block_frames;
+	unsigned int c;
+	unsigned int s;
+	off_t offset;
+	ssize_t written;
+	size_t size;
+
+	memset(trace_ptr->encoded, 0, header_ptr->block_size);
+	block.first_frame = trace_ptr->queue_first_frame[slot];
+	block.frame_count = n;
+	block.reserved    = 0;
+	memcpy(trace_ptr->encoded, &block, sizeof (block));
+	memcpy(trace_ptr->encoded + RECEPT_TRACE_BLOCK_TIMES, staged, n * sizeof (double));
+	for (c = 0; c < header_ptr->column_count; c++) {
+		for (s = 0; s < header_ptr->sensor_count; s++) {
+			recept_trace_encode(header_ptr->columns[c].encoding, staged + B + ((size_t) c * header_ptr->sensor_count + s) * B, n,
+				trace_ptr->encoded + header_ptr->columns[c].offset, s, header_ptr->sensor_count, B);
+		}
+	}
+
+	offset = header_ptr->header_size + (off_t) (block.first_frame / B) * header_ptr->block_size;
+	for (size = 0; size < header_ptr->block_size; size += written) {
+		written = pwrite(trace_ptr->fd, trace_ptr->encoded + size, header_ptr->block_size - size, offset + size);
+		if (written == -1) {
+			if (errno == EINTR) {
+				written = 0;
+				continue;
+			}
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void *recept_trace_writer(void *arg) {
+	struct recept_trace *trace_ptr = arg;
+	unsigned int slot;
+	int rc;
+
+	pthread_mutex_lock(&trace_ptr->mutex);
+	for (;;) {
+		while (trace_ptr->queue_count == 0 && ! trace_ptr->closing) {
+			pthread_cond_wait(&trace_ptr->queued_cond, &trace_ptr->mutex);
+		}
+		if (trace_ptr->queue_count == 0) {
+			break;
+		}
+		slot = (trace_ptr->queue_head + RECEPT_TRACE_QUEUE - trace_ptr->queue_count) % RECEPT_TRACE_QUEUE;
+		pthread_mutex_unlock(&trace_ptr->mutex);
+
+		/* after an error, the blocks are only let go of, so that appending never waits on a dead writer */
+		rc = trace_ptr->error == 0 ? recept_trace_write_block(trace_ptr, slot) : 0;
+
+		pthread_mutex_lock(&trace_ptr->mutex);
+		if (rc == -1) {
+			trace_ptr->error = errno;
+		}
+		trace_ptr->queue_count--;
+		pthread_cond_signal(&trace_ptr->written_cond);
+	}
+	pthread_mutex_unlock(&trace_ptr->mutex);
+
+	return NULL;
+}
+
+int recept_trace_open(struct recept_trace *trace_ptr, const char *path, double sample_rate, double response_period, unsigned int channel_count, unsigned int sensor_count, const double *periods, int encoding) {
+	struct recept_trace_header *header_ptr = &trace_ptr->header;
+	struct recept_trace_sensor *sensors;
+	unsigned char *head;
+	size_t offset;
+	size_t size;
+	ssize_t written;
+	unsigned int B = RECEPT_TRACE_BLOCK_FRAMES;
+	unsigned int c;
+	unsigned int s;
+	int rc;
+
+	if (encoding < 0 || encoding >= RECEPT_TRACE_ENCODING_COUNT || sensor_count == 0 || channel_count == 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	memset(header_ptr, 0, sizeof (*header_ptr));
+	memcpy(header_ptr->magic, RECEPT_TRACE_MAGIC, sizeof (header_ptr->magic));
+	header_ptr->version         = RECEPT_TRACE_VERSION;
+	header_ptr->byte_order      = RECEPT_TRACE_BYTE_ORDER;
+	header_ptr->block_frames    = B;
+	header_ptr->sensor_count    = sensor_count;
+	header_ptr->channel_count   = channel_count;
+	header_ptr->column_count    = RECEPT_TRACE_COLUMN_COUNT;
+	header_ptr->sample_rate     = sample_rate;
+	header_ptr->response_period = response_period;
+	header_ptr->frame_count     = 0;
+
+	/* block layout: header, times, then the columns, each aligned */
+	offset = recept_trace_align(RECEPT_TRACE_BLOCK_TIMES + B * sizeof (double), RECEPT_TRACE_ALIGN);
+	for (c = 0; c < RECEPT_TRACE_COLUMN_COUNT; c++) {
+		strncpy(header_ptr->columns[c].name, recept_trace_column_names[c], RECEPT_TRACE_NAME_MAX - 1);
+		header_ptr->columns[c].encoding = encoding;
+		header_ptr->columns[c].offset   = offset;
+		if (encoding == RECEPT_TRACE_DELTA16) {
+			offset += recept_trace_align(sensor_count * sizeof (float), RECEPT_TRACE_ALIGN);
+		}
+		offset += recept_trace_align((size_t) sensor_count * B * recept_trace_encoding_sizes[encoding], RECEPT_TRACE_ALIGN);
+	}
+	header_ptr->block_size  = offset;
+	header_ptr->header_size = recept_trace_align(sizeof (*header_ptr) + sensor_count * sizeof (*sensors), RECEPT_TRACE_PAGE);
+
+	head = calloc(1, header_ptr->header_size);
+	if (head == NULL) {
+		return -1;
+	}
+	memcpy(head, header_ptr, sizeof (*header_ptr));
+	sensors = (struct recept_trace_sensor *) (head + sizeof (*header_ptr));
+	for (s = 0; s < sensor_count; s++) {
+		sensors[s].period  = periods[s];
+		sensors[s].channel = s % channel_count;
+		sensors[s].index   = s / channel_count;
+	}
+
+	trace_ptr->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (trace_ptr->fd == -1) {
+		free(head);
+		return -1;
+	}
+	for (size = 0; size < header_ptr->header_size; size += written) {
+		written = write(trace_ptr->fd, head + size, header_ptr->header_size - size);
+		if (written == -1 && errno != EINTR) {
+			free(head);
+			close(trace_ptr->fd);
+			return -1;
+		}
+		if (written == -1) {
+			written = 0;
+		}
+	}
+	free(head);
+
+	trace_ptr->frame_count  = 0;
+	trace_ptr->value_count  = RECEPT_TRACE_COLUMN_COUNT * sensor_count;
+	trace_ptr->staging_size = (size_t) B * (1 + trace_ptr->value_count);
+	trace_ptr->fill         = 0;
+	trace_ptr->queue_head   = 0;
+	trace_ptr->queue_count  = 0;
+	trace_ptr->closing      = 0;
+	trace_ptr->error        = 0;
+	trace_ptr->staging = malloc(RECEPT_TRACE_QUEUE * trace_ptr->staging_size * sizeof (*trace_ptr->staging));
+	trace_ptr->encoded = malloc(header_ptr->block_size);
+	if (trace_ptr->staging == NULL || trace_ptr->encoded == NULL) {
+		free(trace_ptr->staging);
+		free(trace_ptr->encoded);
+		close(trace_ptr->fd);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	pthread_mutex_init(&trace_ptr->mutex, NULL);
+	pthread_cond_init(&trace_ptr->queued_cond, NULL);
+	pthread_cond_init(&trace_ptr->written_cond, NULL);
+	rc = pthread_create(&trace_ptr->thread, NULL, recept_trace_writer, trace_ptr);
+	if (rc != 0) {
+		pthread_cond_destroy(&trace_ptr->written_cond);
+		pthread_cond_destroy(&trace_ptr->queued_cond);
+		pthread_mutex_destroy(&trace_ptr->mutex);
+		free(trace_ptr->staging);
+		free(trace_ptr->encoded);
+		close(trace_ptr->fd);
+		errno = rc;
+		return -1;
+	}
+
+	return 0;
+}
+
+int recept_trace_open_bank(struct recept_trace *trace_ptr, const char *path, struct period_bank *bank_ptr, double sample_rate, int encoding) {
+	unsigned int sensor_count = period_bank_sensor_count(bank_ptr);
+	double *periods;
+	unsigned int s;
+	int rc;
+
+	periods = calloc(sensor_count, sizeof (*periods));
+	if (periods == NULL) {
+		return -1;
+	}
+	for (s = 0; s < sensor_count; s++) {
+		periods[s] = bank_ptr->period[s * PERIOD_BANK_SCALES];
+	}
+	rc = recept_trace_open(trace_ptr, path, sample_rate, bank_ptr->pa_ptr->response_period, period_bank_channel_count(bank_ptr), sensor_count, periods, encoding);
+	free(periods);
+
+	return rc;
+}
+
+/* hand the block being appended to over to the writer, and wait for a free one */
+static int recept_trace_queue_block(struct recept_trace *trace_ptr) {
+	int error;
+
+	pthread_mutex_lock(&trace_ptr->mutex);
+	trace_ptr->queue_frame_count[trace_ptr->queue_head] = trace_ptr->fill;
+	trace_ptr->queue_count++;
+	pthread_cond_signal(&trace_ptr->queued_cond);
+	while (trace_ptr->queue_count == RECEPT_TRACE_QUEUE) {
+		pthread_cond_wait(&trace_ptr->written_cond, &trace_ptr->mutex);
+	}
+	trace_ptr->queue_head = (trace_ptr->queue_head + 1) % RECEPT_TRACE_QUEUE;
+	trace_ptr->fill = 0;
+	error = trace_ptr->error;
+	pthread_mutex_unlock(&trace_ptr->mutex);
+
+	if (error != 0) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+int recept_trace_append(struct recept_trace *trace_ptr, double time, const double *values) {
+	double *staged = trace_ptr->staging + trace_ptr->queue_head * trace_ptr->staging_size;
+	unsigned int B = trace_ptr->header.block_frames;
+	unsigned int k = trace_ptr->fill;
+	unsigned int v;
+
+	if (k == 0) {
+		trace_ptr->queue_first_frame[trace_ptr->queue_head] = trace_ptr->frame_count;
+	}
+	staged[k] = time;
+	for (v = 0; v < trace_ptr->value_count; v++) {
+		staged[B + (size_t) v * B + k] = values[v];
+	}
+	trace_ptr->fill++;
+	trace_ptr->frame_count++;
+
+	if (trace_ptr->fill == B) {
+		return recept_trace_queue_block(trace_ptr);
+	}
+
+	return 0;
+}
+
+int recept_trace_close(struct recept_trace *trace_ptr) {
+	uint64_t frame_count;
+	int error = 0;
+
+	if (trace_ptr->fill > 0 && recept_trace_queue_block(trace_ptr) == -1) {
+		error = errno;
+	}
+
+	pthread_mutex_lock(&trace_ptr->mutex);
+	trace_ptr->closing = 1;
+	pthread_cond_signal(&trace_ptr->queued_cond);
+	pthread_mutex_unlock(&trace_ptr->mutex);
+	pthread_join(trace_ptr->thread, NULL);
+	if (error == 0) {
+		error = trace_ptr->error;
+	}
+
+	/* the frame count marks the trace complete */
+	frame_count = trace_ptr->frame_count;
+	if (error == 0 && pwrite(trace_ptr->fd, &frame_count, sizeof (frame_count), offsetof(struct recept_trace_header, frame_count)) != sizeof (frame_count)) {
+		error = errno != 0 ? errno : EIO;
+	}
+	if (close(trace_ptr->fd) == -1 && error == 0) {
+		error = errno;
+	}
+
+	pthread_cond_destroy(&trace_ptr->written_cond);
+	pthread_cond_destroy(&trace_ptr->queued_cond);
+	pthread_mutex_destroy(&trace_ptr->mutex);
+	free(trace_ptr->staging);
+	free(trace_ptr->encoded);
+
+	if (error != 0) {
+		errno = error;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* struct recept_trace_reader */
+
+int recept_trace_reader_open(struct recept_trace_reader *reader_ptr, const char *path) {
+	const struct recept_trace_header *header_ptr;
+	struct recept_trace_block last;
+	struct stat st;
+	void *map;
+	unsigned int c;
+	int fd;
+	int rc;
+
+	fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		return -1;
+	}
+	rc = fstat(fd, &st);
+	if (rc == -1) {
+		close(fd);
+		return -1;
+	}
+	if (st.st_size < (off_t) sizeof (*header_ptr)) {
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		return -1;
+	}
+
+	header_ptr = map;
+	if (memcmp(header_ptr->magic, RECEPT_TRACE_MAGIC, sizeof (header_ptr->magic)) != 0 || header_ptr->version != RECEPT_TRACE_VERSION ||
+		header_ptr->byte_order != RECEPT_TRACE_BYTE_ORDER || header_ptr->header_size > st.st_size || header_ptr->block_size == 0 ||
+		header_ptr->column_count > RECEPT_TRACE_COLUMN_COUNT || header_ptr->block_frames == 0) {
+		munmap(map, st.st_size);
+		errno = EINVAL;
+		return -1;
+	}
+	for (c = 0; c < header_ptr->column_count; c++) {
+		if (header_ptr->columns[c].encoding >= RECEPT_TRACE_ENCODING_COUNT || header_ptr->columns[c].offset >= header_ptr->block_size) {
+			munmap(map, st.st_size);
+			errno = EINVAL;
+			return -1;
+		}
+	}
+
+	reader_ptr->map         = map;
+	reader_ptr->map_size    = st.st_size;
+	reader_ptr->header      = header_ptr;
+	reader_ptr->sensors     = (const struct recept_trace_sensor *) (reader_ptr->map + sizeof (*header_ptr));
+	/* whole blocks only, so that a trace still being written, or cut short, reads up to its last one */
+	reader_ptr->block_count = (st.st_size - header_ptr->header_size) / header_ptr->block_size;
+	reader_ptr->frame_count = 0;
+	if (reader_ptr->block_count > 0) {
+		memcpy(&last, reader_ptr->map + header_ptr->header_size + (reader_ptr->block_count - 1) * header_ptr->block_size, sizeof (last));
+		reader_ptr->frame_count = (uint64_t) (reader_ptr->block_count - 1) * header_ptr->block_frames + last.frame_count;
+	}
+
+	return 0;
+}
+
+void recept_trace_reader_close(struct recept_trace_reader *reader_ptr) {
+	munmap((void *) reader_ptr->map, reader_ptr->map_size);
+}
+
+/* the block of `frame`, with the frames of it to read from `frame` on */
+static const unsigned char *recept_trace_reader_block(struct recept_trace_reader *reader_ptr, uint64_t frame, size_t n, unsigned int *k_ptr, size_t *m_ptr) {
+	const struct recept_trace_header *header_ptr = reader_ptr->header;
+	const unsigned char *block;
+	struct recept_trace_block head;
+	size_t b = frame / header_ptr->block_frames;
+
+	if (b >= reader_ptr->block_count) {
+		return NULL;
+	}
+	block = reader_ptr->map + header_ptr->header_size + b * header_ptr->block_size;
+	memcpy(&head, block, sizeof (head));
+	*k_ptr = frame % header_ptr->block_frames;
+	if (*k_ptr >= head.frame_count) {
+		return NULL;
+	}
+	*m_ptr = head.frame_count - *k_ptr < n ? head.frame_count - *k_ptr : n;
+
+	return block;
+}
+
+size_t recept_trace_read_times(struct recept_trace_reader *reader_ptr, uint64_t frame_begin, size_t n, double *times) {
+	const unsigned char *block;
+	unsigned int k;
+	size_t done;
+	size_t m;
+
+	for (done = 0; done < n; done += m) {
+		block = recept_trace_reader_block(reader_ptr, frame_begin + done, n - done, &k, &m);
+		if (block == NULL) {
+			break;
+		}
+		memcpy(times + done, block + RECEPT_TRACE_BLOCK_TIMES + k * sizeof (double), m * sizeof (double));
+	}
+
+	return done;
+}
+
+size_t recept_trace_read(struct recept_trace_reader *reader_ptr, unsigned int column, unsigned int sensor, uint64_t frame_begin, size_t n, double *values) {
+	const struct recept_trace_header *header_ptr = reader_ptr->header;
+	const struct recept_trace_column_desc *desc_ptr;
+	const unsigned char *block;
+	const unsigned char *data;
+	unsigned int B = header_ptr->block_frames;
+	unsigned int k;
+	unsigned int j;
+	uint16_t half;
+	float value_f;
+	float decoded;
+	size_t done;
+	size_t m;
+	size_t i;
+
+	if (column >= header_ptr->column_count || sensor >= header_ptr->sensor_count) {
+		return 0;
+	}
+	desc_ptr = &header_ptr->columns[column];
+
+	for (done = 0; done < n; done += m) {
+		block = recept_trace_reader_block(reader_ptr, frame_begin + done, n - done, &k, &m);
+		if (block == NULL) {
+			break;
+		}
+		data = block + desc_ptr->offset;
+		switch (desc_ptr->encoding) {
+			case RECEPT_TRACE_F64:
+				memcpy(values + done, data + ((size_t) sensor * B + k) * sizeof (double), m * sizeof (double));
+				break;
+			case RECEPT_TRACE_F32:
+				data += (size_t) sensor * B * sizeof (float);
+				for (i = 0; i < m; i++) {
+					memcpy(&value_f, data + (k + i) * sizeof (float), sizeof (float));
+					values[done + i] = value_f;
+				}
+				break;
+			case RECEPT_TRACE_F16:
+				data += (size_t) sensor * B * sizeof (uint16_t);
+				for (i = 0; i < m; i++) {
+					memcpy(&half, data + (k + i) * sizeof (uint16_t), sizeof (uint16_t));
+					values[done + i] = recept_trace_unhalf(half);
+				}
+				break;
+			case RECEPT_TRACE_DELTA16:
+				memcpy(&decoded, data + sensor * sizeof (float), sizeof (float));
+				data += recept_trace_align(header_ptr->sensor_count * sizeof (float), RECEPT_TRACE_ALIGN) + (size_t) sensor * B * sizeof (uint16_t);
+				/* from the key, through the frames before `k` */
+				for (j = 0; j < k + m; j++) {
+					memcpy(&half, data + j * sizeof (uint16_t), sizeof (uint16_t));
+					decoded += recept_trace_unhalf(half);
+					if (j >= k) {
+						values[done + j - k] = decoded;
+					}
+				}
+				break;
+			default:
+				return done;
+		}
+	}
+
+	return done;
+}
+
+#ifdef RECEPT_TRACE
+int main(int argc, char *argv[]) {
+	struct recept_trace_reader reader;
+	const struct recept_trace_header *header_ptr;
+	double times[RECEPT_TRACE_BLOCK_FRAMES];
+	double values[RECEPT_TRACE_COLUMN_COUNT][RECEPT_TRACE_BLOCK_FRAMES];
+	int sensor = -1;
+	int column = -1;
+	unsigned int c;
+	unsigned int c_begin;
+	unsigned int c_end;
+	uint64_t frame;
+	size_t n;
+	size_t i;
+	int rc;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:c:")) != -1) {
+		switch (opt) {
+			case 's':
+				rc = sscanf(optarg, "%i", &sensor);
+				break;
+			case 'c':
+				for (column = 0; column < RECEPT_TRACE_COLUMN_COUNT && strcmp(optarg, recept_trace_column_names[column]) != 0; column++);
+				rc = column < RECEPT_TRACE_COLUMN_COUNT;
+				break;
+			default:
+				rc = 0;
+				break;
+		}
+		if (rc != 1) {
+			optind = argc; /* usage */
+			break;
+		}
+	}
+	if (optind + 1 != argc) {
+		fprintf(stderr, "usage: %s [-s sensor [-c column]] trace.bin\n", argv[0]);
+		return -1;
+	}
+
+	rc = recept_trace_reader_open(&reader, argv[optind]);
+	if (rc == -1) {
+		perror("recept_trace_reader_open");
+		return -1;
+	}
+	header_ptr = reader.header;
+
+	if (sensor < 0) {
+		/* describe the trace */
+		printf("%u sensors, %u channels, %g Hz, response period %g, %llu frames%s\n", header_ptr->sensor_count, header_ptr->channel_count,
+			header_ptr->sample_rate, header_ptr->response_period, (unsigned long long) reader.frame_count, header_ptr->frame_count == 0 ? " (not closed)" : "");
+		for (c = 0; c < header_ptr->column_count; c++) {
+			printf("column %u\t%.*s\t%s\n", c, RECEPT_TRACE_NAME_MAX, header_ptr->columns[c].name, recept_trace_encoding_names[header_ptr->columns[c].encoding]);
+		}
+		for (i = 0; i < header_ptr->sensor_count; i++) {
+			printf("sensor %zu\tchannel %u\t%u\tperiod %.9g\n", i, reader.sensors[i].channel, reader.sensors[i].index, reader.sensors[i].period);
+		}
+	} else if (sensor < header_ptr->sensor_count) {
+		/* slice a sensor: its time, then its columns, a block at a time */
+		c_begin = column < 0 ? 0 : column;
+		c_end   = column < 0 ? header_ptr->column_count : column + 1;
+		for (frame = 0; (n = recept_trace_read_times(&reader, frame, RECEPT_TRACE_BLOCK_FRAMES, times)) > 0; frame += n) {
+			for (c = c_begin; c < c_end; c++) {
+				recept_trace_read(&reader, c, sensor, frame, n, values[c]);
+			}
+			for (i = 0; i < n; i++) {
+				printf("%.6f", times[i] / header_ptr->sample_rate);
+				for (c = c_begin; c < c_end; c++) {
+					printf("\t%.9g", values[c][i]);
+				}
+				printf("\n");
+			}
+		}
+	}
+
+	recept_trace_reader_close(&reader);
+
+	return 0;
+}
+#endif
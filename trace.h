@@ -0,0 +1,155 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/*
+ * Columnar Sensor Trace
+ *
+ * A binary file of a bank's responses: a row per sensor per response frame, stored a column per field, so that one
+ * sensor's field over hours is a few contiguous runs of the file, read through mmap without parsing.
+ *
+ * The file is a page-aligned header, describing the bank and the columns, followed by fixed-size blocks of
+ * RECEPT_TRACE_BLOCK_FRAMES frames each. Block `b` starts at `header_size + b * block_size`; in it, the frames' times
+ * are at RECEPT_TRACE_BLOCK_TIMES, and each column at its `offset`, sensor-major: sensor `s`, frame `k` of the block
+ * is value `s * block_frames + k`. The last block is padded, and its `frame_count` tells how much of it holds frames.
+ * Everything is in the writer's byte order, which `byte_order` tells.
+ *
+ * Each column is stored in one of these encodings:
+ *   RECEPT_TRACE_F64, RECEPT_TRACE_F32, RECEPT_TRACE_F16: the values, as IEEE doubles, floats, or halves
+ *   RECEPT_TRACE_DELTA16: a float key per sensor, at the column's offset, then, from the next RECEPT_TRACE_ALIGN, halves
+ *     per frame of the difference to the prior frame's decoded value, which add up to the values in float arithmetic.
+ *     The writer takes the differences against its own decoded values, so that rounding does not add up over a block.
+ *
+ * Frames are appended on the sampling thread into a staging block; full blocks are encoded and written by a
+ * background thread, up to RECEPT_TRACE_QUEUE of them in flight before appending waits for the writer.
+ */
+
+#define RECEPT_TRACE_MAGIC "RCPTRACE"
+#define RECEPT_TRACE_VERSION 1
+#define RECEPT_TRACE_BYTE_ORDER 0x01020304
+#define RECEPT_TRACE_BLOCK_FRAMES 256
+#define RECEPT_TRACE_QUEUE 4
+#define RECEPT_TRACE_ALIGN 64
+#define RECEPT_TRACE_NAME_MAX 24
+
+enum recept_trace_encoding {
+	RECEPT_TRACE_F64,
+	RECEPT_TRACE_F32,
+	RECEPT_TRACE_F16,
+	RECEPT_TRACE_DELTA16,
+	RECEPT_TRACE_ENCODING_COUNT
+};
+
+/* the fields of each sensor, from a `struct period_bank`, where the per-scale ones are the first scale's */
+enum recept_trace_column {
+	RECEPT_TRACE_R,                  /* percept magnitude */
+	RECEPT_TRACE_PERCEPT_PHI,        /* percept phase, in cycles */
+	RECEPT_TRACE_AVG_INSTANT_PERIOD,
+	RECEPT_TRACE_F,                  /* period lifecycle Free Energy */
+	RECEPT_TRACE_PHI,                /* period lifecycle phase, in cycles */
+	RECEPT_TRACE_NEG_ENTROPY,        /* period lifecycle cval, real */
+	RECEPT_TRACE_NEG_ENERGY,         /* period lifecycle cval, imaginary */
+	RECEPT_TRACE_BEAT_F,
+	RECEPT_TRACE_BEAT_PHI,
+	RECEPT_TRACE_COLUMN_COUNT
+};
+
+struct recept_trace_column_desc {
+	char     name[RECEPT_TRACE_NAME_MAX];
+	uint32_t encoding;
+	uint32_t offset; /* bytes into a block */
+};
+
+struct recept_trace_header {
+	char     magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t header_size;   /* bytes, up to the first block */
+	uint32_t block_size;    /* bytes */
+	uint32_t block_frames;
+	uint32_t sensor_count;  /* of the bank, channels included */
+	uint32_t channel_count; /* sensor `s` is channel `s % channel_count` */
+	uint32_t column_count;
+	double   sample_rate;
+	double   response_period; /* samples */
+	uint64_t frame_count;     /* 0 until the trace is closed, see `recept_trace_reader_open()` */
+	struct recept_trace_column_desc columns[RECEPT_TRACE_COLUMN_COUNT];
+	/* followed by a `struct recept_trace_sensor` per sensor */
+};
+
+struct recept_trace_sensor {
+	double   period; /* samples */
+	uint32_t channel;
+	uint32_t index;  /* the sensor's index in its channel */
+};
+
+/* at the start of each block */
+struct recept_trace_block {
+	uint64_t first_frame;
+	uint32_t frame_count;
+	uint32_t reserved;
+};
+#define RECEPT_TRACE_BLOCK_TIMES RECEPT_TRACE_ALIGN /* bytes into a block, `block_frames` doubles in samples */
+
+struct period_bank;
+
+struct recept_trace {
+	int fd;
+	struct recept_trace_header header;
+	uint64_t frame_count;
+	unsigned int value_count; /* doubles per staged frame, the columns times the sensors */
+
+	/* staged blocks of doubles: times, then column-major values of `block_frames` per sensor */
+	double *staging;
+	size_t  staging_size; /* doubles per staged block */
+	unsigned int fill;    /* frames in the block being appended to */
+	unsigned int queue_head;  /* the block being appended to */
+	unsigned int queue_count; /* full blocks waiting for the writer */
+	uint64_t     queue_first_frame[RECEPT_TRACE_QUEUE];
+	unsigned int queue_frame_count[RECEPT_TRACE_QUEUE];
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t  queued_cond;
+	pthread_cond_t  written_cond;
+	int closing;
+	int error; /* errno of the writer, or 0 */
+	unsigned char *encoded; /* the writer's block */
+};
+
+const char *recept_trace_column_name(unsigned int column);
+const char *recept_trace_encoding_name(unsigned int encoding);
+/* the encoding named `name`, as by `recept_trace_encoding_name()`, or -1 */
+int recept_trace_encoding_parse(const char *name);
+
+/* take a frame of the bank's latest response, as `value_count` doubles of `recept_trace_append()` */
+void recept_trace_bank_frame(struct period_bank *bank_ptr, double *values);
+
+/* create the trace `path` of `sensor_count` sensors of `periods`, every column in `encoding`, and start its writer */
+int  recept_trace_open(struct recept_trace *trace_ptr, const char *path, double sample_rate, double response_period, unsigned int channel_count, unsigned int sensor_count, const double *periods, int encoding);
+/* as `recept_trace_open()`, for the sensors of a bank */
+int  recept_trace_open_bank(struct recept_trace *trace_ptr, const char *path, struct period_bank *bank_ptr, double sample_rate, int encoding);
+/* append a frame at `time` of `values[column * sensor_count + sensor]`, waiting when the writer is behind; -1 after a write error */
+int  recept_trace_append(struct recept_trace *trace_ptr, double time, const double *values);
+/* write out the last block and the frame count, stop the writer, and close the file */
+int  recept_trace_close(struct recept_trace *trace_ptr);
+
+struct recept_trace_reader {
+	const unsigned char *map;
+	size_t map_size;
+	const struct recept_trace_header *header;
+	const struct recept_trace_sensor *sensors;
+	size_t block_count;
+	uint64_t frame_count; /* of the blocks written, whether or not the trace was closed */
+};
+
+int  recept_trace_reader_open(struct recept_trace_reader *reader_ptr, const char *path);
+void recept_trace_reader_close(struct recept_trace_reader *reader_ptr);
+/* decode the times of frames `frame_begin` on, up to `n` of them, into `times`, returning how many */
+size_t recept_trace_read_times(struct recept_trace_reader *reader_ptr, uint64_t frame_begin, size_t n, double *times);
+/* decode one sensor's column, as `recept_trace_read_times()` */
+size_t recept_trace_read(struct recept_trace_reader *reader_ptr, unsigned int column, unsigned int sensor, uint64_t frame_begin, size_t n, double *values);
+
+#endif